@@ -23,8 +23,12 @@
 #include "IdleFlags.hxx"
 #include "StateFile.hxx"
 #include "Stats.hxx"
+#include "Log.hxx"
 #include "client/List.hxx"
 #include "input/cache/Manager.hxx"
+#include "decoder/SeekIndexCache.hxx"
+#include "output/WorkerPool.hxx"
+#include "SongPrintCache.hxx"
 
 #ifdef ENABLE_CURL
 #include "RemoteTagCache.hxx"
@@ -35,6 +39,7 @@
 #include "db/DatabaseError.hxx"
 #include "db/Interface.hxx"
 #include "db/update/Service.hxx"
+#include "db/plugins/simple/SimpleDatabasePlugin.hxx"
 #include "storage/StorageInterface.hxx"
 
 #ifdef ENABLE_NEIGHBOR_PLUGINS
@@ -99,6 +104,22 @@ Instance::DeletePartition(Partition &partition) noexcept
 			break;
 		}
 	}
+
+	/* the cache is keyed on the queue address, which may be
+	   reused by a new partition */
+	if (song_print_cache)
+		song_print_cache->Clear();
+}
+
+EventLoop *
+Instance::GetClientIoLoop() noexcept
+{
+	if (client_io_threads.empty())
+		return nullptr;
+
+	auto &thread = *client_io_threads[next_client_io_thread];
+	next_client_io_thread = (next_client_io_thread + 1) % client_io_threads.size();
+	return &thread.GetEventLoop();
 }
 
 #ifdef ENABLE_DATABASE
@@ -113,6 +134,15 @@ Instance::GetDatabaseOrThrow() const
 	return *database;
 }
 
+void
+Instance::InvalidateDatabaseCaches() noexcept
+{
+	stats_invalidate();
+
+	if (song_print_cache)
+		song_print_cache->Clear();
+}
+
 void
 Instance::OnDatabaseModified() noexcept
 {
@@ -120,7 +150,7 @@ Instance::OnDatabaseModified() noexcept
 
 	/* propagate the change to all subsystems */
 
-	stats_invalidate();
+	InvalidateDatabaseCaches();
 
 	for (auto &partition : partitions)
 		partition.DatabaseModified(*database);
@@ -145,6 +175,28 @@ Instance::OnDatabaseSongRemoved(const char *uri) noexcept
 		partition.StaleSong(uri);
 }
 
+void
+Instance::OnDatabaseLoaded() noexcept
+{
+	assert(database != nullptr);
+
+	InvalidateDatabaseCaches();
+
+	for (auto &partition : partitions)
+		partition.DatabaseLoaded(*database);
+
+	const auto *sdb = dynamic_cast<const SimpleDatabase *>(database.get());
+	if (update != nullptr && sdb != nullptr && !sdb->FileExists()) {
+		/* the database failed to load: recreate the
+		   database */
+		try {
+			update->Enqueue("", true);
+		} catch (...) {
+			LogError(std::current_exception());
+		}
+	}
+}
+
 #endif
 
 #ifdef ENABLE_NEIGHBOR_PLUGINS
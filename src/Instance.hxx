@@ -48,6 +48,7 @@ class UpdateService;
 
 #include <memory>
 #include <list>
+#include <vector>
 
 class ClientList;
 struct Partition;
@@ -55,6 +56,9 @@ class StateFile;
 class RemoteTagCache;
 class StickerDatabase;
 class InputCacheManager;
+class SeekIndexCache;
+class OutputWorkerPool;
+class SongPrintCache;
 
 /**
  * A utility class which, when used as the first base class, ensures
@@ -95,12 +99,41 @@ struct Instance final
 	 */
 	EventThread rtio_thread;
 
+	/**
+	 * Threads which perform the socket I/O of client
+	 * connections.  If this is empty ("client_io_threads" not
+	 * configured), then clients are handled completely in the
+	 * main thread.
+	 */
+	std::vector<std::unique_ptr<EventThread>> client_io_threads;
+
+	/**
+	 * The index of the #client_io_threads element which gets the
+	 * next client.
+	 */
+	size_t next_client_io_thread = 0;
+
 #ifdef ENABLE_SYSTEMD_DAEMON
 	Systemd::Watchdog systemd_watchdog;
 #endif
 
 	std::unique_ptr<InputCacheManager> input_cache;
 
+	std::unique_ptr<SeekIndexCache> seek_index_cache;
+
+	/**
+	 * Serialized song metadata for listing commands; nullptr if
+	 * "song_print_cache_size" is not configured.
+	 */
+	std::unique_ptr<SongPrintCache> song_print_cache;
+
+	/**
+	 * Threads shared by all audio outputs which don't need a
+	 * dedicated thread; nullptr if "output_worker_threads" is not
+	 * configured.
+	 */
+	std::unique_ptr<OutputWorkerPool> output_worker_pool;
+
 	/**
 	 * Monitor for global idle events to be broadcasted to all
 	 * partitions.
@@ -173,6 +206,13 @@ struct Instance final
 
 	void DeletePartition(Partition &partition) noexcept;
 
+	/**
+	 * Choose the #EventLoop which shall perform the socket I/O
+	 * of a new client (round-robin).  Returns nullptr if there
+	 * are no #client_io_threads.
+	 */
+	EventLoop *GetClientIoLoop() noexcept;
+
 	void BeginShutdownPartitions() noexcept;
 
 #ifdef ENABLE_DATABASE
@@ -213,9 +253,15 @@ struct Instance final
 
 private:
 #ifdef ENABLE_DATABASE
+	/**
+	 * Flush all data derived from the database contents.
+	 */
+	void InvalidateDatabaseCaches() noexcept;
+
 	/* virtual methods from class DatabaseListener */
 	void OnDatabaseModified() noexcept override;
 	void OnDatabaseSongRemoved(const char *uri) noexcept override;
+	void OnDatabaseLoaded() noexcept override;
 #endif
 
 #ifdef ENABLE_NEIGHBOR_PLUGINS
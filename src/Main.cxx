@@ -45,6 +45,9 @@
 #include "playlist/PlaylistRegistry.hxx"
 #include "zeroconf/ZeroconfGlue.hxx"
 #include "decoder/DecoderList.hxx"
+#include "decoder/SeekIndexCache.hxx"
+#include "output/WorkerPool.hxx"
+#include "SongPrintCache.hxx"
 #include "pcm/AudioParser.hxx"
 #include "pcm/Convert.hxx"
 #include "unix/SignalHandlers.hxx"
@@ -223,8 +226,10 @@ glue_db_init_and_load(Instance &instance, const ConfigData &config)
 					    static_cast<CompositeStorage &>(*instance.storage),
 					    instance);
 
-	/* run database update after daemonization? */
-	return sdb->FileExists();
+	/* run database update after daemonization?  (If the
+	   database is being loaded in the background, this will be
+	   decided by Instance::OnDatabaseLoaded()) */
+	return sdb->IsLoading() || sdb->FileExists();
 }
 
 static bool
@@ -406,6 +411,25 @@ MainConfigured(const struct options &options, const ConfigData &raw_config)
 		instance.input_cache = std::make_unique<InputCacheManager>(c);
 	}
 
+	auto seek_index_directory =
+		raw_config.GetPath(ConfigOption::SEEK_INDEX_DIRECTORY);
+	if (!seek_index_directory.IsNull())
+		instance.seek_index_cache =
+			std::make_unique<SeekIndexCache>(std::move(seek_index_directory));
+
+	const unsigned output_worker_threads =
+		raw_config.GetUnsigned(ConfigOption::OUTPUT_WORKER_THREADS, 0);
+	if (output_worker_threads > 0)
+		instance.output_worker_pool =
+			std::make_unique<OutputWorkerPool>(output_worker_threads);
+
+	const size_t song_print_cache_size =
+		raw_config.GetUnsigned(ConfigOption::SONG_PRINT_CACHE_SIZE, 0)
+		* size_t(1024);
+	if (song_print_cache_size > 0)
+		instance.song_print_cache =
+			std::make_unique<SongPrintCache>(song_print_cache_size);
+
 	initialize_decoder_and_player(instance,
 				      raw_config, config.replay_gain);
 
@@ -468,6 +492,12 @@ MainConfigured(const struct options &options, const ConfigData &raw_config)
 	instance.io_thread.Start();
 	instance.rtio_thread.Start();
 
+	for (unsigned i = raw_config.GetUnsigned(ConfigOption::CLIENT_IO_THREADS, 0);
+	     i > 0; --i) {
+		instance.client_io_threads.emplace_back(std::make_unique<EventThread>());
+		instance.client_io_threads.back()->Start();
+	}
+
 #ifdef ENABLE_NEIGHBOR_PLUGINS
 	if (instance.neighbors != nullptr)
 		instance.neighbors->Open();
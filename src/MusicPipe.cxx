@@ -21,6 +21,7 @@
 #include "MusicChunk.hxx"
 
 #include <cassert>
+#include <utility>
 
 #ifndef NDEBUG
 
@@ -98,3 +99,90 @@ MusicPipe::Push(MusicChunkPtr chunk) noexcept
 
 	++size;
 }
+
+void
+MusicPipe::Prepend(MusicPipe &other) noexcept
+{
+	assert(&other != this);
+
+	MusicChunkPtr other_head;
+	MusicChunkPtr *other_tail_r;
+	unsigned other_size;
+
+	{
+		const std::lock_guard<Mutex> protect(other.mutex);
+		if (other.head == nullptr)
+			return;
+
+		other_head = std::move(other.head);
+		other_tail_r = std::exchange(other.tail_r, &other.head);
+		other_size = std::exchange(other.size, 0U);
+
+#ifndef NDEBUG
+		other.audio_format.Clear();
+#endif
+	}
+
+	const std::lock_guard<Mutex> protect(mutex);
+
+#ifndef NDEBUG
+	if (!audio_format.IsDefined())
+		for (const MusicChunk *i = other_head.get(); i != nullptr;
+		     i = i->next.get())
+			if (i->length > 0) {
+				audio_format = i->audio_format;
+				break;
+			}
+#endif
+
+	*other_tail_r = std::move(head);
+	if (tail_r == &head)
+		tail_r = other_tail_r;
+	head = std::move(other_head);
+
+	size += other_size;
+}
+
+bool
+MusicPipe::SkipTo(SongTime t) noexcept
+{
+	/* this variable is declared before the lock, so the skipped
+	   chunks get returned to the buffer after the mutex has been
+	   released */
+	MusicChunkPtr skipped;
+
+	const std::lock_guard<Mutex> protect(mutex);
+
+	MusicChunkPtr *found = nullptr;
+	unsigned found_position = 0, position = 0;
+
+	for (MusicChunkPtr *i = &head; *i != nullptr;
+	     i = &(*i)->next, ++position) {
+		const MusicChunk &chunk = **i;
+		if (chunk.length == 0 || chunk.time.IsNegative())
+			/* no usable time stamp */
+			continue;
+
+		if (SongTime(chunk.time) > t) {
+			if (found == nullptr)
+				/* the time stamp is before the first
+				   chunk */
+				return false;
+
+			if (found != &head) {
+				skipped = std::move(head);
+				head = std::move(*found);
+				size -= found_position;
+			}
+
+			return true;
+		}
+
+		found = i;
+		found_position = position;
+	}
+
+	/* the time stamp is beyond the last chunk (or exactly inside
+	   it, but we can't know that) */
+	return false;
+}
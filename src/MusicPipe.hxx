@@ -21,6 +21,7 @@
 #define MPD_PIPE_H
 
 #include "MusicChunkPtr.hxx"
+#include "Chrono.hxx"
 #include "thread/Mutex.hxx"
 #include "util/Compiler.h"
 
@@ -97,6 +98,25 @@ public:
 	 */
 	void Push(MusicChunkPtr chunk) noexcept;
 
+	/**
+	 * Moves all chunks of the other pipe to the head of this
+	 * pipe, i.e. they will be shifted before the chunks which are
+	 * already in this pipe.  The other pipe is empty afterwards.
+	 */
+	void Prepend(MusicPipe &other) noexcept;
+
+	/**
+	 * Drops all chunks before the one which contains the given
+	 * time stamp.  This succeeds only if the time stamp lies
+	 * within the pipe, i.e. there is at least one chunk
+	 * beginning at or before it and one beginning after it;
+	 * otherwise, the pipe is left unmodified.
+	 *
+	 * @return true if the pipe now begins with the chunk
+	 * containing the given time stamp
+	 */
+	bool SkipTo(SongTime t) noexcept;
+
 	/**
 	 * Returns the number of chunks currently in this pipe.
 	 */
@@ -41,11 +41,13 @@ Partition::Partition(Instance &_instance,
 	 name(_name),
 	 listener(new ClientListener(instance.event_loop, *this)),
 	 idle_monitor(instance.event_loop, BIND_THIS_METHOD(OnIdleMonitor)),
+	 idle_dispatcher(instance.event_loop),
 	 global_events(instance.event_loop, BIND_THIS_METHOD(OnGlobalEvent)),
 	 playlist(max_length, *this),
-	 outputs(pc, *this),
+	 outputs(pc, *this, instance.output_worker_pool.get()),
 	 pc(*this, outputs,
 	    instance.input_cache.get(),
+	    instance.seek_index_cache.get(),
 	    buffer_chunks,
 	    configured_audio_format, replay_gain_config)
 {
@@ -133,6 +135,13 @@ Partition::DatabaseModified(const Database &db) noexcept
 	EmitIdle(IDLE_DATABASE);
 }
 
+void
+Partition::DatabaseLoaded(const Database &db) noexcept
+{
+	playlist.DatabaseLoaded(pc, db);
+	EmitIdle(IDLE_DATABASE);
+}
+
 #endif
 
 void
@@ -215,8 +224,7 @@ Partition::OnIdleMonitor(unsigned mask) noexcept
 {
 	/* send "idle" notifications to all subscribed
 	   clients */
-	for (auto &client : clients)
-		client.IdleAdd(mask);
+	idle_dispatcher.Emit(mask);
 
 	if (mask & (IDLE_PLAYLIST|IDLE_PLAYER|IDLE_MIXER|IDLE_OUTPUT))
 		instance.OnStateModified();
@@ -21,6 +21,7 @@
 #define MPD_PARTITION_HXX
 
 #include "event/MaskMonitor.hxx"
+#include "client/IdleDispatcher.hxx"
 #include "queue/Playlist.hxx"
 #include "queue/Listener.hxx"
 #include "output/MultipleOutputs.hxx"
@@ -68,6 +69,11 @@ struct Partition final : QueueListener, PlayerListener, MixerListener {
 	 */
 	MaskMonitor idle_monitor;
 
+	/**
+	 * Delivers idle events from #idle_monitor to the clients.
+	 */
+	IdleDispatcher idle_dispatcher;
+
 	MaskMonitor global_events;
 
 	struct playlist playlist;
@@ -249,6 +255,13 @@ struct Partition final : QueueListener, PlayerListener, MixerListener {
 	 * all subsystems.
 	 */
 	void DatabaseModified(const Database &db) noexcept;
+
+	/**
+	 * The database has finished loading in the background.
+	 * Resolve the songs in the queue which were added
+	 * meanwhile.
+	 */
+	void DatabaseLoaded(const Database &db) noexcept;
 #endif
 
 	/**
@@ -25,8 +25,14 @@
 #include "client/Response.hxx"
 #include "fs/Traits.hxx"
 #include "time/ChronoUtil.hxx"
+#include "time/ISO8601.hxx"
+#include "tag/Tag.hxx"
+#include "tag/Mask.hxx"
+#include "util/StringView.hxx"
 #include "util/UriUtil.hxx"
 
+#include <stdio.h>
+
 #define SONG_FILE "file: "
 
 static void
@@ -42,14 +48,14 @@ song_print_uri(Response &r, const char *uri, bool base) noexcept
 			uri = allocated.c_str();
 	}
 
-	r.Format(SONG_FILE "%s\n", uri);
+	r.WriteLine({SONG_FILE, uri});
 }
 
 void
 song_print_uri(Response &r, const LightSong &song, bool base) noexcept
 {
 	if (!base && song.directory != nullptr)
-		r.Format(SONG_FILE "%s/%s\n", song.directory, song.uri);
+		r.WriteLine({SONG_FILE, song.directory, "/", song.uri});
 	else
 		song_print_uri(r, song.uri, base);
 }
@@ -78,9 +84,139 @@ PrintRange(Response &r, SongTime start_time, SongTime end_time) noexcept
 			 start_ms % 1000);
 }
 
+/* the binary song encoding, see protocol/BinarySong.hxx */
+
+static void
+song_binary_uri(Response &r, const char *uri, bool base) noexcept
+{
+	std::string allocated;
+
+	if (base) {
+		uri = PathTraitsUTF8::GetBase(uri);
+	} else {
+		allocated = uri_remove_auth(uri);
+		if (!allocated.empty())
+			uri = allocated.c_str();
+	}
+
+	r.WriteBinaryField(BinarySongKey::URI, {uri});
+}
+
+static void
+song_binary_uri(Response &r, const LightSong &song, bool base) noexcept
+{
+	if (!base && song.directory != nullptr)
+		r.WriteBinaryField(BinarySongKey::URI,
+				   {song.directory, "/", song.uri});
+	else
+		song_binary_uri(r, song.uri, base);
+}
+
+static void
+BinaryRange(Response &r, SongTime start_time, SongTime end_time) noexcept
+{
+	const unsigned start_ms = start_time.ToMS();
+	const unsigned end_ms = end_time.ToMS();
+
+	char buffer[64];
+	int length;
+
+	if (end_ms > 0)
+		length = snprintf(buffer, sizeof(buffer),
+				  "%u.%03u-%u.%03u",
+				  start_ms / 1000,
+				  start_ms % 1000,
+				  end_ms / 1000,
+				  end_ms % 1000);
+	else if (start_ms > 0)
+		length = snprintf(buffer, sizeof(buffer), "%u.%03u-",
+				  start_ms / 1000,
+				  start_ms % 1000);
+	else
+		return;
+
+	r.WriteBinaryField(BinarySongKey::RANGE, {{buffer, size_t(length)}});
+}
+
+static void
+BinaryLastModified(Response &r,
+		   std::chrono::system_clock::time_point t) noexcept
+{
+	if (IsNegative(t))
+		return;
+
+	StringBuffer<64> s;
+
+	try {
+		s = FormatISO8601(t);
+	} catch (...) {
+		return;
+	}
+
+	r.WriteBinaryField(BinarySongKey::LAST_MODIFIED, {s.c_str()});
+}
+
+static void
+BinaryDuration(Response &r, SignedSongTime duration) noexcept
+{
+	if (duration.IsNegative())
+		return;
+
+	r.WriteBinaryUnsigned(BinarySongKey::TIME, duration.RoundS());
+
+	const unsigned ms = duration.ToMS();
+	char buffer[24];
+	const int length = snprintf(buffer, sizeof(buffer), "%u.%03u",
+				    ms / 1000, ms % 1000);
+	r.WriteBinaryField(BinarySongKey::DURATION,
+			   {{buffer, size_t(length)}});
+}
+
+static void
+BinaryTagValues(Response &r, const Tag &tag) noexcept
+{
+	const auto tag_mask = r.GetTagMask();
+	for (const auto &i : tag)
+		if (tag_mask.Test(i.type))
+			r.WriteBinaryField(BinarySongTagKey(i.type),
+					   {i.value});
+}
+
+static void
+song_binary_info(Response &r, const LightSong &song, bool base) noexcept
+{
+	song_binary_uri(r, song, base);
+
+	BinaryRange(r, song.start_time, song.end_time);
+	BinaryLastModified(r, song.mtime);
+
+	if (song.audio_format.IsDefined())
+		r.WriteBinaryField(BinarySongKey::FORMAT,
+				   {ToString(song.audio_format).c_str()});
+
+	BinaryDuration(r, song.tag.duration);
+	BinaryTagValues(r, song.tag);
+}
+
+static void
+song_binary_info(Response &r, const DetachedSong &song, bool base) noexcept
+{
+	song_binary_uri(r, song.GetURI(), base);
+
+	BinaryRange(r, song.GetStartTime(), song.GetEndTime());
+	BinaryLastModified(r, song.GetLastModified());
+	BinaryTagValues(r, song.GetTag());
+	BinaryDuration(r, song.GetDuration());
+}
+
 void
 song_print_info(Response &r, const LightSong &song, bool base) noexcept
 {
+	if (r.IsBinarySongs()) {
+		song_binary_info(r, song, base);
+		return;
+	}
+
 	song_print_uri(r, song, base);
 
 	PrintRange(r, song.start_time, song.end_time);
@@ -97,6 +233,11 @@ song_print_info(Response &r, const LightSong &song, bool base) noexcept
 void
 song_print_info(Response &r, const DetachedSong &song, bool base) noexcept
 {
+	if (r.IsBinarySongs()) {
+		song_binary_info(r, song, base);
+		return;
+	}
+
 	song_print_uri(r, song, base);
 
 	PrintRange(r, song.GetStartTime(), song.GetEndTime());
@@ -108,8 +249,5 @@ song_print_info(Response &r, const DetachedSong &song, bool base) noexcept
 
 	const auto duration = song.GetDuration();
 	if (!duration.IsNegative())
-		r.Format("Time: %i\n"
-			 "duration: %1.3f\n",
-			 duration.RoundS(),
-			 duration.ToDoubleS());
+		tag_print_duration(r, duration);
 }
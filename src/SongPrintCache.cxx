@@ -0,0 +1,163 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "SongPrintCache.hxx"
+#include "SongPrint.hxx"
+#include "song/LightSong.hxx"
+#include "queue/Queue.hxx"
+#include "client/Response.hxx"
+
+#include <string.h>
+
+/**
+ * Calculate the FNV-1a hash of the given string.
+ */
+gcc_pure
+static uint64_t
+HashString(uint64_t hash, const char *p) noexcept
+{
+	for (; *p != 0; ++p)
+		hash = (hash ^ (uint8_t)*p) * 0x100000001b3ULL;
+	return hash;
+}
+
+/**
+ * Does the given string equal "DIRECTORY/URI" (or just "URI" if
+ * #directory is nullptr)?
+ */
+gcc_pure
+static bool
+UriEquals(const std::string &s,
+	  const char *directory, const char *uri) noexcept
+{
+	const char *p = s.c_str();
+
+	if (directory != nullptr) {
+		const size_t length = strlen(directory);
+		if (strncmp(p, directory, length) != 0 || p[length] != '/')
+			return false;
+
+		p += length + 1;
+	}
+
+	return strcmp(p, uri) == 0;
+}
+
+void
+SongPrintCache::Clear() noexcept
+{
+	const std::lock_guard<Mutex> lock(mutex);
+	map.clear();
+	size = 0;
+}
+
+SongPrintCache::Item &
+SongPrintCache::Lookup(const Key &key, const char *directory, const char *uri,
+		       bool &hit) noexcept
+{
+	auto &item = map[key];
+	if (!item.text.empty() &&
+	    (uri == nullptr || UriEquals(item.uri, directory, uri))) {
+		hit = true;
+		return item;
+	}
+
+	hit = false;
+
+	size -= item.text.size();
+	item.text.clear();
+	item.uri.clear();
+
+	if (uri != nullptr) {
+		if (directory != nullptr) {
+			item.uri = directory;
+			item.uri.push_back('/');
+		}
+
+		item.uri.append(uri);
+	}
+
+	return item;
+}
+
+void
+SongPrintCache::Commit(Item &item) noexcept
+{
+	size += item.text.size();
+
+	if (size > max_size) {
+		/* the cache has become too large; the easiest way
+		   to get rid of stale entries is to start over */
+		map.clear();
+		size = 0;
+	}
+}
+
+void
+SongPrintCache::PrintDatabaseSong(Response &r, const LightSong &song,
+				  bool base) noexcept
+{
+	const TagMask tag_mask = r.GetTagMask();
+
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	if (song.directory != nullptr)
+		hash = HashString(HashString(hash, song.directory), "/");
+	hash = HashString(hash, song.uri);
+
+	const std::lock_guard<Mutex> lock(mutex);
+
+	bool hit;
+	auto &item = Lookup({nullptr, hash, 0, tag_mask, base},
+			    song.directory, song.uri, hit);
+	if (!hit) {
+		r.SetCapture(&item.text);
+		song_print_info(r, song, base);
+		r.SetCapture(nullptr);
+	}
+
+	r.Write(item.text.data(), item.text.size());
+
+	if (!hit)
+		Commit(item);
+}
+
+void
+SongPrintCache::PrintQueueSong(Response &r, const Queue &queue,
+			       unsigned position) noexcept
+{
+	const TagMask tag_mask = r.GetTagMask();
+	const auto &qi = queue.items[position];
+
+	const std::lock_guard<Mutex> lock(mutex);
+
+	bool hit;
+	auto &item = Lookup({&queue, qi.id, qi.version, tag_mask, false},
+			    nullptr, nullptr, hit);
+	if (!hit) {
+		r.SetCapture(&item.text);
+		song_print_info(r, *qi.song);
+		r.SetCapture(nullptr);
+	}
+
+	r.Write(item.text.data(), item.text.size());
+
+	if (!hit)
+		Commit(item);
+}
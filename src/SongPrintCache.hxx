@@ -0,0 +1,167 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_SONG_PRINT_CACHE_HXX
+#define MPD_SONG_PRINT_CACHE_HXX
+
+#include "tag/Mask.hxx"
+#include "thread/Mutex.hxx"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+struct LightSong;
+struct Queue;
+class Response;
+
+/**
+ * A cache for the protocol text of song_print_info(), to avoid
+ * formatting the same song over and over again for clients which
+ * poll "listallinfo" or "playlistinfo".
+ *
+ * Database songs are identified by their URI; all of them are
+ * invalidated by Clear() when the database is modified.  Queue items
+ * are identified by their id and Queue::Item::version, which gets
+ * bumped on every modification.
+ *
+ * The cached text depends on the client's tag mask and on the
+ * "base" flag; both are part of the key, so clients with different
+ * "tagtypes" settings get separate entries and don't evict each
+ * other.
+ */
+class SongPrintCache {
+	struct Key {
+		/**
+		 * The #Queue owning the item, or nullptr for database
+		 * songs.
+		 */
+		const void *owner;
+
+		/**
+		 * The queue item id or a hash of the database song
+		 * URI.
+		 */
+		uint64_t id;
+
+		uint32_t version;
+
+		TagMask tag_mask;
+
+		bool base;
+
+		bool operator==(const Key &other) const noexcept {
+			return owner == other.owner && id == other.id &&
+				version == other.version &&
+				tag_mask == other.tag_mask &&
+				base == other.base;
+		}
+	};
+
+	/**
+	 * Omits #Key::tag_mask and #Key::base; there are only a few
+	 * different values, and entries which differ only in them
+	 * may share a bucket.
+	 */
+	struct KeyHash {
+		size_t operator()(const Key &key) const noexcept {
+			return std::hash<const void *>()(key.owner) ^
+				size_t(key.id) ^ (size_t(key.version) << 16);
+		}
+	};
+
+	struct Item {
+		/**
+		 * The full URI of a database song, to detect hash
+		 * collisions.  Empty for queue items.
+		 */
+		std::string uri;
+
+		std::string text;
+	};
+
+	/**
+	 * Protects all fields below.
+	 */
+	Mutex mutex;
+
+	std::unordered_map<Key, Item, KeyHash> map;
+
+	/**
+	 * The maximum total size of all cached texts [bytes].  If
+	 * this is exceeded, the whole cache is flushed.
+	 */
+	const size_t max_size;
+
+	/**
+	 * The total size of all cached texts [bytes].
+	 */
+	size_t size = 0;
+
+public:
+	explicit SongPrintCache(size_t _max_size) noexcept
+		:max_size(_max_size) {}
+
+	SongPrintCache(const SongPrintCache &) = delete;
+	SongPrintCache &operator=(const SongPrintCache &) = delete;
+
+	/**
+	 * Discard all cached texts.  To be called when the database
+	 * has been modified.
+	 */
+	void Clear() noexcept;
+
+	/**
+	 * Like song_print_info(), but use the cached text if
+	 * available.
+	 */
+	void PrintDatabaseSong(Response &r, const LightSong &song,
+			       bool base) noexcept;
+
+	/**
+	 * Like song_print_info() for the song at the given queue
+	 * position, but use the cached text if available.
+	 */
+	void PrintQueueSong(Response &r, const Queue &queue,
+			    unsigned position) noexcept;
+
+private:
+	/**
+	 * Look up the given key, and check whether it is an exact
+	 * match.  On a cache miss, the returned #Item has been
+	 * cleared, and the caller is expected to fill it and call
+	 * Commit().
+	 *
+	 * Caller must lock the mutex.
+	 */
+	Item &Lookup(const Key &key, const char *directory, const char *uri,
+		     bool &hit) noexcept;
+
+	/**
+	 * Account for a newly filled #Item and flush the cache if it
+	 * has become too large.
+	 *
+	 * Caller must lock the mutex.
+	 */
+	void Commit(Item &item) noexcept;
+};
+
+#endif
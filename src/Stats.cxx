@@ -26,6 +26,7 @@
 #include "db/Selection.hxx"
 #include "db/Interface.hxx"
 #include "db/Stats.hxx"
+#include "db/DatabaseError.hxx"
 #include "Log.hxx"
 #include "time/ChronoUtil.hxx"
 #include "util/Math.hxx"
@@ -51,6 +52,13 @@ static DatabaseStats stats;
 
 enum class StatsValidity : uint8_t {
 	INVALID, VALID, FAILED,
+
+	/**
+	 * The database is still being loaded in the background.
+	 * This is never stored in #stats_validity; the next call
+	 * tries again.
+	 */
+	LOADING,
 };
 
 static StatsValidity stats_validity = StatsValidity::INVALID;
@@ -61,39 +69,49 @@ stats_invalidate()
 	stats_validity = StatsValidity::INVALID;
 }
 
-static bool
+static StatsValidity
 stats_update(const Database &db)
 {
-	switch (stats_validity) {
-	case StatsValidity::INVALID:
-		break;
-
-	case StatsValidity::VALID:
-		return true;
-
-	case StatsValidity::FAILED:
-		return false;
-	}
+	if (stats_validity != StatsValidity::INVALID)
+		return stats_validity;
 
 	const DatabaseSelection selection("", true);
 
 	try {
 		stats = db.GetStats(selection);
 		stats_validity = StatsValidity::VALID;
-		return true;
+	} catch (const DatabaseError &e) {
+		if (e.GetCode() == DatabaseErrorCode::LOADING)
+			return StatsValidity::LOADING;
+
+		LogError(std::current_exception());
+		stats_validity = StatsValidity::FAILED;
 	} catch (...) {
 		LogError(std::current_exception());
 		stats_validity = StatsValidity::FAILED;
-		return false;
 	}
+
+	return stats_validity;
 }
 
 static void
 db_stats_print(Response &r, const Database &db)
 {
-	if (!stats_update(db))
+	switch (stats_update(db)) {
+	case StatsValidity::VALID:
+		break;
+
+	case StatsValidity::LOADING:
+		/* report what we have: the non-database values
+		   have already been printed */
+		r.Write("db_loading: 1\n");
 		return;
 
+	case StatsValidity::INVALID:
+	case StatsValidity::FAILED:
+		return;
+	}
+
 	unsigned total_duration_s =
 		std::chrono::duration_cast<std::chrono::seconds>(stats.total_duration).count();
 
@@ -35,14 +35,20 @@ tag_print_types(Response &r) noexcept
 void
 tag_print(Response &r, TagType type, StringView value) noexcept
 {
-	r.Format("%s: %.*s\n", tag_item_names[type],
-		 int(value.size), value.data);
+	r.WriteKeyValue(tag_item_names[type], value);
 }
 
 void
 tag_print(Response &r, TagType type, const char *value) noexcept
 {
-	r.Format("%s: %s\n", tag_item_names[type], value);
+	r.WriteKeyValue(tag_item_names[type], value);
+}
+
+void
+tag_print_duration(Response &r, SignedSongTime duration) noexcept
+{
+	r.WriteKeyUnsigned("Time", duration.RoundS());
+	r.WriteKeyMilliseconds("duration", duration.ToMS());
 }
 
 void
@@ -58,10 +64,7 @@ void
 tag_print(Response &r, const Tag &tag) noexcept
 {
 	if (!tag.duration.IsNegative())
-		r.Format("Time: %i\n"
-			 "duration: %1.3f\n",
-			 tag.duration.RoundS(),
-			 tag.duration.ToDoubleS());
+		tag_print_duration(r, tag.duration);
 
 	tag_print_values(r, tag);
 }
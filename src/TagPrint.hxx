@@ -26,6 +26,7 @@ enum TagType : uint8_t;
 
 struct Tag;
 struct StringView;
+class SignedSongTime;
 class Response;
 
 void
@@ -37,6 +38,12 @@ tag_print(Response &response, TagType type, StringView value) noexcept;
 void
 tag_print(Response &response, TagType type, const char *value) noexcept;
 
+/**
+ * Print the "Time" and "duration" lines.
+ */
+void
+tag_print_duration(Response &response, SignedSongTime duration) noexcept;
+
 void
 tag_print_values(Response &response, const Tag &tag) noexcept;
 
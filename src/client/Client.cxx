@@ -25,10 +25,14 @@
 #include "IdleFlags.hxx"
 #include "config.h"
 
+#ifdef ENABLE_ZLIB
+#include "lib/zlib/Deflate.hxx"
+#endif
+
 Client::~Client() noexcept
 {
-	if (FullyBufferedSocket::IsDefined())
-		FullyBufferedSocket::Close();
+	if (ThreadedBufferedSocket::IsDefined())
+		ThreadedBufferedSocket::Close();
 
 	if (background_command) {
 		background_command->Cancel();
@@ -55,6 +59,8 @@ Client::OnBackgroundCommandFinished() noexcept
 
 	background_command.reset();
 
+	FlushResponse();
+
 	/* just in case OnSocketInput() has returned
 	   InputResult::PAUSE meanwhile */
 	ResumeInput();
@@ -68,9 +74,15 @@ Client::SetPartition(Partition &new_partition) noexcept
 	if (partition == &new_partition)
 		return;
 
+	/* idle serial numbers are specific to a partition; collect
+	   the pending flags before switching */
+	assert(!idle_waiting);
+	idle_flags |= partition->idle_dispatcher.GetFlagsSince(idle_serial);
+
 	partition->clients.erase(partition->clients.iterator_to(*this));
 	partition = &new_partition;
 	partition->clients.push_back(*this);
+	idle_serial = partition->idle_dispatcher.GetSerial();
 
 	/* set idle flags for those subsystems which are specific to
 	   the current partition to force the client to reload its
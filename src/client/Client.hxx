@@ -21,17 +21,20 @@
 #define MPD_CLIENT_H
 
 #include "Message.hxx"
+#include "IdleDispatcher.hxx"
 #include "command/CommandResult.hxx"
 #include "command/CommandListBuilder.hxx"
 #include "tag/Mask.hxx"
-#include "event/FullyBufferedSocket.hxx"
-#include "event/TimerEvent.hxx"
+#include "event/ThreadedBufferedSocket.hxx"
+#include "event/CoarseTimerEvent.hxx"
 #include "util/Compiler.h"
+#include "config.h"
 
 #include <boost/intrusive/link_mode.hpp>
 #include <boost/intrusive/list_hook.hpp>
 
 #include <cstddef>
+#include <cstdint>
 #include <list>
 #include <memory>
 #include <set>
@@ -48,13 +51,15 @@ struct playlist;
 class Database;
 class Storage;
 class BackgroundCommand;
+class ZlibDeflate;
 
 class Client final
-	: FullyBufferedSocket,
+	: ThreadedBufferedSocket,
 	  public boost::intrusive::list_base_hook<boost::intrusive::tag<Partition>,
 						  boost::intrusive::link_mode<boost::intrusive::normal_link>>,
-	  public boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>> {
-	TimerEvent timeout_event;
+	  public boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
+	  public IdleDispatcherHook {
+	CoarseTimerEvent timeout_event;
 
 	Partition *partition;
 
@@ -77,6 +82,13 @@ class Client final
 	/** idle flags that the client wants to receive */
 	unsigned idle_subscriptions;
 
+	/**
+	 * The IdleDispatcher::GetSerial() value at the time this
+	 * client consumed its idle flags last.  All flags dispatched
+	 * after that are pending.
+	 */
+	uint64_t idle_serial;
+
 public:
 	// TODO: make this attribute "private"
 	/**
@@ -113,19 +125,49 @@ private:
 	 */
 	std::unique_ptr<BackgroundCommand> background_command;
 
+	/**
+	 * Has this client enabled the binary song encoding with
+	 * "protocol binary"?
+	 */
+	bool binary_songs = false;
+
+#ifdef ENABLE_ZLIB
+	/**
+	 * If set, then all output is compressed with this object
+	 * (negotiated with the "protocol" command).
+	 */
+	std::unique_ptr<ZlibDeflate> compressor;
+
+	/**
+	 * Was compression requested by the current command?  It will
+	 * be enabled after the response has been sent.
+	 */
+	bool compress_requested = false;
+
+	/**
+	 * Has data been passed to #compressor which was not yet
+	 * flushed?
+	 */
+	bool compressor_pending = false;
+#endif
+
 public:
-	Client(EventLoop &loop, Partition &partition,
+	/**
+	 * @param io_loop the #EventLoop which performs the socket
+	 * I/O; nullptr to do it in the main #EventLoop
+	 */
+	Client(EventLoop &loop, EventLoop *io_loop, Partition &partition,
 	       UniqueSocketDescriptor fd, int uid,
 	       unsigned _permission,
 	       int num) noexcept;
 
 	~Client() noexcept;
 
-	using FullyBufferedSocket::GetEventLoop;
+	using ThreadedBufferedSocket::GetEventLoop;
 
 	gcc_pure
 	bool IsExpired() const noexcept {
-		return !FullyBufferedSocket::IsDefined();
+		return !ThreadedBufferedSocket::IsDefined();
 	}
 
 	void Close() noexcept;
@@ -138,6 +180,43 @@ public:
 	 */
 	bool Write(const char *data) noexcept;
 
+	/**
+	 * Obtain a writable area in the output buffer for formatting
+	 * a response in-place.  Returns an empty buffer if the client
+	 * is going to be closed or if the buffer has no contiguous
+	 * space left; the caller shall then fall back to Write().
+	 */
+	WritableBuffer<void> PrepareWrite() noexcept;
+
+	/**
+	 * Commit data written into the area returned by
+	 * PrepareWrite().
+	 */
+	void CommitWrite(size_t length) noexcept {
+		ThreadedBufferedSocket::CommitWrite(length);
+	}
+
+	/**
+	 * Called after a complete response has been written.  If
+	 * output compression is enabled, this flushes the compressor
+	 * so the client can decode the whole response.
+	 */
+	void FlushResponse() noexcept;
+
+#ifdef ENABLE_ZLIB
+	/**
+	 * Enable zlib compression of all output after the current
+	 * response.
+	 */
+	void RequestDeflate() noexcept {
+		compress_requested = true;
+	}
+
+	bool IsDeflateEnabled() const noexcept {
+		return compressor != nullptr || compress_requested;
+	}
+#endif
+
 	/**
 	 * returns the uid of the client process, or a negative value
 	 * if the uid is unknown
@@ -162,10 +241,26 @@ public:
 		permission = _permission;
 	}
 
+	bool HasBinarySongs() const noexcept {
+		return binary_songs;
+	}
+
+	void SetBinarySongs(bool _binary_songs) noexcept {
+		binary_songs = _binary_songs;
+	}
+
 	/**
 	 * Send "idle" response to this client.
 	 */
 	void IdleNotify() noexcept;
+
+	/**
+	 * Send a pre-formatted "idle" response to this client.  This
+	 * is used by #IdleDispatcher to share one response among
+	 * many clients.
+	 */
+	void IdleNotify(const std::string &response) noexcept;
+
 	void IdleAdd(unsigned flags) noexcept;
 	bool IdleWait(unsigned flags) noexcept;
 
@@ -261,17 +356,21 @@ public:
 	const Storage *GetStorage() const noexcept;
 
 private:
+#ifdef ENABLE_ZLIB
+	bool WriteDeflate(const void *data, size_t length, bool sync) noexcept;
+#endif
+
 	CommandResult ProcessCommandList(bool list_ok,
 					 std::list<std::string> &&list) noexcept;
 
 	CommandResult ProcessLine(char *line) noexcept;
 
-	/* virtual methods from class BufferedSocket */
+	/* virtual methods from class ThreadedBufferedSocket */
 	InputResult OnSocketInput(void *data, size_t length) noexcept override;
 	void OnSocketError(std::exception_ptr ep) noexcept override;
 	void OnSocketClosed() noexcept override;
 
-	/* callback for TimerEvent */
+	/* callback for #timeout_event */
 	void OnTimeout() noexcept;
 };
 
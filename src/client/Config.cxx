@@ -19,6 +19,7 @@
 
 #include "Config.hxx"
 #include "config/Data.hxx"
+#include "event/SocketBufferPool.hxx"
 
 #define CLIENT_TIMEOUT_DEFAULT			(60)
 #define CLIENT_MAX_COMMAND_LIST_DEFAULT		(2048*1024)
@@ -27,6 +28,9 @@
 std::chrono::steady_clock::duration client_timeout;
 size_t client_max_command_list_size;
 size_t client_max_output_buffer_size;
+std::chrono::steady_clock::duration client_idle_coalesce;
+bool client_io_uring;
+SocketBufferPool client_buffer_pool;
 
 void
 client_manager_init(const ConfigData &config)
@@ -44,4 +48,13 @@ client_manager_init(const ConfigData &config)
 		config.GetPositive(ConfigOption::MAX_OUTPUT_BUFFER_SIZE,
 				   CLIENT_MAX_OUTPUT_BUFFER_SIZE_DEFAULT / 1024)
 		* 1024;
+
+	const unsigned idle_coalesce_ms =
+		config.GetUnsigned(ConfigOption::IDLE_COALESCE_TIME, 0U);
+	client_idle_coalesce = std::chrono::milliseconds(idle_coalesce_ms);
+
+	client_buffer_pool.SetLimit(config.GetUnsigned(ConfigOption::MAX_CLIENT_BUFFER_MEMORY,
+						       0U) * size_t(1024));
+
+	client_io_uring = config.GetBool(ConfigOption::CLIENT_IO_URING, false);
 }
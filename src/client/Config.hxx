@@ -23,11 +23,30 @@
 #include <chrono>
 
 struct ConfigData;
+class SocketBufferPool;
 
 extern std::chrono::steady_clock::duration client_timeout;
 extern size_t client_max_command_list_size;
 extern size_t client_max_output_buffer_size;
 
+/**
+ * Coalesce "idle" events within this time window.  Zero disables
+ * coalescing.
+ */
+extern std::chrono::steady_clock::duration client_idle_coalesce;
+
+/**
+ * Use io_uring for client sockets?
+ */
+extern bool client_io_uring;
+
+/**
+ * The buffer pool for client connections; its size is limited by
+ * "max_client_buffer_memory".  Other sockets (e.g. the listeners of
+ * the "httpd" output) use the unlimited #socket_buffer_pool.
+ */
+extern SocketBufferPool client_buffer_pool;
+
 void
 client_manager_init(const ConfigData &config);
 
@@ -33,7 +33,7 @@ Client::SetExpired() noexcept
 		background_command.reset();
 	}
 
-	FullyBufferedSocket::Close();
+	ThreadedBufferedSocket::Close();
 	timeout_event.Schedule(std::chrono::steady_clock::duration::zero());
 }
 
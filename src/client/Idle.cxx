@@ -21,6 +21,7 @@
 #include "Config.hxx"
 #include "Response.hxx"
 #include "Idle.hxx"
+#include "Partition.hxx"
 
 #include <cassert>
 
@@ -40,13 +41,34 @@ void
 Client::IdleNotify() noexcept
 {
 	assert(idle_waiting);
-	assert(idle_flags != 0);
 
-	unsigned flags = std::exchange(idle_flags, 0) & idle_subscriptions;
+	auto &dispatcher = partition->idle_dispatcher;
+	unsigned flags = (std::exchange(idle_flags, 0) |
+			  dispatcher.GetFlagsSince(idle_serial))
+		& idle_subscriptions;
+	idle_serial = dispatcher.GetSerial();
 	idle_waiting = false;
+	IdleDispatcherHook::unlink();
 
 	Response r(*this, 0);
 	WriteIdleResponse(r, flags);
+	FlushResponse();
+
+	timeout_event.Schedule(client_timeout);
+}
+
+void
+Client::IdleNotify(const std::string &response) noexcept
+{
+	assert(idle_waiting);
+	assert(!IdleDispatcherHook::is_linked());
+
+	idle_flags = 0;
+	idle_serial = partition->idle_dispatcher.GetSerial();
+	idle_waiting = false;
+
+	Write(response.data(), response.size());
+	FlushResponse();
 
 	timeout_event.Schedule(client_timeout);
 }
@@ -70,10 +92,14 @@ Client::IdleWait(unsigned flags) noexcept
 	idle_waiting = true;
 	idle_subscriptions = flags;
 
-	if (idle_flags & idle_subscriptions) {
+	auto &dispatcher = partition->idle_dispatcher;
+	if ((idle_flags | dispatcher.GetFlagsSince(idle_serial)) &
+	    idle_subscriptions) {
 		IdleNotify();
 		return true;
 	} else {
+		dispatcher.AddWaiting(*this, idle_subscriptions);
+
 		/* disable timeouts while in "idle" */
 		timeout_event.Cancel();
 		return false;
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "IdleDispatcher.hxx"
+#include "Client.hxx"
+#include "Config.hxx"
+#include "IdleFlags.hxx"
+#include "event/Loop.hxx"
+
+#include <iterator>
+#include <string>
+#include <utility>
+
+IdleDispatcher::IdleDispatcher(EventLoop &loop) noexcept
+	:coalesce_timer(loop, BIND_THIS_METHOD(OnCoalesceTimer))
+{
+}
+
+IdleDispatcher::~IdleDispatcher() noexcept = default;
+
+unsigned
+IdleDispatcher::GetFlagsSince(uint64_t since) const noexcept
+{
+	if (since == serial)
+		/* fast path: nothing has happened */
+		return 0;
+
+	unsigned flags = 0;
+	for (unsigned i = 0; i < std::size(flag_serials); ++i)
+		if (flag_serials[i] > since)
+			flags |= 1U << i;
+
+	return flags;
+}
+
+void
+IdleDispatcher::Emit(unsigned mask) noexcept
+{
+	pending_mask |= mask;
+
+	if (coalesce_timer.IsActive())
+		/* a dispatch is already scheduled */
+		return;
+
+	if (client_idle_coalesce > std::chrono::steady_clock::duration::zero()) {
+		const auto now = coalesce_timer.GetEventLoop().GetTime();
+		const auto elapsed = now - last_dispatch;
+		if (elapsed < client_idle_coalesce) {
+			/* the last dispatch was very recent: wait
+			   for more events */
+			coalesce_timer.Schedule(client_idle_coalesce - elapsed);
+			return;
+		}
+	}
+
+	Dispatch();
+}
+
+void
+IdleDispatcher::AddWaiting(Client &client, unsigned subscriptions) noexcept
+{
+	waiting[subscriptions].push_back(client);
+}
+
+/**
+ * Format the "idle" response for the given flags.
+ */
+static std::string
+FormatIdleResponse(unsigned flags) noexcept
+{
+	std::string response;
+
+	const char *const*idle_names = idle_get_names();
+	for (unsigned i = 0; idle_names[i]; ++i) {
+		if (flags & (1 << i)) {
+			response += "changed: ";
+			response += idle_names[i];
+			response += '\n';
+		}
+	}
+
+	response += "OK\n";
+	return response;
+}
+
+void
+IdleDispatcher::Dispatch() noexcept
+{
+	const unsigned mask = std::exchange(pending_mask, 0);
+	if (mask == 0)
+		return;
+
+	last_dispatch = coalesce_timer.GetEventLoop().GetTime();
+
+	++serial;
+	for (unsigned i = 0; i < std::size(flag_serials); ++i)
+		if (mask & (1U << i))
+			flag_serials[i] = serial;
+
+	for (auto i = waiting.begin(); i != waiting.end();) {
+		auto &clients = i->second;
+		if (clients.empty()) {
+			/* garbage-collect groups which are not used
+			   anymore */
+			i = waiting.erase(i);
+			continue;
+		}
+
+		const unsigned flags = i->first & mask;
+		if (flags != 0) {
+			/* all clients in this group have the same
+			   subscriptions and no pending flags, so they
+			   all receive the same response */
+			const auto response = FormatIdleResponse(flags);
+
+			while (!clients.empty()) {
+				auto &client = clients.front();
+				clients.pop_front();
+				client.IdleNotify(response);
+			}
+		}
+
+		++i;
+	}
+}
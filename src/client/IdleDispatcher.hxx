@@ -0,0 +1,129 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_CLIENT_IDLE_DISPATCHER_HXX
+#define MPD_CLIENT_IDLE_DISPATCHER_HXX
+
+#include "event/TimerEvent.hxx"
+#include "util/Compiler.h"
+
+#include <boost/intrusive/list.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+
+class Client;
+class IdleDispatcher;
+
+/**
+ * The hook which links a #Client waiting in "idle" into an
+ * #IdleDispatcher.
+ */
+using IdleDispatcherHook =
+	boost::intrusive::list_base_hook<boost::intrusive::tag<IdleDispatcher>,
+					 boost::intrusive::link_mode<boost::intrusive::auto_unlink>>;
+
+/**
+ * Delivers "idle" events to the clients of one #Partition.
+ *
+ * Clients which are not waiting in "idle" are not visited at all:
+ * each dispatch increments a serial number, and a client compares its
+ * own serial with the serial of each event flag when it enters
+ * "idle".  Waiting clients are grouped by their subscription mask, so
+ * an event visits only the groups interested in it, and all clients
+ * of a group share one pre-formatted response.
+ *
+ * Optionally, bursts of events are coalesced: after a dispatch,
+ * further events are collected for #client_idle_coalesce before
+ * they are dispatched.
+ */
+class IdleDispatcher final {
+	using ClientList =
+		boost::intrusive::list<Client,
+				       boost::intrusive::base_hook<IdleDispatcherHook>,
+				       boost::intrusive::constant_time_size<false>>;
+
+	/**
+	 * Clients waiting in "idle", indexed by their subscription
+	 * mask.
+	 */
+	std::map<unsigned, ClientList> waiting;
+
+	TimerEvent coalesce_timer;
+
+	std::chrono::steady_clock::time_point last_dispatch;
+
+	/**
+	 * Events which have not yet been dispatched.
+	 */
+	unsigned pending_mask = 0;
+
+	/**
+	 * Incremented by each dispatch.
+	 */
+	uint64_t serial = 0;
+
+	/**
+	 * The value of #serial when each flag was dispatched last.
+	 */
+	uint64_t flag_serials[32]{};
+
+public:
+	explicit IdleDispatcher(EventLoop &loop) noexcept;
+	~IdleDispatcher() noexcept;
+
+	IdleDispatcher(const IdleDispatcher &) = delete;
+	IdleDispatcher &operator=(const IdleDispatcher &) = delete;
+
+	uint64_t GetSerial() const noexcept {
+		return serial;
+	}
+
+	/**
+	 * Determine which flags have been dispatched after the given
+	 * serial number.
+	 */
+	gcc_pure
+	unsigned GetFlagsSince(uint64_t since) const noexcept;
+
+	/**
+	 * Submit new events.  Depending on the coalescing window,
+	 * they are dispatched right away or a bit later.
+	 */
+	void Emit(unsigned mask) noexcept;
+
+	/**
+	 * Register a client which waits for events matching the
+	 * given subscription mask.  It is unregistered by unlinking
+	 * its #IdleDispatcherHook.
+	 */
+	void AddWaiting(Client &client, unsigned subscriptions) noexcept;
+
+private:
+	void Dispatch() noexcept;
+
+	/* callback for #coalesce_timer */
+	void OnCoalesceTimer() noexcept {
+		Dispatch();
+	}
+};
+
+#endif
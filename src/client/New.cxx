@@ -30,23 +30,34 @@
 #include "Log.hxx"
 #include "Version.h"
 
+#ifdef ENABLE_ZLIB
+#include "lib/zlib/Deflate.hxx"
+#endif
+
 #include <cassert>
 
 static constexpr char GREETING[] = "OK MPD " PROTOCOL_VERSION "\n";
 
-Client::Client(EventLoop &_loop, Partition &_partition,
+Client::Client(EventLoop &_loop, EventLoop *_io_loop, Partition &_partition,
 	       UniqueSocketDescriptor _fd,
 	       int _uid, unsigned _permission,
 	       int _num) noexcept
-	:FullyBufferedSocket(_fd.Release(), _loop,
-			     16384, client_max_output_buffer_size),
+	:ThreadedBufferedSocket(_fd.Release(), _loop, _io_loop,
+				client_max_output_buffer_size,
+				client_buffer_pool),
 	 timeout_event(_loop, BIND_THIS_METHOD(OnTimeout)),
 	 partition(&_partition),
 	 permission(_permission),
 	 uid(_uid),
-	 num(_num)
+	 num(_num),
+	 idle_serial(_partition.idle_dispatcher.GetSerial())
 {
 	timeout_event.Schedule(client_timeout);
+
+#ifdef HAVE_URING
+	if (client_io_uring)
+		EnableUring();
+#endif
 }
 
 void
@@ -68,9 +79,10 @@ client_new(EventLoop &loop, Partition &partition,
 	(void)fd.Write(GREETING, sizeof(GREETING) - 1);
 
 	const unsigned num = next_client_num++;
-	auto *client = new Client(loop, partition, std::move(fd), uid,
-				    permission,
-				    num);
+	auto *client = new Client(loop, partition.instance.GetClientIoLoop(),
+				  partition, std::move(fd), uid,
+				  permission,
+				  num);
 
 	client_list.Add(*client);
 	partition.clients.push_back(*client);
@@ -85,8 +97,8 @@ Client::Close() noexcept
 	partition->instance.client_list->Remove(*this);
 	partition->clients.erase(partition->clients.iterator_to(*this));
 
-	if (FullyBufferedSocket::IsDefined())
-		FullyBufferedSocket::Close();
+	if (ThreadedBufferedSocket::IsDefined())
+		ThreadedBufferedSocket::Close();
 
 	FormatInfo(client_domain, "[%u] closed", num);
 	delete this;
@@ -72,6 +72,7 @@ Client::ProcessLine(char *line) noexcept
 		if (idle_waiting) {
 			/* send empty idle response and leave idle mode */
 			idle_waiting = false;
+			IdleDispatcherHook::unlink();
 			command_success(*this);
 		}
 
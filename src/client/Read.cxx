@@ -25,7 +25,7 @@
 
 #include <cstring>
 
-BufferedSocket::InputResult
+Client::InputResult
 Client::OnSocketInput(void *data, size_t length) noexcept
 {
 	if (background_command)
@@ -38,7 +38,7 @@ Client::OnSocketInput(void *data, size_t length) noexcept
 
 	timeout_event.Schedule(client_timeout);
 
-	BufferedSocket::ConsumeInput(newline + 1 - p);
+	ConsumeInput(newline + 1 - p);
 
 	/* skip whitespace at the end of the line */
 	char *end = StripRight(p, newline);
@@ -47,6 +47,9 @@ Client::OnSocketInput(void *data, size_t length) noexcept
 	*end = 0;
 
 	CommandResult result = ProcessLine(p);
+	if (result != CommandResult::BACKGROUND)
+		FlushResponse();
+
 	switch (result) {
 	case CommandResult::OK:
 	case CommandResult::IDLE:
@@ -19,8 +19,23 @@
 
 #include "Response.hxx"
 #include "Client.hxx"
+#include "Instance.hxx"
+#include "SongPrintCache.hxx"
 #include "util/FormatString.hxx"
 #include "util/AllocatedString.hxx"
+#include "util/StringView.hxx"
+#include "util/WritableBuffer.hxx"
+#include "util/ConstBuffer.hxx"
+
+#include <algorithm>
+
+#include <stdio.h>
+#include <string.h>
+
+Response::~Response() noexcept
+{
+	FlushBinarySongs();
+}
 
 TagMask
 Response::GetTagMask() const noexcept
@@ -28,21 +43,73 @@ Response::GetTagMask() const noexcept
 	return GetClient().tag_mask;
 }
 
+SongPrintCache *
+Response::GetSongPrintCache() const noexcept
+{
+	if (capture != nullptr || binary_songs)
+		return nullptr;
+
+	return client.GetInstance().song_print_cache.get();
+}
+
+void
+Response::UseBinarySongs() noexcept
+{
+	binary_songs = client.HasBinarySongs();
+}
+
 bool
 Response::Write(const void *data, size_t length) noexcept
 {
+	if (capture != nullptr) {
+		capture->append((const char *)data, length);
+		return true;
+	}
+
+	/* keep the order of binary and text output */
+	if (!binary_buffer.empty() && !FlushBinarySongs())
+		return false;
+
 	return client.Write(data, length);
 }
 
 bool
 Response::Write(const char *data) noexcept
 {
-	return client.Write(data);
+	return Write(data, strlen(data));
+}
+
+WritableBuffer<void>
+Response::PrepareWrite() noexcept
+{
+	if (capture != nullptr)
+		/* fall back to Write() */
+		return nullptr;
+
+	if (!binary_buffer.empty() && !FlushBinarySongs())
+		return nullptr;
+
+	return client.PrepareWrite();
 }
 
 bool
 Response::FormatV(const char *fmt, std::va_list args) noexcept
 {
+	/* try to format directly into the output buffer; this
+	   succeeds almost always, and avoids a heap allocation */
+	const auto w = PrepareWrite();
+	if (w.size > 0) {
+		std::va_list tmp;
+		va_copy(tmp, args);
+		const int length = vsnprintf((char *)w.data, w.size, fmt, tmp);
+		va_end(tmp);
+
+		if (length >= 0 && size_t(length) < w.size) {
+			client.CommitWrite(length);
+			return true;
+		}
+	}
+
 	return Write(FormatStringV(fmt, args).c_str());
 }
 
@@ -56,6 +123,82 @@ Response::Format(const char *fmt, ...) noexcept
 	return success;
 }
 
+bool
+Response::WriteLine(std::initializer_list<StringView> items) noexcept
+{
+	size_t length = 1;
+	for (const auto &i : items)
+		length += i.size;
+
+	const auto w = PrepareWrite();
+	if (w.size >= length) {
+		char *p = (char *)w.data;
+		for (const auto &i : items)
+			p = std::copy_n(i.data, i.size, p);
+		*p = '\n';
+
+		client.CommitWrite(length);
+		return true;
+	}
+
+	/* not enough contiguous space in the output buffer: copy
+	   each item separately */
+	for (const auto &i : items)
+		if (!Write(i.data, i.size))
+			return false;
+
+	return Write("\n", 1);
+}
+
+bool
+Response::WriteKeyValue(StringView name, StringView value) noexcept
+{
+	return WriteLine({name, ": ", value});
+}
+
+/**
+ * Format the decimal representation of the given number, ending at
+ * the given pointer.
+ *
+ * @return the beginning of the string
+ */
+static char *
+FormatUnsignedBackwards(char *end, unsigned value) noexcept
+{
+	do {
+		*--end = char('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+
+	return end;
+}
+
+bool
+Response::WriteKeyUnsigned(StringView name, unsigned value) noexcept
+{
+	char buffer[16];
+	char *const end = buffer + sizeof(buffer);
+	const char *const begin = FormatUnsignedBackwards(end, value);
+
+	return WriteLine({name, ": ", {begin, end}});
+}
+
+bool
+Response::WriteKeyMilliseconds(StringView name, unsigned ms) noexcept
+{
+	char buffer[24];
+	char *const end = buffer + sizeof(buffer);
+	char *p = end - 4;
+	p[0] = '.';
+	p[1] = char('0' + ms / 100 % 10);
+	p[2] = char('0' + ms / 10 % 10);
+	p[3] = char('0' + ms % 10);
+
+	const char *const begin = FormatUnsignedBackwards(p, ms / 1000);
+
+	return WriteLine({name, ": ", {begin, end}});
+}
+
 bool
 Response::WriteBinary(ConstBuffer<void> payload) noexcept
 {
@@ -66,6 +209,79 @@ Response::WriteBinary(ConstBuffer<void> payload) noexcept
 		Write("\n");
 }
 
+/**
+ * Append an unsigned LEB128 number.
+ */
+static void
+AppendVarint(std::string &dest, size_t value) noexcept
+{
+	while (value >= 0x80) {
+		dest.push_back(char(0x80 | (value & 0x7f)));
+		value >>= 7;
+	}
+
+	dest.push_back(char(value));
+}
+
+void
+Response::WriteBinaryField(BinarySongKey key,
+			   std::initializer_list<StringView> value) noexcept
+{
+	assert(binary_songs);
+
+	size_t length = 0;
+	for (const auto &i : value)
+		length += i.size;
+
+	binary_buffer.push_back(char(key));
+	AppendVarint(binary_buffer, length);
+	for (const auto &i : value)
+		binary_buffer.append(i.data, i.size);
+
+	/* send full chunks early to keep the buffer small */
+	if (binary_buffer.size() >= MAX_BINARY_SIZE)
+		FlushBinarySongs();
+}
+
+void
+Response::WriteBinaryUnsigned(BinarySongKey key, unsigned value) noexcept
+{
+	char buffer[16];
+	char *const end = buffer + sizeof(buffer);
+	const char *const begin = FormatUnsignedBackwards(end, value);
+
+	WriteBinaryField(key, {{begin, end}});
+}
+
+bool
+Response::FlushBinarySongs() noexcept
+{
+	if (binary_buffer.empty())
+		return true;
+
+	/* move the buffer away to avoid recursion from
+	   WriteBinary(); a record may span several chunks */
+	std::string buffer;
+	buffer.swap(binary_buffer);
+
+	bool success = true;
+	for (size_t position = 0; position < buffer.size();) {
+		const size_t n = std::min(buffer.size() - position,
+					  MAX_BINARY_SIZE);
+		if (!WriteBinary({buffer.data() + position, n})) {
+			success = false;
+			break;
+		}
+
+		position += n;
+	}
+
+	/* reuse the allocation */
+	buffer.clear();
+	binary_buffer.swap(buffer);
+	return success;
+}
+
 void
 Response::Error(enum ack code, const char *msg) noexcept
 {
@@ -21,14 +21,20 @@
 #define MPD_RESPONSE_HXX
 
 #include "protocol/Ack.hxx"
+#include "protocol/BinarySong.hxx"
 #include "util/Compiler.h"
 
 #include <cstdarg>
 #include <cstddef>
+#include <initializer_list>
+#include <string>
 
 template<typename T> struct ConstBuffer;
+template<typename T> struct WritableBuffer;
+struct StringView;
 class Client;
 class TagMask;
+class SongPrintCache;
 
 class Response {
 	Client &client;
@@ -44,10 +50,35 @@ class Response {
 	 */
 	const char *command = "";
 
+	/**
+	 * If not nullptr, then all output is appended to this string
+	 * instead of being sent to the client.  This is used by
+	 * #SongPrintCache to record the serialized song.
+	 */
+	std::string *capture = nullptr;
+
+	/**
+	 * Shall songs be sent in the binary encoding?  See
+	 * UseBinarySongs().
+	 */
+	bool binary_songs = false;
+
+	/**
+	 * Binary song fields which have not yet been sent in a
+	 * "binary" chunk.  This is flushed before any text is
+	 * written and at the end of the response.
+	 */
+	std::string binary_buffer;
+
 public:
 	Response(Client &_client, unsigned _list_index) noexcept
 		:client(_client), list_index(_list_index) {}
 
+	/**
+	 * Flushes pending binary song fields.
+	 */
+	~Response() noexcept;
+
 	Response(const Response &) = delete;
 	Response &operator=(const Response &) = delete;
 
@@ -68,15 +99,62 @@ public:
 	gcc_pure
 	TagMask GetTagMask() const noexcept;
 
+	/**
+	 * Returns the instance's #SongPrintCache or nullptr if it is
+	 * disabled.  Always returns nullptr while capturing, to avoid
+	 * recursion.
+	 */
+	gcc_pure
+	SongPrintCache *GetSongPrintCache() const noexcept;
+
 	void SetCommand(const char *_command) noexcept {
 		command = _command;
 	}
 
+	void SetCapture(std::string *_capture) noexcept {
+		capture = _capture;
+	}
+
+	/**
+	 * Called by command handlers which support the binary song
+	 * encoding: if the client has enabled it with "protocol
+	 * binary", then songs in this response will be sent in
+	 * binary chunks.
+	 */
+	void UseBinarySongs() noexcept;
+
+	bool IsBinarySongs() const noexcept {
+		return binary_songs;
+	}
+
 	bool Write(const void *data, size_t length) noexcept;
 	bool Write(const char *data) noexcept;
 	bool FormatV(const char *fmt, std::va_list args) noexcept;
 	bool Format(const char *fmt, ...) noexcept;
 
+	/**
+	 * Write the concatenation of all given strings plus a
+	 * trailing newline.  This is copied directly into the
+	 * client's output buffer without a temporary allocation.
+	 */
+	bool WriteLine(std::initializer_list<StringView> items) noexcept;
+
+	/**
+	 * Write a "NAME: VALUE" line.
+	 */
+	bool WriteKeyValue(StringView name, StringView value) noexcept;
+
+	/**
+	 * Write a "NAME: VALUE" line with an unsigned integer value.
+	 */
+	bool WriteKeyUnsigned(StringView name, unsigned value) noexcept;
+
+	/**
+	 * Write a "NAME: S.MMM" line, i.e. a number of milliseconds
+	 * formatted as seconds with three decimal digits.
+	 */
+	bool WriteKeyMilliseconds(StringView name, unsigned ms) noexcept;
+
 	static constexpr size_t MAX_BINARY_SIZE = 8192;
 
 	/**
@@ -87,8 +165,35 @@ public:
 	 */
 	bool WriteBinary(ConstBuffer<void> payload) noexcept;
 
+	/**
+	 * Append a field to the binary song stream; the value is the
+	 * concatenation of all given strings.  Must only be used if
+	 * IsBinarySongs() is true.
+	 */
+	void WriteBinaryField(BinarySongKey key,
+			      std::initializer_list<StringView> value) noexcept;
+
+	/**
+	 * Append a field with an unsigned integer value to the binary
+	 * song stream.
+	 */
+	void WriteBinaryUnsigned(BinarySongKey key, unsigned value) noexcept;
+
+	/**
+	 * Send all pending binary song fields to the client.
+	 *
+	 * @return true on success
+	 */
+	bool FlushBinarySongs() noexcept;
+
 	void Error(enum ack code, const char *msg) noexcept;
 	void FormatError(enum ack code, const char *fmt, ...) noexcept;
+
+private:
+	/**
+	 * Wrapper for Client::PrepareWrite() which honors #capture.
+	 */
+	WritableBuffer<void> PrepareWrite() noexcept;
 };
 
 #endif
@@ -18,14 +18,61 @@
  */
 
 #include "Client.hxx"
+#include "Log.hxx"
+
+#ifdef ENABLE_ZLIB
+#include "lib/zlib/Deflate.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
+#endif
+
+#include <cassert>
+#include <cstddef>
 
 #include <string.h>
 
+#ifdef ENABLE_ZLIB
+
+bool
+Client::WriteDeflate(const void *data, size_t length, bool sync) noexcept
+{
+	assert(compressor);
+
+	ConstBuffer<void> src(data, length);
+	std::byte buffer[16384];
+
+	while (true) {
+		const size_t n =
+			compressor->Deflate(src, {buffer, sizeof(buffer)},
+					    sync);
+		if (n > 0 && !ThreadedBufferedSocket::Write(buffer, n))
+			return false;
+
+		/* a full output buffer means zlib may have more
+		   pending output */
+		if (src.empty() && n < sizeof(buffer))
+			break;
+	}
+
+	compressor_pending = !sync;
+	return true;
+}
+
+#endif
+
 bool
 Client::Write(const void *data, size_t length) noexcept
 {
 	/* if the client is going to be closed, do nothing */
-	return !IsExpired() && FullyBufferedSocket::Write(data, length);
+	if (IsExpired())
+		return false;
+
+#ifdef ENABLE_ZLIB
+	if (compressor)
+		return WriteDeflate(data, length, false);
+#endif
+
+	return ThreadedBufferedSocket::Write(data, length);
 }
 
 bool
@@ -33,3 +80,45 @@ Client::Write(const char *data) noexcept
 {
 	return Write(data, strlen(data));
 }
+
+WritableBuffer<void>
+Client::PrepareWrite() noexcept
+{
+	if (IsExpired())
+		return nullptr;
+
+#ifdef ENABLE_ZLIB
+	/* the output buffer contains compressed data; in-place
+	   formatting is not possible */
+	if (compressor)
+		return nullptr;
+#endif
+
+	return ThreadedBufferedSocket::PrepareWrite();
+}
+
+void
+Client::FlushResponse() noexcept
+{
+#ifdef ENABLE_ZLIB
+	if (IsExpired())
+		return;
+
+	/* flush only if there is something; a redundant sync flush
+	   would emit an empty stored block */
+	if (compressor_pending && !WriteDeflate(nullptr, 0, true))
+		return;
+
+	if (compress_requested) {
+		compress_requested = false;
+
+		try {
+			compressor = std::make_unique<ZlibDeflate>(Z_BEST_SPEED);
+		} catch (...) {
+			LogError(std::current_exception(),
+				 "Failed to initialize zlib");
+			SetExpired();
+		}
+	}
+#endif
+}
@@ -24,7 +24,9 @@
 #include "client/Response.hxx"
 #include "TagPrint.hxx"
 #include "tag/ParseName.hxx"
+#include "protocol/BinarySong.hxx"
 #include "util/StringAPI.hxx"
+#include "config.h"
 
 CommandResult
 handle_close([[maybe_unused]] Client &client, [[maybe_unused]] Request args,
@@ -109,3 +111,91 @@ handle_tagtypes(Client &client, Request request, Response &r)
 		return CommandResult::ERROR;
 	}
 }
+
+static void
+protocol_print_features(Response &r)
+{
+	r.Write("binary: songs\n");
+#ifdef ENABLE_ZLIB
+	r.Write("compress: zlib\n");
+#endif
+}
+
+/**
+ * Print the key table of the binary song encoding.
+ */
+static void
+protocol_print_binary_keys(Response &r)
+{
+	unsigned key = 0;
+	for (const char *name : binary_song_key_names)
+		r.Format("binarykey: %u %s\n", key++, name);
+
+	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; i++)
+		r.Format("binarykey: %u %s\n",
+			 unsigned(BinarySongTagKey(TagType(i))),
+			 tag_item_names[i]);
+}
+
+static CommandResult
+handle_protocol_binary(Client &client, Request request, Response &r)
+{
+	if (!request.empty()) {
+		r.Error(ACK_ERROR_ARG, "Too many arguments");
+		return CommandResult::ERROR;
+	}
+
+	client.SetBinarySongs(true);
+	protocol_print_binary_keys(r);
+	return CommandResult::OK;
+}
+
+static CommandResult
+handle_protocol_compress(Client &client, Request request, Response &r)
+{
+	if (request.size != 1) {
+		r.Error(ACK_ERROR_ARG, "Wrong number of arguments");
+		return CommandResult::ERROR;
+	}
+
+	const char *algorithm = request.front();
+
+#ifdef ENABLE_ZLIB
+	if (StringIsEqual(algorithm, "zlib")) {
+		if (client.IsDeflateEnabled()) {
+			r.Error(ACK_ERROR_ARG, "Compression already enabled");
+			return CommandResult::ERROR;
+		}
+
+		/* the "OK" of this command is sent uncompressed;
+		   compression begins with the next response */
+		client.RequestDeflate();
+		return CommandResult::OK;
+	}
+#else
+	(void)client;
+#endif
+
+	r.FormatError(ACK_ERROR_ARG, "Unsupported compression: %s",
+		      algorithm);
+	return CommandResult::ERROR;
+}
+
+CommandResult
+handle_protocol(Client &client, Request request, Response &r)
+{
+	if (request.empty()) {
+		protocol_print_features(r);
+		return CommandResult::OK;
+	}
+
+	const char *cmd = request.shift();
+	if (StringIsEqual(cmd, "binary"))
+		return handle_protocol_binary(client, request, r);
+	else if (StringIsEqual(cmd, "compress"))
+		return handle_protocol_compress(client, request, r);
+	else {
+		r.Error(ACK_ERROR_ARG, "Unknown sub command");
+		return CommandResult::ERROR;
+	}
+}
@@ -74,6 +74,9 @@ ToAck(DatabaseErrorCode code) noexcept
 
 	case DatabaseErrorCode::CONFLICT:
 		return ACK_ERROR_ARG;
+
+	case DatabaseErrorCode::LOADING:
+		return ACK_ERROR_UPDATE_ALREADY;
 	}
 
 	return ACK_ERROR_UNKNOWN;
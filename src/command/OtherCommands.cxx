@@ -35,6 +35,7 @@
 #include "ls.hxx"
 #include "mixer/Volume.hxx"
 #include "time/ChronoUtil.hxx"
+#include "Chrono.hxx"
 #include "util/UriUtil.hxx"
 #include "util/StringAPI.hxx"
 #include "util/StringView.hxx"
@@ -44,10 +45,12 @@
 #include "db/PlaylistVector.hxx"
 #include "client/Client.hxx"
 #include "client/Response.hxx"
+#include "client/Config.hxx"
 #include "Partition.hxx"
 #include "Instance.hxx"
 #include "IdleFlags.hxx"
 #include "Log.hxx"
+#include "event/SocketBufferPool.hxx"
 
 #ifdef ENABLE_DATABASE
 #include "DatabaseCommands.hxx"
@@ -366,6 +369,34 @@ handle_stats(Client &client, [[maybe_unused]] Request args, Response &r)
 	return CommandResult::OK;
 }
 
+CommandResult
+handle_loopstats(Client &client, [[maybe_unused]] Request args, Response &r)
+{
+	auto &loop = client.GetInstance().event_loop;
+	const auto &stats = loop.GetStats();
+	const double uptime = FloatDuration(loop.GetTime() - stats.start).count();
+
+	r.Format("uptime: %.3f\n"
+		 "wakeups: %llu\n",
+		 uptime,
+		 (unsigned long long)stats.wakeups);
+
+	if (uptime > 0)
+		r.Format("wakeups_per_second: %.1f\n",
+			 stats.wakeups / uptime);
+
+	r.Format("busy_time: %.6f\n"
+		 "longest_busy: %.6f\n",
+		 FloatDuration(stats.busy_time).count(),
+		 FloatDuration(stats.longest_busy).count());
+
+	const auto pool = client_buffer_pool.GetStats();
+	r.Format("client_buffer_memory: %zu\n"
+		 "client_buffer_memory_peak: %zu\n",
+		 pool.allocated, pool.peak);
+	return CommandResult::OK;
+}
+
 CommandResult
 handle_config(Client &client, [[maybe_unused]] Request args, Response &r)
 {
@@ -221,6 +221,7 @@ handle_plchanges(Client &client, Request args, Response &r)
 {
 	uint32_t version = ParseCommandArgU32(args.front());
 	RangeArg range = args.ParseOptional(1, RangeArg::All());
+	r.UseBinarySongs();
 	playlist_print_changes_info(r, client.GetPlaylist(), version,
 				    range.start, range.end);
 	return CommandResult::OK;
@@ -241,6 +242,7 @@ handle_playlistinfo(Client &client, Request args, Response &r)
 {
 	RangeArg range = args.ParseOptional(0, RangeArg::All());
 
+	r.UseBinarySongs();
 	playlist_print_info(r, client.GetPlaylist(),
 			    range.start, range.end);
 	return CommandResult::OK;
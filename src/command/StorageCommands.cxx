@@ -35,6 +35,7 @@
 #include "db/plugins/simple/SimpleDatabasePlugin.hxx"
 #include "db/update/Service.hxx"
 #include "TimePrint.hxx"
+#include "SongPrintCache.hxx"
 #include "IdleFlags.hxx"
 
 #include <cinttypes> /* for PRIu64 */
@@ -228,6 +229,8 @@ handle_mount(Client &client, Request args, Response &r)
 
 		// TODO: call Instance::OnDatabaseModified()?
 		// TODO: trigger database update?
+		if (instance.song_print_cache)
+			instance.song_print_cache->Clear();
 		instance.EmitIdle(IDLE_DATABASE);
 
 		if (need_update) {
@@ -269,9 +272,12 @@ handle_unmount(Client &client, Request args, Response &r)
 		instance.update->CancelMount(local_uri);
 
 	if (auto *db = dynamic_cast<SimpleDatabase *>(instance.GetDatabase())) {
-		if (db->Unmount(local_uri))
+		if (db->Unmount(local_uri)) {
 			// TODO: call Instance::OnDatabaseModified()?
+			if (instance.song_print_cache)
+				instance.song_print_cache->Clear();
 			instance.EmitIdle(IDLE_DATABASE);
+		}
 	}
 #endif
 
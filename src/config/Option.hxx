@@ -76,6 +76,13 @@ enum class ConfigOption {
 	GAPLESS_MP3_PLAYBACK,
 	AUTO_UPDATE,
 	AUTO_UPDATE_DEPTH,
+	SEEK_INDEX_DIRECTORY,
+	OUTPUT_WORKER_THREADS,
+	SONG_PRINT_CACHE_SIZE,
+	CLIENT_IO_THREADS,
+	IDLE_COALESCE_TIME,
+	MAX_CLIENT_BUFFER_MEMORY,
+	CLIENT_IO_URING,
 	DESPOTIFY_USER,
 	DESPOTIFY_PASSWORD,
 	DESPOTIFY_HIGH_BITRATE,
@@ -72,6 +72,13 @@ const ConfigTemplate config_param_templates[] = {
 	{ "gapless_mp3_playback", false, true },
 	{ "auto_update" },
 	{ "auto_update_depth" },
+	{ "seek_index_directory" },
+	{ "output_worker_threads" },
+	{ "song_print_cache_size" },
+	{ "client_io_threads" },
+	{ "idle_coalesce_time" },
+	{ "max_client_buffer_memory" },
+	{ "client_io_uring" },
 	{ "despotify_user", false, true },
 	{ "despotify_password", false, true },
 	{ "despotify_high_bitrate", false, true },
@@ -24,11 +24,14 @@
 #include "client/Response.hxx"
 #include "song/LightSong.hxx"
 #include "tag/Tag.hxx"
+#include "tag/ItemMap.hxx"
 #include "tag/VisitFallback.hxx"
 #include "TagPrint.hxx"
+#include "util/StringView.hxx"
 
 #include <functional>
 #include <map>
+#include <string_view>
 
 struct SearchStats {
 	unsigned n_songs{0};
@@ -36,9 +39,20 @@ struct SearchStats {
 
 	constexpr SearchStats()
 		: total_duration(0) {}
+
+	SearchStats &operator+=(const SearchStats &other) noexcept {
+		n_songs += other.n_songs;
+		total_duration += other.total_duration;
+		return *this;
+	}
 };
 
-class TagCountMap : public std::map<std::string, SearchStats> {
+/**
+ * Collects the statistics for each value, keyed by interned
+ * #TagItem pointers (nullptr for songs without the tag); strings
+ * are only created for printing.
+ */
+class TagCountMap : public TagItemMap<SearchStats> {
 };
 
 static void
@@ -57,9 +71,16 @@ Print(Response &r, TagType group, const TagCountMap &m) noexcept
 {
 	assert(unsigned(group) < TAG_NUM_OF_ITEM_TYPES);
 
-	for (const auto &i : m) {
-		tag_print(r, group, i.first.c_str());
-		PrintSearchStats(r, i.second);
+	/* sort by value; different items may have the same value
+	   (e.g. "Artist" being a fallback for "AlbumArtist"), so
+	   merge them */
+	std::map<std::string_view, SearchStats> sorted;
+	for (const auto &[item, stats] : m)
+		sorted[item != nullptr ? item->value : ""] += stats;
+
+	for (const auto &[value, stats] : sorted) {
+		tag_print(r, group, value);
+		PrintSearchStats(r, stats);
 	}
 }
 
@@ -75,10 +96,9 @@ stats_visitor_song(SearchStats &stats, const LightSong &song) noexcept
 
 static void
 CollectGroupCounts(TagCountMap &map, const Tag &tag,
-		   const char *value) noexcept
+		   const TagItem *item) noexcept
 {
-	auto r = map.insert(std::make_pair(value, SearchStats()));
-	SearchStats &s = r.first->second;
+	SearchStats &s = map[item];
 	++s.n_songs;
 	if (!tag.duration.IsNegative())
 		s.total_duration += tag.duration;
@@ -89,8 +109,8 @@ GroupCountVisitor(TagCountMap &map, TagType group,
 		  const LightSong &song) noexcept
 {
 	const Tag &tag = song.tag;
-	VisitTagWithFallbackOrEmpty(tag, group, [&](const auto &val)
-		{ return CollectGroupCounts(map, tag, val);  });
+	VisitTagItemsWithFallbackOrEmpty(tag, group, [&](const TagItem *item)
+		{ return CollectGroupCounts(map, tag, item);  });
 }
 
 void
@@ -115,7 +135,7 @@ PrintSongCount(Response &r, const Partition &partition, const char *name,
 		PrintSearchStats(r, stats);
 	} else {
 		/* group by the specified tag: store counts in a
-		   std::map */
+		   TagCountMap */
 
 		TagCountMap map;
 
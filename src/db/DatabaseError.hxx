@@ -32,6 +32,12 @@ enum class DatabaseErrorCode {
 	NOT_FOUND,
 
 	CONFLICT,
+
+	/**
+	 * The database is still being loaded in the background; the
+	 * client may retry later.
+	 */
+	LOADING,
 };
 
 class DatabaseError final : public std::runtime_error {
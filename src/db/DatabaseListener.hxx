@@ -41,6 +41,15 @@ public:
 	 * the database because the file has disappeared.
 	 */
 	virtual void OnDatabaseSongRemoved(const char *uri) noexcept = 0;
+
+	/**
+	 * The database has finished loading in the background (or
+	 * has failed to load).  This is called in the same thread as
+	 * OnDatabaseModified().
+	 */
+	virtual void OnDatabaseLoaded() noexcept {
+		OnDatabaseModified();
+	}
 };
 
 #endif
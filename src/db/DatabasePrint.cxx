@@ -20,6 +20,7 @@
 #include "DatabasePrint.hxx"
 #include "Selection.hxx"
 #include "SongPrint.hxx"
+#include "SongPrintCache.hxx"
 #include "TimePrint.hxx"
 #include "client/Response.hxx"
 #include "Partition.hxx"
@@ -110,7 +111,11 @@ PrintSongBrief(Response &r, bool base, const LightSong &song) noexcept
 static void
 PrintSongFull(Response &r, bool base, const LightSong &song) noexcept
 {
-	song_print_info(r, song, base);
+	auto *cache = r.GetSongPrintCache();
+	if (cache != nullptr)
+		cache->PrintDatabaseSong(r, song, base);
+	else
+		song_print_info(r, song, base);
 
 	if (song.tag.has_playlist)
 		/* this song file has an embedded CUE sheet */
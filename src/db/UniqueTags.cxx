@@ -20,12 +20,24 @@
 #include "UniqueTags.hxx"
 #include "Interface.hxx"
 #include "song/LightSong.hxx"
+#include "tag/ItemMap.hxx"
 #include "tag/VisitFallback.hxx"
 #include "util/ConstBuffer.hxx"
 #include "util/RecursiveMap.hxx"
 
+/**
+ * The intermediate result of CollectUniqueTags(): a tree keyed by
+ * interned #TagItem pointers (nullptr for songs without the tag).
+ * This avoids copying the value string and comparing strings for
+ * each song; strings are only created when converting the (much
+ * smaller) tree to a #RecursiveMap.
+ */
+struct UniqueTagNode {
+	TagItemMap<UniqueTagNode> children;
+};
+
 static void
-CollectUniqueTags(RecursiveMap<std::string> &result,
+CollectUniqueTags(UniqueTagNode &node,
 		  const Tag &tag,
 		  ConstBuffer<TagType> tag_types) noexcept
 {
@@ -34,20 +46,34 @@ CollectUniqueTags(RecursiveMap<std::string> &result,
 
 	const auto tag_type = tag_types.shift();
 
-	VisitTagWithFallbackOrEmpty(tag, tag_type, [&result, &tag, tag_types](const char *value){
-			CollectUniqueTags(result[value], tag, tag_types);
+	VisitTagItemsWithFallbackOrEmpty(tag, tag_type, [&node, &tag, tag_types](const TagItem *item){
+			CollectUniqueTags(node.children[item], tag, tag_types);
 		});
 }
 
+static void
+ToRecursiveMap(RecursiveMap<std::string> &dest,
+	       const UniqueTagNode &src) noexcept
+{
+	/* different items may have the same value (e.g. "Artist"
+	   being a fallback for "AlbumArtist"); std::map merges
+	   them */
+	for (const auto &[item, child] : src.children)
+		ToRecursiveMap(dest[item != nullptr ? item->value : ""],
+			       child);
+}
+
 RecursiveMap<std::string>
 CollectUniqueTags(const Database &db, const DatabaseSelection &selection,
 		  ConstBuffer<TagType> tag_types)
 {
-	RecursiveMap<std::string> result;
+	UniqueTagNode root;
 
-	db.Visit(selection, [&result, tag_types](const LightSong &song){
-			CollectUniqueTags(result, song.tag, tag_types);
+	db.Visit(selection, [&root, tag_types](const LightSong &song){
+			CollectUniqueTags(root, song.tag, tag_types);
 		});
 
+	RecursiveMap<std::string> result;
+	ToRecursiveMap(result, root);
 	return result;
 }
@@ -33,6 +33,8 @@
 #include "DatabaseSave.hxx"
 #include "db/DatabaseLock.hxx"
 #include "db/DatabaseError.hxx"
+#include "db/DatabaseListener.hxx"
+#include "song/Filter.hxx"
 #include "fs/io/TextFile.hxx"
 #include "fs/io/BufferedOutputStream.hxx"
 #include "fs/io/FileOutputStream.hxx"
@@ -43,6 +45,7 @@
 #include "util/Domain.hxx"
 #include "util/ConstBuffer.hxx"
 #include "util/RecursiveMap.hxx"
+#include "thread/Name.hxx"
 #include "Log.hxx"
 
 #ifdef ENABLE_ZLIB
@@ -51,6 +54,7 @@
 
 #include <cerrno>
 #include <memory>
+#include <optional>
 
 static constexpr Domain simple_db_domain("simple_db");
 
@@ -68,6 +72,19 @@ inline SimpleDatabase::SimpleDatabase(const ConfigBlock &block)
 	path_utf8 = path.ToUTF8();
 }
 
+inline SimpleDatabase::SimpleDatabase(const ConfigBlock &block,
+				      EventLoop &event_loop,
+				      DatabaseListener &_listener)
+	:SimpleDatabase(block)
+{
+	background_load = block.GetBlockValue("background_load", false);
+	if (background_load) {
+		listener = &_listener;
+		loaded_event = std::make_unique<DeferEvent>(event_loop,
+							    BIND_THIS_METHOD(OnLoaded));
+	}
+}
+
 inline SimpleDatabase::SimpleDatabase(AllocatedPath &&_path,
 #ifndef ENABLE_ZLIB
 				      [[maybe_unused]]
@@ -84,11 +101,12 @@ inline SimpleDatabase::SimpleDatabase(AllocatedPath &&_path,
 }
 
 DatabasePtr
-SimpleDatabase::Create(EventLoop &, EventLoop &,
-		       [[maybe_unused]] DatabaseListener &listener,
+SimpleDatabase::Create(EventLoop &main_event_loop, EventLoop &,
+		       DatabaseListener &listener,
 		       const ConfigBlock &block)
 {
-	return std::make_unique<SimpleDatabase>(block);
+	return std::make_unique<SimpleDatabase>(block, main_event_loop,
+						listener);
 }
 
 void
@@ -145,20 +163,108 @@ SimpleDatabase::Check() const
 }
 
 void
-SimpleDatabase::Load()
+SimpleDatabase::CheckLoaded() const
+{
+	if (IsLoading())
+		throw DatabaseError(DatabaseErrorCode::LOADING,
+				    "Database is still loading");
+}
+
+std::chrono::system_clock::time_point
+SimpleDatabase::Load(Directory &dest) const
 {
 	assert(!path.IsNull());
-	assert(root != nullptr);
 
 	TextFile file(path);
 
 	LogDebug(simple_db_domain, "reading DB");
 
-	db_load_internal(file, *root);
+	db_load_internal(file, dest);
 
 	FileInfo fi;
 	if (GetFileInfo(path, fi))
-		mtime = fi.GetModificationTime();
+		return fi.GetModificationTime();
+
+	return std::chrono::system_clock::time_point::min();
+}
+
+void
+SimpleDatabase::Load()
+{
+	assert(root != nullptr);
+
+	mtime = Load(*root);
+}
+
+bool
+SimpleDatabase::StartLoadThread() noexcept
+{
+	assert(loading_root == nullptr);
+
+	loading_root = Directory::NewRoot();
+	loading = true;
+
+	try {
+		load_thread.Start();
+		return true;
+	} catch (...) {
+		LogError(std::current_exception(),
+			 "Failed to start the database loader thread");
+		loading = false;
+		delete loading_root;
+		loading_root = nullptr;
+		return false;
+	}
+}
+
+void
+SimpleDatabase::LoadThread() noexcept
+{
+	SetThreadName("db_load");
+
+	try {
+		loading_mtime = Load(*loading_root);
+	} catch (...) {
+		load_error = std::current_exception();
+	}
+
+	loaded_event->Schedule();
+}
+
+void
+SimpleDatabase::OnLoaded() noexcept
+{
+	assert(IsLoading());
+
+	load_thread.Join();
+
+	if (load_error) {
+		LogError(load_error);
+		load_error = nullptr;
+
+		try {
+			Check();
+		} catch (...) {
+			LogError(std::current_exception());
+		}
+	} else {
+		{
+			const ScopeDatabaseLock protect;
+			std::swap(root, loading_root);
+			mtime = loading_mtime;
+		}
+
+		LogDebug(simple_db_domain, "DB loaded");
+	}
+
+	/* this is either the empty root which was used while
+	   loading, or the one which failed to load */
+	delete loading_root;
+	loading_root = nullptr;
+
+	loading = false;
+
+	listener->OnDatabaseLoaded();
 }
 
 void
@@ -173,6 +279,9 @@ SimpleDatabase::Open()
 	borrowed_song_count = 0;
 #endif
 
+	if (background_load && StartLoadThread())
+		return;
+
 	try {
 		Load();
 	} catch (...) {
@@ -193,6 +302,17 @@ SimpleDatabase::Close() noexcept
 	assert(prefixed_light_song == nullptr);
 	assert(borrowed_song_count == 0);
 
+	if (IsLoading()) {
+		/* there is no way to interrupt the loader; wait for
+		   it */
+		loaded_event->Cancel();
+		load_thread.Join();
+		loading = false;
+		delete loading_root;
+		loading_root = nullptr;
+		load_error = nullptr;
+	}
+
 	delete root;
 }
 
@@ -203,6 +323,8 @@ SimpleDatabase::GetSong(std::string_view uri) const
 	assert(prefixed_light_song == nullptr);
 	assert(borrowed_song_count == 0);
 
+	CheckLoaded();
+
 	ScopeDatabaseLock protect;
 
 	auto r = root->LookupDirectory(uri);
@@ -281,6 +403,8 @@ SimpleDatabase::Visit(const DatabaseSelection &selection,
 		      VisitSong visit_song,
 		      VisitPlaylist visit_playlist) const
 {
+	CheckLoaded();
+
 	ScopeDatabaseLock protect;
 
 	auto r = root->LookupDirectory(selection.uri);
@@ -305,7 +429,20 @@ SimpleDatabase::Visit(const DatabaseSelection &selection,
 		if (selection.recursive && visit_directory)
 			visit_directory(r.directory->Export());
 
-		r.directory->Walk(selection.recursive, selection.filter,
+		const SongFilter *filter = selection.filter;
+
+		/* the walk is limited to the selected directory, so
+		   "base" items which are implied by it don't need to
+		   be evaluated for each song */
+		std::optional<SongFilter> pruned_filter;
+		if (filter != nullptr && filter->GetBase() != nullptr) {
+			pruned_filter.emplace(filter->WithoutImpliedBase(selection.uri.c_str()));
+			filter = pruned_filter->IsEmpty()
+				? nullptr
+				: &*pruned_filter;
+		}
+
+		r.directory->Walk(selection.recursive, filter,
 				  visit_directory, visit_song,
 				  visit_playlist);
 		helper.Commit();
@@ -334,12 +471,16 @@ RecursiveMap<std::string>
 SimpleDatabase::CollectUniqueTags(const DatabaseSelection &selection,
 				  ConstBuffer<TagType> tag_types) const
 {
+	CheckLoaded();
+
 	return ::CollectUniqueTags(*this, selection, tag_types);
 }
 
 DatabaseStats
 SimpleDatabase::GetStats(const DatabaseSelection &selection) const
 {
+	CheckLoaded();
+
 	return ::GetStats(*this, selection);
 }
 
@@ -400,6 +541,8 @@ SimpleDatabase::Mount(const char *uri, DatabasePtr db)
 	assert(db != nullptr);
 	assert(*uri != 0);
 
+	CheckLoaded();
+
 	ScopeDatabaseLock protect;
 
 	auto r = root->LookupDirectory(uri);
@@ -430,6 +573,8 @@ IsUnsafeChar(char ch)
 bool
 SimpleDatabase::Mount(const char *local_uri, const char *storage_uri)
 {
+	CheckLoaded();
+
 	if (cache_path.IsNull())
 		throw DatabaseError(DatabaseErrorCode::NOT_FOUND,
 				    "No 'cache_directory' configured");
@@ -456,6 +601,9 @@ SimpleDatabase::Mount(const char *local_uri, const char *storage_uri)
 inline DatabasePtr
 SimpleDatabase::LockUmountSteal(const char *uri) noexcept
 {
+	if (IsLoading())
+		return nullptr;
+
 	ScopeDatabaseLock protect;
 
 	auto r = root->LookupDirectory(uri);
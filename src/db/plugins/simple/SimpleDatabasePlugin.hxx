@@ -22,13 +22,18 @@
 
 #include "db/Interface.hxx"
 #include "db/Ptr.hxx"
+#include "event/DeferEvent.hxx"
 #include "fs/AllocatedPath.hxx"
 #include "song/LightSong.hxx"
+#include "thread/Thread.hxx"
 #include "util/Manual.hxx"
 #include "util/Compiler.h"
 #include "config.h"
 
+#include <atomic>
 #include <cassert>
+#include <exception>
+#include <memory>
 
 struct ConfigBlock;
 struct Directory;
@@ -54,6 +59,39 @@ class SimpleDatabase : public Database {
 
 	std::chrono::system_clock::time_point mtime;
 
+	/**
+	 * Load the database file in a separate thread (setting
+	 * "background_load"), so MPD can accept clients while the
+	 * file is being parsed.  Until it is finished, all database
+	 * operations fail with DatabaseErrorCode::LOADING.
+	 *
+	 * This is only possible for the configured database, not for
+	 * mounted ones, because only that one knows the #EventLoop
+	 * and the #DatabaseListener.
+	 */
+	bool background_load = false;
+
+	DatabaseListener *listener = nullptr;
+
+	/**
+	 * Invokes OnLoaded() in the main thread after #load_thread
+	 * has finished.
+	 */
+	std::unique_ptr<DeferEvent> loaded_event;
+
+	Thread load_thread{BIND_THIS_METHOD(LoadThread)};
+
+	/**
+	 * The root directory being filled by #load_thread.
+	 */
+	Directory *loading_root = nullptr;
+
+	std::chrono::system_clock::time_point loading_mtime;
+
+	std::exception_ptr load_error;
+
+	std::atomic_bool loading{false};
+
 	/**
 	 * A buffer for GetSong() when prefixing the #LightSong
 	 * instance from a mounted #Database.
@@ -71,6 +109,8 @@ class SimpleDatabase : public Database {
 
 public:
 	SimpleDatabase(const ConfigBlock &block);
+	SimpleDatabase(const ConfigBlock &block,
+		       EventLoop &event_loop, DatabaseListener &_listener);
 	SimpleDatabase(AllocatedPath &&_path, bool _compress) noexcept;
 
 	static DatabasePtr Create(EventLoop &main_event_loop,
@@ -78,9 +118,17 @@ public:
 				  DatabaseListener &listener,
 				  const ConfigBlock &block);
 
+	/**
+	 * Is the database file still being loaded in the background?
+	 */
+	bool IsLoading() const noexcept {
+		return loading;
+	}
+
 	gcc_pure
 	Directory &GetRoot() noexcept {
 		assert(root != NULL);
+		assert(!IsLoading());
 
 		return *root;
 	}
@@ -138,11 +186,39 @@ private:
 
 	void Check() const;
 
+	/**
+	 * Throws #DatabaseError if the database is still being
+	 * loaded in the background.
+	 */
+	void CheckLoaded() const;
+
+	/**
+	 * Load the database file into the given (empty) root
+	 * directory.
+	 *
+	 * Throws #std::runtime_error on error.
+	 *
+	 * @return the modification time of the database file
+	 */
+	std::chrono::system_clock::time_point Load(Directory &dest) const;
+
 	/**
 	 * Throws #std::runtime_error on error.
 	 */
 	void Load();
 
+	/**
+	 * Start loading the database file in #load_thread.
+	 *
+	 * @return false if the thread could not be started
+	 */
+	bool StartLoadThread() noexcept;
+
+	void LoadThread() noexcept;
+
+	/* DeferEvent callback */
+	void OnLoaded() noexcept;
+
 	DatabasePtr LockUmountSteal(const char *uri) noexcept;
 };
 
@@ -21,6 +21,7 @@
 #include "InotifyDomain.hxx"
 #include "Service.hxx"
 #include "Log.hxx"
+#include "db/DatabaseError.hxx"
 #include "protocol/Ack.hxx" // for class ProtocolError
 #include "util/StringCompare.hxx"
 
@@ -50,6 +51,14 @@ InotifyQueue::OnDelay() noexcept
 					return;
 				}
 
+				throw;
+			} catch (const DatabaseError &e) {
+				if (e.GetCode() == DatabaseErrorCode::LOADING) {
+					/* retry later */
+					delay_event.Schedule(INOTIFY_UPDATE_DELAY);
+					return;
+				}
+
 				throw;
 			}
 		} catch (...) {
@@ -22,6 +22,7 @@
 #include "UpdateDomain.hxx"
 #include "db/DatabaseListener.hxx"
 #include "db/DatabaseLock.hxx"
+#include "db/DatabaseError.hxx"
 #include "db/plugins/simple/SimpleDatabasePlugin.hxx"
 #include "db/plugins/simple/Directory.hxx"
 #include "storage/CompositeStorage.hxx"
@@ -72,6 +73,10 @@ UpdateService::CancelAllAsync() noexcept
 void
 UpdateService::CancelMount(const char *uri) noexcept
 {
+	if (db.IsLoading())
+		/* nothing can be mounted yet */
+		return;
+
 	/* determine which (mounted) database will be updated and what
 	   storage will be scanned */
 
@@ -173,6 +178,10 @@ UpdateService::Enqueue(std::string_view path, bool discard)
 {
 	assert(GetEventLoop().IsInside());
 
+	if (db.IsLoading())
+		throw DatabaseError(DatabaseErrorCode::LOADING,
+				    "Database is still loading");
+
 	/* determine which (mounted) database will be updated and what
 	   storage will be scanned */
 	SimpleDatabase *db2;
@@ -21,6 +21,8 @@
 #include "DecoderAPI.hxx"
 #include "Domain.hxx"
 #include "Control.hxx"
+#include "SeekIndex.hxx"
+#include "SeekIndexCache.hxx"
 #include "song/DetachedSong.hxx"
 #include "pcm/Convert.hxx"
 #include "MusicPipe.hxx"
@@ -642,3 +644,25 @@ DecoderBridge::SubmitMixRamp(MixRampInfo &&mix_ramp) noexcept
 {
 	dc.SetMixRamp(std::move(mix_ramp));
 }
+
+std::unique_ptr<SeekIndex>
+DecoderBridge::LoadSeekIndex(const char *plugin, uint64_t size) noexcept
+{
+	if (dc.seek_index_cache == nullptr)
+		return nullptr;
+
+	return dc.seek_index_cache->Load(plugin, dc.song->GetURI(),
+					 dc.song->GetLastModified(), size);
+}
+
+void
+DecoderBridge::StoreSeekIndex(const char *plugin, uint64_t size,
+			      const SeekIndex &index) noexcept
+{
+	if (dc.seek_index_cache == nullptr || index.empty())
+		return;
+
+	dc.seek_index_cache->Store(plugin, dc.song->GetURI(),
+				   dc.song->GetLastModified(), size,
+				   index);
+}
@@ -183,6 +183,10 @@ public:
 	DecoderCommand SubmitTag(InputStream *is, Tag &&tag) noexcept override;
 	void SubmitReplayGain(const ReplayGainInfo *replay_gain_info) noexcept override;
 	void SubmitMixRamp(MixRampInfo &&mix_ramp) noexcept override;
+	std::unique_ptr<SeekIndex> LoadSeekIndex(const char *plugin,
+						 uint64_t size) noexcept override;
+	void StoreSeekIndex(const char *plugin, uint64_t size,
+			    const SeekIndex &index) noexcept override;
 
 private:
 	/**
@@ -26,8 +26,10 @@
 #include "util/Compiler.h"
 
 #include <cstdint>
+#include <memory>
 
 struct AudioFormat;
+struct SeekIndex;
 struct Tag;
 struct ReplayGainInfo;
 class MixRampInfo;
@@ -167,6 +169,27 @@ public:
 	 * Store MixRamp tags.
 	 */
 	virtual void SubmitMixRamp(MixRampInfo &&mix_ramp) noexcept = 0;
+
+	/**
+	 * Load a #SeekIndex for the current song which was saved by
+	 * StoreSeekIndex() previously.
+	 *
+	 * @param plugin the name of the decoder plugin
+	 * @param size the size of the file in bytes; the index is
+	 * invalid if it has changed
+	 * @return the index or nullptr if none is available
+	 */
+	virtual std::unique_ptr<SeekIndex> LoadSeekIndex(const char *plugin,
+							 uint64_t size) noexcept;
+
+	/**
+	 * Save a #SeekIndex for the current song, to be loaded by
+	 * LoadSeekIndex() the next time it is played.  This is a
+	 * no-op if the client does not support persistent seek
+	 * indexes.
+	 */
+	virtual void StoreSeekIndex(const char *plugin, uint64_t size,
+				    const SeekIndex &index) noexcept;
 };
 
 #endif
@@ -46,6 +46,7 @@ class DetachedSong;
 class MusicBuffer;
 class MusicPipe;
 class InputCacheManager;
+class SeekIndexCache;
 
 enum class DecoderState : uint8_t {
 	STOP = 0,
@@ -70,6 +71,11 @@ class DecoderControl final : public InputStreamHandler {
 public:
 	InputCacheManager *const input_cache;
 
+	/**
+	 * Persistent storage for seek indexes; may be nullptr.
+	 */
+	SeekIndexCache *const seek_index_cache;
+
 	/**
 	 * This lock protects #state and #command.
 	 *
@@ -183,6 +189,7 @@ public:
 	 */
 	DecoderControl(Mutex &_mutex, Cond &_client_cond,
 		       InputCacheManager *_input_cache,
+		       SeekIndexCache *_seek_index_cache,
 		       const AudioFormat _configured_audio_format,
 		       const ReplayGainConfig &_replay_gain_config) noexcept;
 	~DecoderControl() noexcept;
@@ -18,11 +18,24 @@
  */
 
 #include "DecoderAPI.hxx"
+#include "SeekIndex.hxx"
 #include "input/InputStream.hxx"
 #include "Log.hxx"
 
 #include <cassert>
 
+std::unique_ptr<SeekIndex>
+DecoderClient::LoadSeekIndex(const char *, uint64_t) noexcept
+{
+	return nullptr;
+}
+
+void
+DecoderClient::StoreSeekIndex(const char *, uint64_t,
+			      const SeekIndex &) noexcept
+{
+}
+
 size_t
 decoder_read(DecoderClient *client,
 	     InputStream &is,
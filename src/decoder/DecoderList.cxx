@@ -20,9 +20,12 @@
 #include "config.h"
 #include "DecoderList.hxx"
 #include "DecoderPlugin.hxx"
+#include "Domain.hxx"
 #include "decoder/Features.h"
 #include "PluginUnavailable.hxx"
 #include "Log.hxx"
+#include "thread/Name.hxx"
+#include "thread/Thread.hxx"
 #include "config/Data.hxx"
 #include "config/Block.hxx"
 #include "plugins/AudiofileDecoderPlugin.hxx"
@@ -49,7 +52,9 @@
 #include "plugins/SidplayDecoderPlugin.hxx"
 #include "util/RuntimeError.hxx"
 
+#include <chrono>
 #include <iterator>
+#include <memory>
 
 #include <string.h>
 
@@ -132,11 +137,93 @@ decoder_plugin_from_name(const char *name) noexcept
 		});
 }
 
+/**
+ * Initializes one decoder plugin, possibly in a separate thread.
+ * Some plugins take a long time to initialize (e.g. soundfont or ROM
+ * loading), and initializing them in parallel bounds the startup
+ * time by the slowest plugin instead of the sum of all.
+ */
+class DecoderPluginInit {
+	const DecoderPlugin &plugin;
+	const ConfigBlock &block;
+
+	Thread thread{BIND_THIS_METHOD(RunThread)};
+
+	std::chrono::steady_clock::duration duration{};
+
+	std::exception_ptr error;
+
+	bool result = false;
+
+public:
+	DecoderPluginInit(const DecoderPlugin &_plugin,
+			  const ConfigBlock &_block) noexcept
+		:plugin(_plugin), block(_block) {}
+
+	/**
+	 * Run the plugin's init() method in a new thread, or in the
+	 * current thread if no thread could be created.
+	 */
+	void Start() noexcept {
+		try {
+			thread.Start();
+		} catch (...) {
+			Run();
+		}
+	}
+
+	/**
+	 * Run the plugin's init() method in the current thread.
+	 */
+	void Run() noexcept {
+		const auto start_time = std::chrono::steady_clock::now();
+
+		try {
+			result = plugin.Init(block);
+		} catch (...) {
+			error = std::current_exception();
+		}
+
+		duration = std::chrono::steady_clock::now() - start_time;
+	}
+
+	/**
+	 * Wait for the plugin's init() method to finish.
+	 *
+	 * Throws the exception thrown by the init() method.
+	 *
+	 * @return the return value of the init() method
+	 */
+	bool Wait() {
+		if (thread.IsDefined())
+			thread.Join();
+
+		FormatDebug(decoder_domain,
+			    "Decoder plugin '%s' initialized in %u ms",
+			    plugin.name,
+			    unsigned(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()));
+
+		if (error)
+			std::rethrow_exception(error);
+
+		return result;
+	}
+
+private:
+	void RunThread() noexcept {
+		SetThreadName("decoder_init");
+		Run();
+	}
+};
+
 void
 decoder_plugin_init_all(const ConfigData &config)
 {
 	ConfigBlock empty;
 
+	std::unique_ptr<DecoderPluginInit> init[num_decoder_plugins];
+	bool serial[num_decoder_plugins]{};
+
 	for (unsigned i = 0; decoder_plugins[i] != nullptr; ++i) {
 		const DecoderPlugin &plugin = *decoder_plugins[i];
 		const auto *param =
@@ -152,18 +239,59 @@ decoder_plugin_init_all(const ConfigData &config)
 		if (param != nullptr)
 			param->SetUsed();
 
+		if (plugin.init == nullptr) {
+			/* nothing to do, no need for a thread */
+			decoder_plugins_enabled[i] = true;
+			continue;
+		}
+
+		init[i] = std::make_unique<DecoderPluginInit>(plugin, *param);
+		serial[i] = !param->GetBlockValue("parallel_init", true);
+	}
+
+	/* plugins which must not be initialized concurrently with
+	   others ("parallel_init no") run one after another in this
+	   thread, before the other threads are started */
+	for (unsigned i = 0; decoder_plugins[i] != nullptr; ++i)
+		if (init[i] && serial[i])
+			init[i]->Run();
+
+	for (unsigned i = 0; decoder_plugins[i] != nullptr; ++i)
+		if (init[i] && !serial[i])
+			init[i]->Start();
+
+	/* wait for all threads before throwing, because they refer
+	   to the ConfigBlock objects */
+
+	std::exception_ptr error;
+
+	for (unsigned i = 0; decoder_plugins[i] != nullptr; ++i) {
+		if (!init[i])
+			continue;
+
+		const DecoderPlugin &plugin = *decoder_plugins[i];
+
 		try {
-			if (plugin.Init(*param))
+			if (init[i]->Wait())
 				decoder_plugins_enabled[i] = true;
 		} catch (const PluginUnavailable &e) {
 			FormatError(e,
 				    "Decoder plugin '%s' is unavailable",
 				    plugin.name);
 		} catch (...) {
-			std::throw_with_nested(FormatRuntimeError("Failed to initialize decoder plugin '%s'",
-								  plugin.name));
+			if (!error) {
+				try {
+					std::throw_with_nested(FormatRuntimeError("Failed to initialize decoder plugin '%s'",
+										  plugin.name));
+				} catch (...) {
+					error = std::current_exception();
+				}
+			}
 		}
 	}
+
+	if (error)
+		std::rethrow_exception(error);
 }
 
 void
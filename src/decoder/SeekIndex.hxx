@@ -0,0 +1,108 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_DECODER_SEEK_INDEX_HXX
+#define MPD_DECODER_SEEK_INDEX_HXX
+
+#include "util/Compiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/**
+ * A table which maps positions within a song to byte offsets within
+ * the (compressed) file.  It is used by decoder plugins for formats
+ * which do not have an index (e.g. MP3) to seek quickly.  It is built
+ * while decoding, and may be persisted by #SeekIndexCache.
+ */
+struct SeekIndex {
+	struct Point {
+		/**
+		 * The position in frames (samples per channel) of
+		 * the unit beginning at #offset.
+		 */
+		uint64_t frame;
+
+		/**
+		 * The byte offset within the file.
+		 */
+		uint64_t offset;
+	};
+
+	/**
+	 * The sample rate of the #Point::frame values.
+	 */
+	unsigned sample_rate = 0;
+
+	/**
+	 * Ordered by #Point::frame and #Point::offset.
+	 */
+	std::vector<Point> points;
+
+	SeekIndex() = default;
+
+	explicit SeekIndex(unsigned _sample_rate) noexcept
+		:sample_rate(_sample_rate) {}
+
+	bool empty() const noexcept {
+		return points.empty();
+	}
+
+	std::size_t size() const noexcept {
+		return points.size();
+	}
+
+	/**
+	 * Append a point.  It is ignored if it is not after the last
+	 * one.
+	 *
+	 * @return true if the point was added
+	 */
+	bool Add(uint64_t frame, uint64_t offset) noexcept {
+		if (!points.empty() &&
+		    (frame <= points.back().frame ||
+		     offset <= points.back().offset))
+			return false;
+
+		points.push_back({frame, offset});
+		return true;
+	}
+
+	/**
+	 * Find the last point at or before the given position.
+	 *
+	 * @return the point or nullptr if the position is before the
+	 * first point
+	 */
+	gcc_pure
+	const Point *Find(uint64_t frame) const noexcept {
+		auto i = std::upper_bound(points.begin(), points.end(), frame,
+					  [](uint64_t f, const Point &p){
+						  return f < p.frame;
+					  });
+		if (i == points.begin())
+			return nullptr;
+
+		return &*std::prev(i);
+	}
+};
+
+#endif
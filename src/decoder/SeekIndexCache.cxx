@@ -0,0 +1,264 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "SeekIndexCache.hxx"
+#include "SeekIndex.hxx"
+#include "Domain.hxx"
+#include "fs/io/FileReader.hxx"
+#include "fs/io/FileOutputStream.hxx"
+#include "fs/io/BufferedOutputStream.hxx"
+#include "system/Error.hxx"
+#include "Log.hxx"
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
+
+static constexpr char seek_index_magic[8] = {
+	'M', 'P', 'D', 'S', 'E', 'E', 'K', '1',
+};
+
+/**
+ * Refuse to load files larger than this; they are certainly corrupt.
+ */
+static constexpr uint64_t max_seek_index_file_size = 64 * 1024 * 1024;
+
+static void
+WriteVarint(BufferedOutputStream &os, uint64_t value)
+{
+	uint8_t buffer[10];
+	size_t n = 0;
+
+	do {
+		uint8_t byte = value & 0x7f;
+		value >>= 7;
+		if (value != 0)
+			byte |= 0x80;
+		buffer[n++] = byte;
+	} while (value != 0);
+
+	os.Write(buffer, n);
+}
+
+static void
+WriteString(BufferedOutputStream &os, const char *s)
+{
+	const size_t length = strlen(s);
+	WriteVarint(os, length);
+	os.Write(s, length);
+}
+
+class SeekIndexParser {
+	const uint8_t *p;
+	const uint8_t *const end;
+
+public:
+	SeekIndexParser(const uint8_t *_p, const uint8_t *_end) noexcept
+		:p(_p), end(_end) {}
+
+	bool SkipMagic() noexcept {
+		if (size_t(end - p) < sizeof(seek_index_magic) ||
+		    memcmp(p, seek_index_magic, sizeof(seek_index_magic)) != 0)
+			return false;
+
+		p += sizeof(seek_index_magic);
+		return true;
+	}
+
+	bool ReadVarint(uint64_t &value_r) noexcept {
+		uint64_t value = 0;
+		for (unsigned shift = 0; shift < 64; shift += 7) {
+			if (p == end)
+				return false;
+
+			const uint8_t byte = *p++;
+			value |= uint64_t(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0) {
+				value_r = value;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * Check if the next string equals the given one.
+	 */
+	bool MatchString(const char *s) noexcept {
+		uint64_t length;
+		if (!ReadVarint(length) || length != strlen(s) ||
+		    length > uint64_t(end - p) ||
+		    memcmp(p, s, length) != 0)
+			return false;
+
+		p += length;
+		return true;
+	}
+};
+
+AllocatedPath
+SeekIndexCache::MakePath(const char *plugin, const char *uri) const noexcept
+{
+	/* FNV-1a over plugin name and URI */
+	uint64_t hash = 14695981039346656037ULL;
+	const auto update = [&hash](const char *s){
+		do {
+			hash ^= uint8_t(*s);
+			hash *= 1099511628211ULL;
+		} while (*s++ != 0);
+	};
+
+	update(plugin);
+	update(uri);
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.seek",
+		 (unsigned long long)hash);
+
+	return AllocatedPath::Build(directory, AllocatedPath::FromUTF8(name));
+}
+
+static uint64_t
+ToSeconds(std::chrono::system_clock::time_point t) noexcept
+{
+	return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch()).count();
+}
+
+std::unique_ptr<SeekIndex>
+SeekIndexCache::Load(const char *plugin, const char *uri,
+		     std::chrono::system_clock::time_point mtime,
+		     uint64_t size) const noexcept
+try {
+	const auto path = MakePath(plugin, uri);
+
+	std::vector<uint8_t> buffer;
+
+	try {
+		FileReader reader(path);
+
+		const uint64_t file_size = reader.GetSize();
+		if (file_size > max_seek_index_file_size)
+			return nullptr;
+
+		buffer.resize(file_size);
+
+		size_t position = 0;
+		while (position < buffer.size()) {
+			size_t nbytes = reader.Read(buffer.data() + position,
+						    buffer.size() - position);
+			if (nbytes == 0)
+				return nullptr;
+
+			position += nbytes;
+		}
+	} catch (const std::system_error &e) {
+		if (IsFileNotFound(e))
+			return nullptr;
+
+		throw;
+	}
+
+	SeekIndexParser parser(buffer.data(), buffer.data() + buffer.size());
+
+	uint64_t file_mtime, file_size, sample_rate, n_points;
+	if (!parser.SkipMagic() ||
+	    !parser.MatchString(plugin) ||
+	    !parser.MatchString(uri) ||
+	    !parser.ReadVarint(file_mtime) ||
+	    !parser.ReadVarint(file_size) ||
+	    !parser.ReadVarint(sample_rate) ||
+	    !parser.ReadVarint(n_points))
+		return nullptr;
+
+	if (file_mtime != ToSeconds(mtime) || file_size != size)
+		/* stale */
+		return nullptr;
+
+	if (sample_rate == 0 || sample_rate > 1024 * 1024 ||
+	    n_points > buffer.size())
+		return nullptr;
+
+	auto index = std::make_unique<SeekIndex>(sample_rate);
+	index->points.reserve(n_points);
+
+	uint64_t frame = 0, offset = 0;
+	for (uint64_t i = 0; i < n_points; ++i) {
+		uint64_t frame_delta, offset_delta;
+		if (!parser.ReadVarint(frame_delta) ||
+		    !parser.ReadVarint(offset_delta))
+			return nullptr;
+
+		frame += frame_delta;
+		offset += offset_delta;
+
+		if (offset > size)
+			return nullptr;
+
+		index->points.push_back({frame, offset});
+	}
+
+	FormatDebug(decoder_domain, "Loaded seek index for %s (%zu points)",
+		    uri, index->size());
+
+	return index;
+} catch (...) {
+	LogError(std::current_exception(), "Failed to load seek index");
+	return nullptr;
+}
+
+void
+SeekIndexCache::Store(const char *plugin, const char *uri,
+		      std::chrono::system_clock::time_point mtime,
+		      uint64_t size,
+		      const SeekIndex &index) const noexcept
+try {
+	FileOutputStream file(MakePath(plugin, uri));
+	BufferedOutputStream os(file);
+
+	os.Write(seek_index_magic, sizeof(seek_index_magic));
+	WriteString(os, plugin);
+	WriteString(os, uri);
+	WriteVarint(os, ToSeconds(mtime));
+	WriteVarint(os, size);
+	WriteVarint(os, index.sample_rate);
+	WriteVarint(os, index.size());
+
+	/* store deltas, because they are small and their varint
+	   representation is compact */
+	uint64_t frame = 0, offset = 0;
+	for (const auto &i : index.points) {
+		WriteVarint(os, i.frame - frame);
+		WriteVarint(os, i.offset - offset);
+		frame = i.frame;
+		offset = i.offset;
+	}
+
+	os.Flush();
+	file.Commit();
+
+	FormatDebug(decoder_domain, "Saved seek index for %s (%zu points)",
+		    uri, index.size());
+} catch (...) {
+	LogError(std::current_exception(), "Failed to save seek index");
+}
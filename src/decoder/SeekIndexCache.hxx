@@ -0,0 +1,71 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_DECODER_SEEK_INDEX_CACHE_HXX
+#define MPD_DECODER_SEEK_INDEX_CACHE_HXX
+
+#include "fs/AllocatedPath.hxx"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+struct SeekIndex;
+
+/**
+ * Persistent storage for #SeekIndex objects.  Each index is stored
+ * in a file inside a configured directory; it is identified by the
+ * decoder plugin name and the song URI, and is valid only as long as
+ * the file's modification time and size match.
+ *
+ * This class is stateless (apart from the configured directory) and
+ * may be used from any thread.
+ */
+class SeekIndexCache {
+	const AllocatedPath directory;
+
+public:
+	explicit SeekIndexCache(AllocatedPath &&_directory) noexcept
+		:directory(std::move(_directory)) {}
+
+	/**
+	 * Load the index for the given file.
+	 *
+	 * @return the index, or nullptr if there is no valid index
+	 */
+	std::unique_ptr<SeekIndex> Load(const char *plugin, const char *uri,
+					std::chrono::system_clock::time_point mtime,
+					uint64_t size) const noexcept;
+
+	/**
+	 * Store the index for the given file, replacing an existing
+	 * one.  Errors are logged.
+	 */
+	void Store(const char *plugin, const char *uri,
+		   std::chrono::system_clock::time_point mtime,
+		   uint64_t size,
+		   const SeekIndex &index) const noexcept;
+
+private:
+	AllocatedPath MakePath(const char *plugin,
+			       const char *uri) const noexcept;
+};
+
+#endif
@@ -31,8 +31,10 @@
 #include "lib/ffmpeg/Codec.hxx"
 #include "lib/ffmpeg/SampleFormat.hxx"
 #include "../DecoderAPI.hxx"
+#include "../SeekIndex.hxx"
 #include "FfmpegMetaData.hxx"
 #include "FfmpegIo.hxx"
+#include "Mp4Scan.hxx"
 #include "pcm/Interleave.hxx"
 #include "tag/Builder.hxx"
 #include "tag/Handler.hxx"
@@ -461,6 +463,95 @@ FfmpegCheckTag(DecoderClient &client, InputStream &is,
 		client.SubmitTag(is, tag.Commit());
 }
 
+/**
+ * Does the demuxer build its index only while reading packets?  Only
+ * for those formats, a persistent seek index is useful.
+ */
+static bool
+FfmpegWantSeekIndex(const AVFormatContext &format_context,
+		    const InputStream &input) noexcept
+{
+	return (format_context.iformat->flags & AVFMT_GENERIC_INDEX) != 0 &&
+		input.IsSeekable() && input.KnownSize();
+}
+
+static int
+FfmpegIndexEntriesCount(AVStream &stream) noexcept
+{
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100)
+	return avformat_index_get_entries_count(&stream);
+#else
+	return stream.nb_index_entries;
+#endif
+}
+
+static const AVIndexEntry *
+FfmpegIndexEntry(AVStream &stream, int i) noexcept
+{
+#if LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100)
+	return avformat_index_get_entry(&stream, i);
+#else
+	return &stream.index_entries[i];
+#endif
+}
+
+/**
+ * Add the entries of a persistent seek index to the stream's index.
+ *
+ * @return the number of entries which were added
+ */
+static size_t
+FfmpegLoadSeekIndex(DecoderClient &client, const InputStream &input,
+		    AVStream &stream, unsigned sample_rate) noexcept
+{
+	const auto index = client.LoadSeekIndex("ffmpeg", input.GetSize());
+	if (index == nullptr || index->sample_rate != sample_rate)
+		return 0;
+
+	const AVRational sample_time_base{1, int(sample_rate)};
+	const int64_t start = start_time_fallback(stream);
+
+	for (const auto &point : index->points)
+		av_add_index_entry(&stream, point.offset,
+				   av_rescale_q(point.frame, sample_time_base,
+						stream.time_base) + start,
+				   0, 0, AVINDEX_KEYFRAME);
+
+	return index->size();
+}
+
+/**
+ * Save the stream's index as a persistent seek index, if it has
+ * grown since FfmpegLoadSeekIndex().
+ */
+static void
+FfmpegStoreSeekIndex(DecoderClient &client, const InputStream &input,
+		     AVStream &stream, unsigned sample_rate,
+		     size_t loaded) noexcept
+{
+	const int n = FfmpegIndexEntriesCount(stream);
+	if (n <= 0 || size_t(n) <= loaded)
+		return;
+
+	const AVRational sample_time_base{1, int(sample_rate)};
+	const int64_t start = start_time_fallback(stream);
+
+	SeekIndex index(sample_rate);
+	index.points.reserve(n);
+
+	for (int i = 0; i < n; ++i) {
+		const AVIndexEntry &entry = *FfmpegIndexEntry(stream, i);
+		if (entry.timestamp < start || entry.pos < 0)
+			continue;
+
+		index.Add(av_rescale_q(entry.timestamp - start,
+				       stream.time_base, sample_time_base),
+			  entry.pos);
+	}
+
+	client.StoreSeekIndex("ffmpeg", input.GetSize(), index);
+}
+
 static void
 FfmpegDecode(DecoderClient &client, InputStream &input,
 	     AVFormatContext &format_context)
@@ -519,6 +610,13 @@ FfmpegDecode(DecoderClient &client, InputStream &input,
 
 	FfmpegParseMetaData(client, format_context, audio_stream);
 
+	const bool want_seek_index =
+		FfmpegWantSeekIndex(format_context, input);
+	const size_t loaded_seek_index = want_seek_index
+		? FfmpegLoadSeekIndex(client, input, av_stream,
+				      audio_format.sample_rate)
+		: 0;
+
 	Ffmpeg::Frame frame;
 
 	FfmpegBuffer interleaved_buffer;
@@ -569,6 +667,11 @@ FfmpegDecode(DecoderClient &client, InputStream &input,
 		} else
 			cmd = client.GetCommand();
 	}
+
+	if (want_seek_index)
+		FfmpegStoreSeekIndex(client, input, av_stream,
+				     audio_format.sample_rate,
+				     loaded_seek_index);
 }
 
 static void
@@ -623,9 +726,75 @@ FfmpegScanStream(AVFormatContext &format_context, TagHandler &handler)
 	return true;
 }
 
+/**
+ * Scan an MP4 file with our own "moov" parser instead of opening an
+ * AVFormatContext and probing the streams.  This is only done for
+ * AAC LC; everything else is left to libavformat, because the
+ * reported #AudioFormat would depend on what libavcodec's decoder
+ * makes of it.  The tags are passed through an #AVDictionary with
+ * the same key names libavformat uses, so the result is the same.
+ *
+ * Throws on I/O error.
+ */
+static bool
+FfmpegScanMp4(InputStream &is, TagHandler &handler)
+{
+	Mp4Info info;
+	if (!ScanMp4Header(is, info) ||
+	    /* some metadata items need libavformat's
+	       conversion */
+	    !info.complete ||
+	    memcmp(info.codec, "mp4a", 4) != 0 ||
+	    info.object_type != 0x40 || info.audio_object_type != 2 ||
+	    /* this may be HE-AAC with implicit SBR signalling,
+	       which libavcodec reports with the doubled sample
+	       rate */
+	    info.sample_rate <= 24000)
+		return false;
+
+	const AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_AAC);
+	if (codec == nullptr || codec->sample_fmts == nullptr)
+		return false;
+
+	const auto sample_format = ffmpeg_sample_format(codec->sample_fmts[0]);
+	if (sample_format == SampleFormat::UNDEFINED)
+		return false;
+
+	if (info.time_scale > 0 && info.duration > 0)
+		handler.OnDuration(SongTime::FromScale<uint64_t>(info.duration,
+								 info.time_scale));
+
+	try {
+		handler.OnAudioFormat(CheckAudioFormat(info.sample_rate,
+						       sample_format,
+						       info.channels));
+	} catch (...) {
+	}
+
+	AVDictionary *dict = nullptr;
+	AtScopeExit(&dict) { av_dict_free(&dict); };
+
+	for (const auto &i : info.tags)
+		av_dict_set(&dict, i.first.c_str(), i.second.c_str(), 0);
+
+	FfmpegScanDictionary(dict, handler);
+	return true;
+}
+
 static bool
 ffmpeg_scan_stream(InputStream &is, TagHandler &handler)
 {
+	if (is.CheapSeeking()) {
+		try {
+			if (FfmpegScanMp4(is, handler))
+				return true;
+		} catch (...) {
+			/* fall back to libavformat */
+		}
+
+		is.LockRewind();
+	}
+
 	AvioStream stream(nullptr, is);
 	if (!stream.Open())
 		return false;
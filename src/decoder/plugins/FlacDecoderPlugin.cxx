@@ -22,8 +22,11 @@
 #include "FlacDomain.hxx"
 #include "FlacCommon.hxx"
 #include "lib/xiph/FlacMetadataChain.hxx"
+#include "lib/xiph/FlacHeaderScan.hxx"
 #include "OggCodec.hxx"
 #include "input/InputStream.hxx"
+#include "input/LocalOpen.hxx"
+#include "thread/Mutex.hxx"
 #include "fs/Path.hxx"
 #include "fs/NarrowPath.hxx"
 #include "Log.hxx"
@@ -68,9 +71,45 @@ flac_write_cb(const FLAC__StreamDecoder *dec, const FLAC__Frame *frame,
 	return fd.OnWrite(*frame, buf, fd.GetDeltaPosition(*dec));
 }
 
+/**
+ * Try the native metadata parser, which reads only the metadata
+ * blocks MPD is interested in and does not need to set up a libFLAC
+ * metadata chain.
+ */
+static bool
+flac_scan_header(InputStream &is, TagHandler &handler) noexcept
+{
+	if (!is.CheapSeeking())
+		/* we may need to rewind for libFLAC */
+		return false;
+
+	try {
+		if (ScanFlacHeader(is, handler))
+			return true;
+	} catch (...) {
+		/* fall back to libFLAC, which will report the
+		   error */
+	}
+
+	try {
+		is.LockRewind();
+	} catch (...) {
+	}
+
+	return false;
+}
+
 static bool
 flac_scan_file(Path path_fs, TagHandler &handler)
 {
+	try {
+		Mutex mutex;
+		auto is = OpenLocalInputStream(path_fs, mutex);
+		if (flac_scan_header(*is, handler))
+			return true;
+	} catch (...) {
+	}
+
 	FlacMetadataChain chain;
 	if (!chain.Read(NarrowPath(path_fs))) {
 		FormatDebug(flac_domain,
@@ -86,6 +125,9 @@ flac_scan_file(Path path_fs, TagHandler &handler)
 static bool
 flac_scan_stream(InputStream &is, TagHandler &handler)
 {
+	if (flac_scan_header(is, handler))
+		return true;
+
 	FlacMetadataChain chain;
 	if (!chain.Read(is)) {
 		FormatDebug(flac_domain,
@@ -20,6 +20,7 @@
 #include "config.h"
 #include "MadDecoderPlugin.hxx"
 #include "../DecoderAPI.hxx"
+#include "../SeekIndex.hxx"
 #include "input/InputStream.hxx"
 #include "tag/Id3Scan.hxx"
 #include "tag/Id3ReplayGain.hxx"
@@ -39,6 +40,7 @@
 #include <id3tag.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
 
 #include <stdlib.h>
@@ -114,6 +116,13 @@ class MadDecoder {
 	mad_timer_t *times = nullptr;
 	size_t highest_frame = 0;
 	size_t max_frames = 0;
+
+	/**
+	 * The number of frames in #frame_offsets which were loaded
+	 * from a persistent seek index.
+	 */
+	size_t loaded_frames = 0;
+
 	size_t current_frame = 0;
 	unsigned int drop_start_frames;
 	unsigned int drop_end_frames;
@@ -169,6 +178,18 @@ private:
 		times = new mad_timer_t[max_frames];
 	}
 
+	/**
+	 * Fill #frame_offsets and #times from a seek index which was
+	 * saved by StoreSeekIndex() previously.
+	 */
+	void LoadSeekIndex() noexcept;
+
+	/**
+	 * Save #frame_offsets and #times as a persistent seek index,
+	 * if we learned more about this file than we already knew.
+	 */
+	void StoreSeekIndex() noexcept;
+
 	[[nodiscard]] gcc_pure
 	size_t TimeToFrame(SongTime t) const noexcept;
 
@@ -779,18 +800,63 @@ MadDecoder::~MadDecoder() noexcept
 	delete[] times;
 }
 
-size_t
-MadDecoder::TimeToFrame(SongTime t) const noexcept
+inline void
+MadDecoder::LoadSeekIndex() noexcept
 {
-	size_t i;
+	if (!input_stream.IsSeekable() || !input_stream.KnownSize())
+		return;
 
-	for (i = 0; i < highest_frame; ++i) {
-		auto frame_time = ToSongTime(times[i]);
-		if (frame_time >= t)
-			break;
+	const auto index = client->LoadSeekIndex("mad",
+						 input_stream.GetSize());
+	if (index == nullptr || index->size() < 2 ||
+	    index->sample_rate != frame.header.samplerate)
+		return;
+
+	/* each point marks the beginning of a frame, and the end of
+	   the previous one; the end of the last frame is unknown,
+	   therefore it is omitted */
+	const size_t n = std::min(index->size() - 1, max_frames);
+	for (size_t i = 0; i < n; ++i) {
+		frame_offsets[i] = index->points[i].offset;
+		mad_timer_set(&times[i], 0, index->points[i + 1].frame,
+			      index->sample_rate);
 	}
 
-	return i;
+	highest_frame = loaded_frames = n;
+}
+
+inline void
+MadDecoder::StoreSeekIndex() noexcept
+{
+	if (highest_frame <= loaded_frames + 1 ||
+	    !input_stream.IsSeekable() || !input_stream.KnownSize())
+		return;
+
+	const unsigned sample_rate = frame.header.samplerate;
+
+	SeekIndex index(sample_rate);
+	index.points.reserve(highest_frame);
+	index.Add(0, frame_offsets[0]);
+
+	for (size_t i = 1; i < highest_frame; ++i)
+		if (!index.Add(mad_timer_count(times[i - 1],
+					       mad_units(sample_rate)),
+			       frame_offsets[i]))
+			/* must be contiguous */
+			break;
+
+	client->StoreSeekIndex("mad", input_stream.GetSize(), index);
+}
+
+size_t
+MadDecoder::TimeToFrame(SongTime t) const noexcept
+{
+	const auto end = times + highest_frame;
+	const auto i = std::lower_bound(times, end, t,
+					[](const mad_timer_t &a, SongTime b){
+						return ToSongTime(a) < b;
+					});
+	return i - times;
 }
 
 void
@@ -973,6 +1039,7 @@ MadDecoder::RunDecoder() noexcept
 	}
 
 	AllocateBuffers();
+	LoadSeekIndex();
 
 	client->Ready(CheckAudioFormat(frame.header.samplerate,
 				       SampleFormat::S24_P32,
@@ -984,6 +1051,8 @@ MadDecoder::RunDecoder() noexcept
 		client->SubmitTag(input_stream, std::move(tag));
 
 	while (Read()) {}
+
+	StoreSeekIndex();
 }
 
 static void
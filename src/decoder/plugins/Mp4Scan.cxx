@@ -0,0 +1,797 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "Mp4Scan.hxx"
+#include "input/InputStream.hxx"
+#include "util/ConstBuffer.hxx"
+
+#include <algorithm>
+
+namespace {
+
+/**
+ * "moov" boxes larger than this are not parsed here.
+ */
+constexpr uint64_t MAX_MOOV_SIZE = 16 * 1024 * 1024;
+
+using Buffer = ConstBuffer<uint8_t>;
+
+constexpr uint32_t
+FourCC(const char (&s)[5]) noexcept
+{
+	return (uint32_t(uint8_t(s[0])) << 24) |
+		(uint32_t(uint8_t(s[1])) << 16) |
+		(uint32_t(uint8_t(s[2])) << 8) |
+		uint32_t(uint8_t(s[3]));
+}
+
+constexpr uint16_t
+ReadBE16(const uint8_t *p) noexcept
+{
+	return (p[0] << 8) | p[1];
+}
+
+constexpr uint32_t
+ReadBE32(const uint8_t *p) noexcept
+{
+	return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+		(uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+constexpr uint64_t
+ReadBE64(const uint8_t *p) noexcept
+{
+	return (uint64_t(ReadBE32(p)) << 32) | ReadBE32(p + 4);
+}
+
+/**
+ * Convert a duration from one time scale to another.  The division
+ * is done first, so the intermediate result cannot overflow.
+ */
+constexpr uint64_t
+ScaleDuration(uint64_t value, uint32_t from, uint32_t to) noexcept
+{
+	return value / from * to + value % from * to / from;
+}
+
+/**
+ * Invoke the given function for each box in the buffer.  Trailing
+ * bytes which are too small for a box header are ignored, because
+ * some encoders pad "udta" with zeroes.
+ *
+ * @return false if the buffer is malformed
+ */
+template<typename F>
+bool
+ForEachBox(Buffer b, F &&f)
+{
+	while (b.size >= 8) {
+		uint64_t size = ReadBE32(b.data);
+		const uint32_t type = ReadBE32(b.data + 4);
+		size_t header_size = 8;
+
+		if (size == 1) {
+			if (b.size < 16)
+				return false;
+
+			size = ReadBE64(b.data + 8);
+			header_size = 16;
+		} else if (size == 0)
+			size = b.size;
+
+		if (size < header_size || size > b.size)
+			return false;
+
+		if (!f(type, Buffer(b.data + header_size,
+				    size - header_size)))
+			return false;
+
+		b.skip_front(size);
+	}
+
+	return true;
+}
+
+/**
+ * Skip the version and flags of a "full box".
+ */
+bool
+SkipFullBoxHeader(Buffer &b) noexcept
+{
+	if (b.size < 4)
+		return false;
+
+	b.skip_front(4);
+	return true;
+}
+
+/**
+ * Read an MPEG-4 descriptor (ISO/IEC 14496-1) with its
+ * variable-length size.
+ */
+bool
+ReadDescriptor(Buffer &b, uint8_t &tag_r, Buffer &body_r) noexcept
+{
+	if (b.empty())
+		return false;
+
+	tag_r = b.front();
+	b.skip_front(1);
+
+	size_t size = 0;
+	for (unsigned i = 0;; ++i) {
+		if (b.empty() || i >= 4)
+			return false;
+
+		const uint8_t byte = b.front();
+		b.skip_front(1);
+		size = (size << 7) | (byte & 0x7f);
+		if ((byte & 0x80) == 0)
+			break;
+	}
+
+	if (size > b.size)
+		return false;
+
+	body_r = {b.data, size};
+	b.skip_front(size);
+	return true;
+}
+
+/**
+ * Find the first descriptor with the given tag.
+ */
+bool
+FindDescriptor(Buffer b, uint8_t tag, Buffer &body_r) noexcept
+{
+	uint8_t t;
+	while (ReadDescriptor(b, t, body_r))
+		if (t == tag)
+			return true;
+
+	return false;
+}
+
+/**
+ * The libavformat names of iTunes metadata items.
+ */
+struct Mp4TagName {
+	uint32_t type;
+	const char *name;
+};
+
+/**
+ * Text items.
+ */
+constexpr Mp4TagName mp4_tag_names[] = {
+	{ FourCC("\xa9nam"), "title" },
+	{ FourCC("\xa9""ART"), "artist" },
+	{ FourCC("\xa9""aut"), "artist" },
+	{ FourCC("aART"), "album_artist" },
+	{ FourCC("\xa9""alb"), "album" },
+	{ FourCC("\xa9""day"), "date" },
+	{ FourCC("\xa9gen"), "genre" },
+	{ FourCC("\xa9wrt"), "composer" },
+	{ FourCC("\xa9""com"), "composer" },
+	{ FourCC("\xa9""cmt"), "comment" },
+	{ FourCC("\xa9inf"), "comment" },
+	{ FourCC("\xa9grp"), "grouping" },
+	{ FourCC("\xa9lyr"), "lyrics" },
+	{ FourCC("\xa9too"), "encoder" },
+	{ FourCC("\xa9""enc"), "encoder" },
+	{ FourCC("\xa9swr"), "encoder" },
+	{ FourCC("\xa9prf"), "performers" },
+	{ FourCC("\xa9xyz"), "location" },
+	{ FourCC("desc"), "description" },
+	{ FourCC("ldes"), "synopsis" },
+	{ FourCC("cprt"), "copyright" },
+	{ FourCC("\xa9""cpy"), "copyright" },
+	{ FourCC("keyw"), "keywords" },
+	{ FourCC("catg"), "category" },
+	{ FourCC("purd"), "purchase_date" },
+	{ FourCC("apID"), "account_id" },
+	{ FourCC("tvsh"), "show" },
+	{ FourCC("tven"), "episode_id" },
+	{ FourCC("tvnn"), "network" },
+	{ FourCC("soar"), "sort_artist" },
+	{ FourCC("soaa"), "sort_album_artist" },
+	{ FourCC("soal"), "sort_album" },
+	{ FourCC("sonm"), "sort_name" },
+	{ FourCC("soco"), "sort_composer" },
+	{ FourCC("sosn"), "sort_show" },
+};
+
+/**
+ * Items whose value is a single unsigned byte.
+ */
+constexpr Mp4TagName mp4_int8_tag_names[] = {
+	{ FourCC("cpil"), "compilation" },
+	{ FourCC("pgap"), "gapless_playback" },
+	{ FourCC("hdvd"), "hd_video" },
+	{ FourCC("pcst"), "podcast" },
+	{ FourCC("stik"), "media_type" },
+	{ FourCC("rtng"), "rating" },
+};
+
+/**
+ * Read a signed big-endian integer with 1, 2, 3 or 4 bytes.
+ */
+constexpr bool
+ReadSignedBE(Buffer b, int32_t &value_r) noexcept
+{
+	if (b.empty() || b.size > 4)
+		return false;
+
+	uint32_t value = 0;
+	for (const uint8_t ch : b)
+		value = (value << 8) | ch;
+
+	/* sign extension */
+	const unsigned shift = 32 - 8 * b.size;
+	value_r = int32_t(value << shift) >> shift;
+	return true;
+}
+
+template<std::size_t N>
+const char *
+FindMp4TagName(const Mp4TagName (&names)[N], uint32_t type) noexcept
+{
+	for (const auto &i : names)
+		if (i.type == type)
+			return i.name;
+
+	return nullptr;
+}
+
+constexpr bool
+IsAscii(Buffer b) noexcept
+{
+	for (const uint8_t ch : b)
+		if (ch >= 0x80)
+			return false;
+
+	return true;
+}
+
+/**
+ * The value of a "data" box.
+ */
+struct Mp4Data {
+	/**
+	 * The "well-known type"; 1 is UTF-8 text, 21 is a signed
+	 * big-endian integer.
+	 */
+	uint32_t type;
+
+	Buffer value;
+};
+
+bool
+ParseData(Buffer b, Mp4Data &data) noexcept
+{
+	/* type indicator and locale */
+	if (b.size < 8)
+		return false;
+
+	data.type = ReadBE32(b.data) & 0xffffff;
+	b.skip_front(8);
+	data.value = b;
+	return true;
+}
+
+std::string
+ToString(Buffer b) noexcept
+{
+	return {(const char *)b.data, b.size};
+}
+
+class Mp4Parser {
+	Mp4Info &info;
+
+	uint32_t movie_time_scale = 0;
+
+	bool have_audio = false;
+
+	/**
+	 * State collected while parsing one "trak" box.
+	 */
+	struct Track {
+		bool sound = false;
+
+		uint32_t time_scale = 0;
+		uint64_t duration = 0;
+
+		/**
+		 * The duration of the single edit list entry in
+		 * units of the movie time scale, or 0 if there is no
+		 * such edit list.
+		 */
+		uint64_t edit_duration = 0;
+
+		char codec[4] = {};
+		unsigned channels = 0;
+		uint32_t sample_rate = 0;
+		uint8_t object_type = 0;
+		unsigned audio_object_type = 0;
+	};
+
+public:
+	explicit Mp4Parser(Mp4Info &_info) noexcept
+		:info(_info) {}
+
+	bool ParseMoov(Buffer b) {
+		return ForEachBox(b, [this](uint32_t type, Buffer body){
+			switch (type) {
+			case FourCC("mvhd"):
+				return ParseMvhd(body);
+
+			case FourCC("trak"):
+				return ParseTrak(body);
+
+			case FourCC("udta"):
+				return ParseUdta(body);
+
+			default:
+				return true;
+			}
+		}) && have_audio;
+	}
+
+private:
+	bool ParseMvhd(Buffer b) noexcept {
+		if (b.empty())
+			return false;
+
+		/* skip version, flags, creation and modification
+		   time */
+		const size_t offset = b.front() == 1 ? 20 : 12;
+		if (b.size < offset + 4)
+			return false;
+
+		movie_time_scale = ReadBE32(b.data + offset);
+		return true;
+	}
+
+	bool ParseTrak(Buffer b) {
+		Track track;
+		if (!ForEachBox(b, [this, &track](uint32_t type, Buffer body){
+			switch (type) {
+			case FourCC("edts"):
+				return ParseEdts(body, track);
+
+			case FourCC("mdia"):
+				return ParseMdia(body, track);
+
+			default:
+				return true;
+			}
+		}))
+			return false;
+
+		if (!track.sound || have_audio)
+			return true;
+
+		have_audio = true;
+
+		info.time_scale = track.time_scale;
+		info.duration = track.duration;
+		if (track.edit_duration > 0 && movie_time_scale > 0)
+			info.duration = ScaleDuration(track.edit_duration,
+						      movie_time_scale,
+						      track.time_scale);
+
+		std::copy_n(track.codec, sizeof(track.codec), info.codec);
+		info.channels = track.channels;
+		info.sample_rate = track.sample_rate;
+		info.object_type = track.object_type;
+		info.audio_object_type = track.audio_object_type;
+		return true;
+	}
+
+	static bool ParseEdts(Buffer b, Track &track) noexcept {
+		return ForEachBox(b, [&track](uint32_t type, Buffer body){
+			if (type != FourCC("elst") || body.size < 8)
+				return true;
+
+			const bool v1 = body.front() == 1;
+			const uint32_t n = ReadBE32(body.data + 4);
+			body.skip_front(8);
+
+			/* only the simple case of one edit list entry
+			   (i.e. encoder delay) is supported */
+			if (n != 1 || body.size < (v1 ? 20 : 12))
+				return true;
+
+			track.edit_duration = v1
+				? ReadBE64(body.data)
+				: ReadBE32(body.data);
+			return true;
+		});
+	}
+
+	static bool ParseMdia(Buffer b, Track &track) noexcept {
+		return ForEachBox(b, [&track](uint32_t type, Buffer body){
+			switch (type) {
+			case FourCC("mdhd"):
+				return ParseMdhd(body, track);
+
+			case FourCC("hdlr"):
+				/* version, flags and pre_defined */
+				if (body.size < 12)
+					return false;
+
+				track.sound = ReadBE32(body.data + 8) ==
+					FourCC("soun");
+				return true;
+
+			case FourCC("minf"):
+				return ForEachBox(body, [&track](uint32_t t, Buffer b2){
+					return t != FourCC("stbl") ||
+						ParseStbl(b2, track);
+				});
+
+			default:
+				return true;
+			}
+		});
+	}
+
+	static bool ParseMdhd(Buffer b, Track &track) noexcept {
+		if (b.empty())
+			return false;
+
+		if (b.front() == 1) {
+			if (b.size < 32)
+				return false;
+
+			track.time_scale = ReadBE32(b.data + 20);
+			track.duration = ReadBE64(b.data + 24);
+		} else {
+			if (b.size < 20)
+				return false;
+
+			track.time_scale = ReadBE32(b.data + 12);
+			track.duration = ReadBE32(b.data + 16);
+		}
+
+		return true;
+	}
+
+	static bool ParseStbl(Buffer b, Track &track) noexcept {
+		return ForEachBox(b, [&track](uint32_t type, Buffer body){
+			if (type != FourCC("stsd"))
+				return true;
+
+			/* version, flags and entry count */
+			if (body.size < 8)
+				return false;
+
+			body.skip_front(8);
+
+			/* only the first sample entry is used */
+			bool first = true;
+			return ForEachBox(body, [&track, &first](uint32_t t, Buffer entry){
+				if (!first)
+					return true;
+
+				first = false;
+				return ParseAudioSampleEntry(t, entry, track);
+			});
+		});
+	}
+
+	static bool ParseAudioSampleEntry(uint32_t type, Buffer b,
+					  Track &track) noexcept {
+		if (b.size < 28)
+			return false;
+
+		track.codec[0] = char(type >> 24);
+		track.codec[1] = char(type >> 16);
+		track.codec[2] = char(type >> 8);
+		track.codec[3] = char(type);
+
+		const unsigned version = ReadBE16(b.data + 8);
+		track.channels = ReadBE16(b.data + 16);
+		track.sample_rate = ReadBE32(b.data + 24) >> 16;
+
+		size_t children = 28;
+		if (version == 1)
+			/* QuickTime sound description version 1 */
+			children += 16;
+		else if (version != 0)
+			return true;
+
+		if (b.size < children)
+			return false;
+
+		b.skip_front(children);
+		return ForEachBox(b, [&track](uint32_t t, Buffer body){
+			return t != FourCC("esds") || ParseEsds(body, track);
+		});
+	}
+
+	static bool ParseEsds(Buffer b, Track &track) noexcept {
+		Buffer es;
+		if (!SkipFullBoxHeader(b) || !FindDescriptor(b, 0x03, es) ||
+		    es.size < 3)
+			return false;
+
+		/* ES_ID */
+		es.skip_front(2);
+
+		const uint8_t flags = es.front();
+		es.skip_front(1);
+
+		size_t skip = 0;
+		if (flags & 0x80)
+			/* dependsOn_ES_ID */
+			skip += 2;
+		if (flags & 0x40) {
+			/* URL */
+			if (es.empty())
+				return false;
+			skip += 1 + es.front();
+		}
+		if (flags & 0x20)
+			/* OCR_ES_Id */
+			skip += 2;
+
+		if (es.size < skip)
+			return false;
+		es.skip_front(skip);
+
+		Buffer config;
+		if (!FindDescriptor(es, 0x04, config) || config.size < 13)
+			return false;
+
+		track.object_type = config.front();
+		config.skip_front(13);
+
+		Buffer specific;
+		if (!FindDescriptor(config, 0x05, specific) ||
+		    specific.empty())
+			/* no AudioSpecificConfig */
+			return true;
+
+		track.audio_object_type = specific.data[0] >> 3;
+		if (track.audio_object_type == 31 && specific.size >= 2)
+			track.audio_object_type = 32 +
+				(((specific.data[0] & 0x7) << 3) |
+				 (specific.data[1] >> 5));
+
+		return true;
+	}
+
+	bool ParseUdta(Buffer b) {
+		return ForEachBox(b, [this](uint32_t type, Buffer body){
+			if (type == FourCC("meta"))
+				return ParseMeta(body);
+
+			if ((type >> 24) == 0xa9)
+				/* QuickTime-style text item; these are
+				   left to libavformat */
+				info.complete = false;
+
+			return true;
+		});
+	}
+
+	bool ParseMeta(Buffer b) {
+		/* in MP4, "meta" is a full box; in QuickTime, it is
+		   not */
+		if (b.size >= 4 && ReadBE32(b.data) == 0)
+			b.skip_front(4);
+
+		return ForEachBox(b, [this](uint32_t type, Buffer body){
+			return type != FourCC("ilst") || ParseIlst(body);
+		});
+	}
+
+	bool ParseIlst(Buffer b) {
+		return ForEachBox(b, [this](uint32_t type, Buffer body){
+			ParseIlstItem(type, body);
+			return true;
+		});
+	}
+
+	void ParseIlstItem(uint32_t type, Buffer b) {
+		Buffer name = nullptr;
+		Mp4Data data;
+		bool have_data = false;
+
+		if (!ForEachBox(b, [&](uint32_t t, Buffer body){
+			switch (t) {
+			case FourCC("name"):
+				name = body;
+				return SkipFullBoxHeader(name);
+
+			case FourCC("data"):
+				/* only the first value is used */
+				if (!have_data)
+					have_data = ParseData(body, data);
+				return true;
+
+			default:
+				return true;
+			}
+		}) || !have_data) {
+			info.complete = false;
+			return;
+		}
+
+		switch (type) {
+		case FourCC("covr"):
+			/* pictures are not scanned from the
+			   libavformat metadata either */
+			break;
+
+		case FourCC("trkn"):
+			AddNumberPair("track", data);
+			break;
+
+		case FourCC("disk"):
+			AddNumberPair("disc", data);
+			break;
+
+		case FourCC("----"):
+			/* freeform item, e.g. "MusicBrainz Track
+			   Id" */
+			if (!name.empty() && data.type == 1)
+				info.tags.emplace_back(ToString(name),
+						       ToString(data.value));
+			else
+				info.complete = false;
+			break;
+
+		default:
+			if (const char *key = FindMp4TagName(mp4_tag_names,
+							     type))
+				AddText(key, data);
+			else if (const char *key8 = FindMp4TagName(mp4_int8_tag_names,
+								   type);
+				 key8 != nullptr && !data.value.empty())
+				info.tags.emplace_back(key8,
+						       std::to_string(data.value.front()));
+			else
+				/* e.g. "gnre" (an ID3v1 genre
+				   index) */
+				info.complete = false;
+			break;
+		}
+	}
+
+	/**
+	 * Add a text item, converting its value like libavformat
+	 * does.
+	 */
+	void AddText(const char *key, const Mp4Data &data) {
+		const Buffer v = data.value;
+
+		switch (data.type) {
+		case 0:
+		case 3:
+			/* libavformat converts these from Mac Roman,
+			   which is only the identity for ASCII */
+			if (!IsAscii(v))
+				break;
+
+			[[fallthrough]];
+
+		case 1:
+			info.tags.emplace_back(key, ToString(v));
+			return;
+
+		case 21:
+			if (int32_t i; ReadSignedBE(v, i)) {
+				info.tags.emplace_back(key,
+						       std::to_string(i));
+				return;
+			}
+
+			break;
+		}
+
+		info.complete = false;
+	}
+
+	void AddNumberPair(const char *key, const Mp4Data &data) {
+		/* like libavformat, accept the short variant
+		   without the total */
+		if (data.value.size < 4) {
+			info.complete = false;
+			return;
+		}
+
+		const unsigned current = ReadBE16(data.value.data + 2);
+		const unsigned total = data.value.size >= 6
+			? ReadBE16(data.value.data + 4)
+			: 0;
+
+		std::string value = std::to_string(current);
+		if (total > 0) {
+			value.push_back('/');
+			value += std::to_string(total);
+		}
+
+		info.tags.emplace_back(key, std::move(value));
+	}
+};
+
+} // anonymous namespace
+
+bool
+ScanMp4Header(InputStream &is, Mp4Info &info)
+{
+	std::unique_lock<Mutex> lock(is.mutex);
+
+	bool first = true;
+	while (true) {
+		uint8_t header[16];
+		is.ReadFull(lock, header, 8);
+
+		uint64_t size = ReadBE32(header);
+		const uint32_t type = ReadBE32(header + 4);
+		size_t header_size = 8;
+
+		if (first && type != FourCC("ftyp"))
+			return false;
+
+		first = false;
+
+		if (size == 1) {
+			is.ReadFull(lock, header + 8, 8);
+			size = ReadBE64(header + 8);
+			header_size = 16;
+		} else if (size == 0) {
+			/* the box extends to the end of the file */
+			if (!is.KnownSize())
+				return false;
+
+			size = header_size + is.GetRest();
+		}
+
+		if (size < header_size)
+			return false;
+
+		const uint64_t body_size = size - header_size;
+
+		if (type == FourCC("moov")) {
+			if (body_size > MAX_MOOV_SIZE)
+				return false;
+
+			std::vector<uint8_t> moov(body_size);
+			is.ReadFull(lock, moov.data(), moov.size());
+			lock.unlock();
+
+			return Mp4Parser(info).ParseMoov({moov.data(),
+							  moov.size()});
+		}
+
+		if (is.KnownSize() && body_size > is.GetRest())
+			return false;
+
+		if (!is.CheapSeeking() && body_size > 65536)
+			/* don't read the whole "mdat" box just to
+			   find "moov" after it */
+			return false;
+
+		is.Skip(lock, body_size);
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_MP4_SCAN_HXX
+#define MPD_MP4_SCAN_HXX
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+class InputStream;
+
+/**
+ * Information about an MP4 file obtained by parsing only its "moov"
+ * box.
+ */
+struct Mp4Info {
+	/**
+	 * The time scale of the first audio track ("mdhd").
+	 */
+	uint32_t time_scale = 0;
+
+	/**
+	 * The duration of the first audio track in units of
+	 * #time_scale, with a simple edit list applied.
+	 */
+	uint64_t duration = 0;
+
+	/**
+	 * The type of the first audio sample entry, e.g. "mp4a".
+	 */
+	char codec[4] = {};
+
+	unsigned channels = 0;
+	uint32_t sample_rate = 0;
+
+	/**
+	 * The "objectTypeIndication" from the "esds" box; 0x40 is
+	 * MPEG-4 audio.
+	 */
+	uint8_t object_type = 0;
+
+	/**
+	 * The MPEG-4 "audioObjectType" from the AudioSpecificConfig;
+	 * 2 is AAC LC.
+	 */
+	unsigned audio_object_type = 0;
+
+	/**
+	 * The iTunes-style metadata items ("ilst") with the key names
+	 * used by libavformat.
+	 */
+	std::vector<std::pair<std::string, std::string>> tags;
+
+	/**
+	 * Have all metadata items been converted exactly like
+	 * libavformat does?  If not (e.g. "gnre" or an unknown
+	 * item), the caller should let libavformat parse the file,
+	 * or else tags would be lost.
+	 */
+	bool complete = true;
+};
+
+/**
+ * Parse the "moov" box of an MP4/M4A file, skipping everything else
+ * ("mdat").  This reads the box headers and the whole "moov" box,
+ * i.e. usually two or three I/O operations.
+ *
+ * Throws on I/O error.
+ *
+ * @return false if this is not an MP4 file, if it has no audio track
+ * or if it could not be parsed
+ */
+bool
+ScanMp4Header(InputStream &is, Mp4Info &info);
+
+#endif
@@ -19,12 +19,14 @@
 
 #include "Mpg123DecoderPlugin.hxx"
 #include "../DecoderAPI.hxx"
+#include "../SeekIndex.hxx"
 #include "pcm/CheckAudioFormat.hxx"
 #include "tag/Handler.hxx"
 #include "tag/Builder.hxx"
 #include "tag/ReplayGain.hxx"
 #include "tag/MixRamp.hxx"
 #include "fs/Path.hxx"
+#include "fs/FileInfo.hxx"
 #include "util/Domain.hxx"
 #include "util/ScopeExit.hxx"
 #include "util/StringView.hxx"
@@ -32,6 +34,8 @@
 
 #include <mpg123.h>
 
+#include <vector>
+
 #include <stdio.h>
 
 static constexpr Domain mpg123_domain("mpg123");
@@ -179,6 +183,74 @@ mpd_mpg123_meta(DecoderClient &client, mpg123_handle *const handle)
 		mpd_mpg123_id3v2(client, *v2);
 }
 
+/**
+ * Load a persistent seek index into libmpg123's frame index.
+ *
+ * @return the number of index entries which were loaded
+ */
+static size_t
+mpd_mpg123_load_index(DecoderClient &client, mpg123_handle *handle,
+		      unsigned sample_rate, uint64_t size) noexcept
+{
+	const auto index = client.LoadSeekIndex("mpg123", size);
+	if (index == nullptr || index->size() < 2 ||
+	    index->sample_rate != sample_rate)
+		return 0;
+
+	/* libmpg123 requires a constant number of MPEG frames
+	   between two index entries */
+	const int spf = mpg123_spf(handle);
+	const uint64_t step_samples = index->points[1].frame -
+		index->points[0].frame;
+	if (spf <= 0 || index->points[0].frame != 0 ||
+	    step_samples % spf != 0)
+		return 0;
+
+	std::vector<off_t> offsets;
+	offsets.reserve(index->size());
+	for (size_t i = 0; i < index->size(); ++i) {
+		const auto &point = index->points[i];
+		if (point.frame != i * step_samples)
+			return 0;
+
+		offsets.push_back(point.offset);
+	}
+
+	if (mpg123_set_index(handle, offsets.data(), step_samples / spf,
+			     offsets.size()) != MPG123_OK)
+		return 0;
+
+	return offsets.size();
+}
+
+/**
+ * Save libmpg123's frame index as a persistent seek index, if it has
+ * grown since mpd_mpg123_load_index().
+ */
+static void
+mpd_mpg123_store_index(DecoderClient &client, mpg123_handle *handle,
+		       unsigned sample_rate, uint64_t size,
+		       size_t loaded) noexcept
+{
+	off_t *offsets;
+	off_t step;
+	size_t fill;
+	const int spf = mpg123_spf(handle);
+	if (spf <= 0 ||
+	    mpg123_index(handle, &offsets, &step, &fill) != MPG123_OK ||
+	    fill <= loaded || step <= 0)
+		return;
+
+	SeekIndex index(sample_rate);
+	index.points.reserve(fill);
+	for (size_t i = 0; i < fill; ++i)
+		if (!index.Add(uint64_t(i) * step * spf, offsets[i]))
+			/* must be contiguous */
+			return;
+
+	client.StoreSeekIndex("mpg123", size, index);
+}
+
 static void
 mpd_mpg123_file_decode(DecoderClient &client, Path path_fs)
 {
@@ -199,6 +271,17 @@ mpd_mpg123_file_decode(DecoderClient &client, Path path_fs)
 	if (!mpd_mpg123_open(handle, path_fs.c_str(), audio_format))
 		return;
 
+	/* the file size is part of the seek index cache key */
+	FileInfo file_info;
+	const uint64_t file_size = GetFileInfo(path_fs, file_info)
+		? file_info.GetSize()
+		: 0;
+
+	const size_t loaded_index = file_size > 0
+		? mpd_mpg123_load_index(client, handle,
+					audio_format.sample_rate, file_size)
+		: 0;
+
 	const off_t num_samples = mpg123_length(handle);
 
 	/* tell MPD core we're ready */
@@ -269,6 +352,11 @@ mpd_mpg123_file_decode(DecoderClient &client, Path path_fs)
 			cmd = DecoderCommand::NONE;
 		}
 	} while (cmd == DecoderCommand::NONE);
+
+	if (file_size > 0)
+		mpd_mpg123_store_index(client, handle,
+				       audio_format.sample_rate, file_size,
+				       loaded_index);
 }
 
 static bool
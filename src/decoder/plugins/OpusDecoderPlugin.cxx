@@ -24,6 +24,7 @@
 #include "OpusTags.hxx"
 #include "lib/xiph/OggPacket.hxx"
 #include "lib/xiph/OggFind.hxx"
+#include "lib/xiph/OggHeaderReader.hxx"
 #include "../DecoderAPI.hxx"
 #include "decoder/Reader.hxx"
 #include "input/Reader.hxx"
@@ -37,6 +38,8 @@
 #include <opus.h>
 #include <ogg/ogg.h>
 
+#include <vector>
+
 #include <string.h>
 
 namespace {
@@ -423,9 +426,73 @@ VisitOpusDuration(InputStream &is, OggSyncState &sync, OggStreamState &stream,
 	}
 }
 
+/**
+ * "OpusTags" packets larger than this are left to libogg.
+ */
+constexpr size_t opus_max_tags_packet = 4 * 1024 * 1024;
+
+/**
+ * Read the "OpusHead" and "OpusTags" packets without libogg.
+ *
+ * Throws on I/O error.
+ *
+ * @return false if the packets could not be read; the caller shall
+ * fall back to libogg
+ */
+bool
+ReadOpusHeaderPackets(OggHeaderReader &reader,
+		      unsigned &channels, unsigned &pre_skip,
+		      std::vector<uint8_t> &tags)
+{
+	std::vector<uint8_t> head;
+
+	return reader.ReadPacket(head, 256) &&
+		head.size() >= 8 && memcmp(head.data(), "OpusHead", 8) == 0 &&
+		ScanOpusHeader(head.data(), head.size(), channels, pre_skip) &&
+		audio_valid_channel_count(channels) &&
+		reader.ReadPacket(tags, opus_max_tags_packet) &&
+		tags.size() >= 8 && memcmp(tags.data(), "OpusTags", 8) == 0;
+}
+
 static bool
 mpd_opus_scan_stream(InputStream &is, TagHandler &handler)
 {
+	OggHeaderReader header_reader(is);
+	unsigned channels, pre_skip;
+	std::vector<uint8_t> tags;
+
+	bool fast = false;
+	if (is.CheapSeeking()) {
+		try {
+			fast = ReadOpusHeaderPackets(header_reader, channels,
+						     pre_skip, tags);
+		} catch (...) {
+		}
+
+		if (!fast)
+			is.LockRewind();
+	}
+
+	if (fast) {
+		if (!ScanOpusTags(tags.data(), tags.size(), nullptr, handler))
+			return false;
+
+		handler.OnAudioFormat(AudioFormat(opus_sample_rate,
+						  SampleFormat::S16, channels));
+
+		uint64_t granule;
+		try {
+			if (OggFindEOSGranule(is, header_reader.GetSerial(),
+					      granule) &&
+			    granule >= pre_skip)
+				handler.OnDuration(SongTime::FromScale<uint64_t>(granule,
+										 opus_sample_rate));
+		} catch (...) {
+		}
+
+		return true;
+	}
+
 	InputStreamReader reader(is);
 	OggSyncState oy(reader);
 
@@ -435,7 +502,6 @@ mpd_opus_scan_stream(InputStream &is, TagHandler &handler)
 
 	OggStreamState os(first_page);
 
-	unsigned channels, pre_skip;
 	if (!ReadAndParseOpusHead(oy, os, channels, pre_skip) ||
 	    !ReadAndVisitOpusTags(oy, os, handler))
 		return false;
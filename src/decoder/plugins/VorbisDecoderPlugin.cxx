@@ -22,6 +22,8 @@
 #include "lib/xiph/VorbisComments.hxx"
 #include "lib/xiph/OggPacket.hxx"
 #include "lib/xiph/OggFind.hxx"
+#include "lib/xiph/OggHeaderReader.hxx"
+#include "lib/xiph/VorbisCommentBlock.hxx"
 #include "VorbisDomain.hxx"
 #include "../DecoderAPI.hxx"
 #include "decoder/Features.h"
@@ -30,7 +32,9 @@
 #include "OggCodec.hxx"
 #include "pcm/CheckAudioFormat.hxx"
 #include "pcm/Interleave.hxx"
+#include "util/ByteOrder.hxx"
 #include "util/ScopeExit.hxx"
+#include "util/StringView.hxx"
 #include "tag/Handler.hxx"
 #include "Log.hxx"
 
@@ -42,6 +46,9 @@
 
 #include <iterator>
 #include <stdexcept>
+#include <vector>
+
+#include <string.h>
 
 class VorbisDecoder final : public OggDecoder {
 #ifdef HAVE_TREMOR
@@ -82,8 +89,13 @@ public:
 
 	bool Seek(uint64_t where_frame);
 
+	static AudioFormat CheckAudioFormat(unsigned long rate,
+					    unsigned channels) {
+		return ::CheckAudioFormat(rate, sample_format, channels);
+	}
+
 	static AudioFormat CheckAudioFormat(const vorbis_info &vi) {
-		return ::CheckAudioFormat(vi.rate, sample_format, vi.channels);
+		return CheckAudioFormat(vi.rate, vi.channels);
 	}
 
 	[[nodiscard]] AudioFormat CheckAudioFormat() const {
@@ -369,9 +381,85 @@ VisitVorbisDuration(InputStream &is,
 	handler.OnDuration(duration);
 }
 
+/**
+ * Comment headers larger than this are left to libvorbis.
+ */
+static constexpr size_t VORBIS_MAX_COMMENT_HEADER = 4 * 1024 * 1024;
+
+/**
+ * Parse the Vorbis identification and comment headers without libogg
+ * and libvorbis.  The #TagHandler is only invoked after both headers
+ * have been read and validated.
+ *
+ * Throws on I/O error.
+ *
+ * @return false if the headers could not be parsed; the caller
+ * shall fall back to libvorbis
+ */
+static bool
+vorbis_scan_header(InputStream &is, TagHandler &handler)
+{
+	OggHeaderReader reader(is);
+
+	std::vector<uint8_t> ident;
+	if (!reader.ReadPacket(ident, 64) || ident.size() < 30 ||
+	    memcmp(ident.data(), "\1vorbis", 7) != 0)
+		return false;
+
+	uint32_t version, rate;
+	memcpy(&version, &ident[7], sizeof(version));
+	memcpy(&rate, &ident[12], sizeof(rate));
+	version = FromLE32(version);
+	rate = FromLE32(rate);
+	const unsigned channels = ident[11];
+	if (version != 0 || rate == 0 || channels == 0)
+		return false;
+
+	std::vector<uint8_t> comment;
+	std::vector<StringView> comments;
+	if (!reader.ReadPacket(comment, VORBIS_MAX_COMMENT_HEADER) ||
+	    comment.size() < 7 ||
+	    memcmp(comment.data(), "\3vorbis", 7) != 0 ||
+	    !SplitVorbisCommentBlock({comment.data() + 7, comment.size() - 7},
+				     comments))
+		return false;
+
+	for (const auto &i : comments)
+		VorbisCommentScan(i, handler);
+
+	/* check the song duration by locating the e_o_s page */
+
+	uint64_t granule;
+	try {
+		if (OggFindEOSGranule(is, reader.GetSerial(), granule))
+			handler.OnDuration(SongTime::FromScale<uint64_t>(granule,
+									 rate));
+	} catch (...) {
+	}
+
+	try {
+		handler.OnAudioFormat(VorbisDecoder::CheckAudioFormat(rate,
+								      channels));
+	} catch (...) {
+	}
+
+	return true;
+}
+
 static bool
 vorbis_scan_stream(InputStream &is, TagHandler &handler)
 {
+	if (is.CheapSeeking()) {
+		try {
+			if (vorbis_scan_header(is, handler))
+				return true;
+		} catch (...) {
+			/* fall back to libvorbis */
+		}
+
+		is.LockRewind();
+	}
+
 	/* initialize libogg */
 
 	InputStreamReader reader(is);
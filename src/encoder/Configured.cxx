@@ -20,6 +20,8 @@
 #include "Configured.hxx"
 #include "EncoderList.hxx"
 #include "EncoderPlugin.hxx"
+#include "EncoderInterface.hxx"
+#include "ThreadedEncoder.hxx"
 #include "config/Block.hxx"
 #include "util/StringAPI.hxx"
 #include "util/RuntimeError.hxx"
@@ -51,6 +53,13 @@ GetConfiguredEncoderPlugin(const ConfigBlock &block, bool shout_legacy)
 PreparedEncoder *
 CreateConfiguredEncoder(const ConfigBlock &block, bool shout_legacy)
 {
-	return encoder_init(GetConfiguredEncoderPlugin(block, shout_legacy),
-			    block);
+	std::unique_ptr<PreparedEncoder> encoder(encoder_init(GetConfiguredEncoderPlugin(block, shout_legacy),
+							      block));
+
+	if (block.GetBlockValue("encoder_thread", false))
+		return MakeThreadedEncoder(std::move(encoder),
+					   block.GetPositiveValue("encoder_queue",
+								  256u * 1024));
+
+	return encoder.release();
 }
@@ -25,6 +25,8 @@
 
 #include <cassert>
 #include <cstddef>
+#include <map>
+#include <string>
 
 struct AudioFormat;
 struct Tag;
@@ -137,6 +139,16 @@ public:
 	virtual const char *GetMimeType() const noexcept {
 		return nullptr;
 	}
+
+	/**
+	 * Returns a map of runtime attributes (e.g. statistics) which
+	 * the audio output shall report.
+	 *
+	 * This method must be thread-safe.
+	 */
+	virtual std::map<std::string, std::string> GetAttributes() const noexcept {
+		return {};
+	}
 };
 
 #endif
@@ -0,0 +1,457 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "ThreadedEncoder.hxx"
+#include "EncoderInterface.hxx"
+#include "tag/Tag.hxx"
+#include "thread/Thread.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "thread/Name.hxx"
+#include "util/DynamicFifoBuffer.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * Statistics shared between #ThreadedPreparedEncoder and the
+ * #ThreadedEncoder it has created.
+ */
+struct ThreadedEncoderStats {
+	/**
+	 * The CPU time consumed by the encoder thread since the
+	 * encoder was opened.
+	 */
+	std::atomic<uint64_t> cpu_ns{0};
+
+	/**
+	 * The number of PCM bytes waiting to be encoded.
+	 */
+	std::atomic<size_t> queued{0};
+
+	/**
+	 * When was the encoder opened?  Zero if it is not open.
+	 */
+	std::atomic<std::chrono::steady_clock::rep> open_time{0};
+};
+
+/**
+ * The CPU time consumed by the current thread.
+ */
+static uint64_t
+GetThreadCpuNS() noexcept
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+		return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+
+	return 0;
+}
+
+class ThreadedEncoder final : public Encoder {
+	struct Job {
+		enum class Type : uint8_t {
+			WRITE,
+			FLUSH,
+			PRE_TAG,
+			TAG,
+			END,
+		} type;
+
+		std::vector<uint8_t> data;
+
+		std::unique_ptr<Tag> tag;
+
+		explicit Job(Type _type) noexcept:type(_type) {}
+	};
+
+	const std::unique_ptr<Encoder> encoder;
+
+	ThreadedEncoderStats &stats;
+
+	const size_t max_queued;
+
+	Mutex mutex;
+
+	/**
+	 * Wakes up the encoder thread after #queue has been modified
+	 * or #quit has been set.
+	 */
+	Cond cond;
+
+	/**
+	 * Signalled by the encoder thread after a job has been
+	 * finished.
+	 */
+	Cond client_cond;
+
+	Thread thread;
+
+	std::deque<Job> queue;
+
+	/**
+	 * The number of PCM bytes in #queue.
+	 */
+	size_t queued = 0;
+
+	/**
+	 * Encoded data ready to be returned by Read().
+	 */
+	DynamicFifoBuffer<uint8_t> output{16384};
+
+	/**
+	 * An error which occurred in the encoder thread; it will be
+	 * rethrown by the next method call.  After that, all
+	 * remaining jobs are discarded.
+	 */
+	std::exception_ptr error;
+
+	/**
+	 * Is the encoder thread currently running a job (with
+	 * #mutex unlocked)?
+	 */
+	bool busy = false;
+
+	bool failed = false;
+
+	bool quit = false;
+
+public:
+	/**
+	 * Throws on error.
+	 */
+	ThreadedEncoder(std::unique_ptr<Encoder> _encoder,
+			ThreadedEncoderStats &_stats,
+			size_t _max_queued)
+		:Encoder(_encoder->ImplementsTag()),
+		 encoder(std::move(_encoder)), stats(_stats),
+		 max_queued(_max_queued),
+		 thread(BIND_THIS_METHOD(Run))
+	{
+		/* the file header is available right after opening
+		   the encoder */
+		ReadAll(output);
+
+		thread.Start();
+	}
+
+	~ThreadedEncoder() noexcept override {
+		{
+			const std::lock_guard<Mutex> lock(mutex);
+			queue.clear();
+			quit = true;
+			cond.notify_one();
+		}
+
+		thread.Join();
+
+		stats.queued = 0;
+		stats.open_time = 0;
+	}
+
+	/* virtual methods from class Encoder */
+	void End() override {
+		Sync(Job::Type::END);
+	}
+
+	void Flush() override {
+		Sync(Job::Type::FLUSH);
+	}
+
+	void PreTag() override {
+		Sync(Job::Type::PRE_TAG);
+	}
+
+	void SendTag(const Tag &tag) override;
+	void Write(const void *data, size_t length) override;
+	size_t Read(void *dest, size_t length) override;
+
+private:
+	/**
+	 * Caller must lock the mutex.
+	 */
+	void CheckError() {
+		if (error)
+			std::rethrow_exception(std::exchange(error, nullptr));
+	}
+
+	/**
+	 * Caller must lock the mutex.
+	 */
+	void Push(Job &&job) noexcept {
+		queue.emplace_back(std::move(job));
+		cond.notify_one();
+	}
+
+	/**
+	 * Submit a job and wait until it (and all jobs before it)
+	 * have been finished.
+	 */
+	void Sync(Job::Type type);
+
+	/**
+	 * Move all data from the encoder to the given buffer.
+	 */
+	void ReadAll(DynamicFifoBuffer<uint8_t> &dest);
+
+	/**
+	 * Runs in the encoder thread.  Throws on error.
+	 */
+	void RunJob(Job &job);
+
+	void Run() noexcept;
+};
+
+void
+ThreadedEncoder::SendTag(const Tag &tag)
+{
+	const std::lock_guard<Mutex> lock(mutex);
+	CheckError();
+
+	Job job(Job::Type::TAG);
+	job.tag = std::make_unique<Tag>(tag);
+	Push(std::move(job));
+}
+
+void
+ThreadedEncoder::Write(const void *data, size_t length)
+{
+	std::unique_lock<Mutex> lock(mutex);
+
+	/* wait until there is room in the queue; this is where the
+	   output thread gets throttled if the encoder is too
+	   slow */
+	client_cond.wait(lock, [this]{
+		return queued < max_queued || error;
+	});
+
+	CheckError();
+
+	Job job(Job::Type::WRITE);
+	const auto *p = (const uint8_t *)data;
+	job.data.assign(p, p + length);
+	queued += length;
+	stats.queued = queued;
+	Push(std::move(job));
+}
+
+size_t
+ThreadedEncoder::Read(void *dest, size_t length)
+{
+	const std::lock_guard<Mutex> lock(mutex);
+
+	auto r = output.Read();
+	if (r.size > length)
+		r.size = length;
+
+	std::copy_n(r.data, r.size, (uint8_t *)dest);
+	output.Consume(r.size);
+	return r.size;
+}
+
+void
+ThreadedEncoder::Sync(Job::Type type)
+{
+	std::unique_lock<Mutex> lock(mutex);
+	CheckError();
+
+	Push(Job(type));
+
+	client_cond.wait(lock, [this]{
+		return (queue.empty() && !busy) || error;
+	});
+
+	CheckError();
+}
+
+void
+ThreadedEncoder::ReadAll(DynamicFifoBuffer<uint8_t> &dest)
+{
+	while (true) {
+		auto w = dest.Write(8192);
+		size_t nbytes = encoder->Read(w, 8192);
+		if (nbytes == 0)
+			break;
+
+		dest.Append(nbytes);
+	}
+}
+
+inline void
+ThreadedEncoder::RunJob(Job &job)
+{
+	switch (job.type) {
+	case Job::Type::WRITE:
+		encoder->Write(job.data.data(), job.data.size());
+		break;
+
+	case Job::Type::FLUSH:
+		encoder->Flush();
+		break;
+
+	case Job::Type::PRE_TAG:
+		encoder->PreTag();
+		break;
+
+	case Job::Type::TAG:
+		encoder->SendTag(*job.tag);
+		break;
+
+	case Job::Type::END:
+		encoder->End();
+		break;
+	}
+}
+
+void
+ThreadedEncoder::Run() noexcept
+{
+	SetThreadName("encoder");
+
+	DynamicFifoBuffer<uint8_t> encoded(16384);
+
+	std::unique_lock<Mutex> lock(mutex);
+
+	while (true) {
+		if (queue.empty()) {
+			if (quit)
+				break;
+
+			cond.wait(lock);
+			continue;
+		}
+
+		Job job = std::move(queue.front());
+		queue.pop_front();
+
+		std::exception_ptr new_error;
+
+		if (!failed) {
+			busy = true;
+
+			const ScopeUnlock unlock(mutex);
+
+			const auto cpu_start = GetThreadCpuNS();
+
+			try {
+				RunJob(job);
+				ReadAll(encoded);
+			} catch (...) {
+				new_error = std::current_exception();
+			}
+
+			stats.cpu_ns += GetThreadCpuNS() - cpu_start;
+		}
+
+		busy = false;
+
+		queued -= job.data.size();
+		stats.queued = queued;
+
+		for (auto r = encoded.Read(); !r.empty(); r = encoded.Read()) {
+			output.Append(r.data, r.size);
+			encoded.Consume(r.size);
+		}
+
+		if (new_error) {
+			failed = true;
+			error = std::move(new_error);
+		}
+
+		client_cond.notify_one();
+	}
+}
+
+class ThreadedPreparedEncoder final : public PreparedEncoder {
+	const std::unique_ptr<PreparedEncoder> encoder;
+
+	const size_t max_queued;
+
+	ThreadedEncoderStats stats;
+
+public:
+	ThreadedPreparedEncoder(std::unique_ptr<PreparedEncoder> _encoder,
+				size_t _max_queued) noexcept
+		:encoder(std::move(_encoder)), max_queued(_max_queued) {}
+
+	/* virtual methods from class PreparedEncoder */
+	Encoder *Open(AudioFormat &audio_format) override {
+		std::unique_ptr<Encoder> e(encoder->Open(audio_format));
+
+		stats.cpu_ns = 0;
+		stats.queued = 0;
+		stats.open_time = std::chrono::steady_clock::now()
+			.time_since_epoch().count();
+
+		return new ThreadedEncoder(std::move(e), stats, max_queued);
+	}
+
+	const char *GetMimeType() const noexcept override {
+		return encoder->GetMimeType();
+	}
+
+	std::map<std::string, std::string> GetAttributes() const noexcept override;
+};
+
+std::map<std::string, std::string>
+ThreadedPreparedEncoder::GetAttributes() const noexcept
+{
+	auto result = encoder->GetAttributes();
+
+	const std::chrono::steady_clock::duration open_time(stats.open_time);
+	if (open_time.count() == 0)
+		return result;
+
+	const std::chrono::duration<double> wall =
+		std::chrono::steady_clock::now().time_since_epoch() - open_time;
+	const double cpu = stats.cpu_ns / 1e9;
+
+	char buffer[64];
+
+	snprintf(buffer, sizeof(buffer), "%.1f",
+		 wall.count() > 0 ? 100. * cpu / wall.count() : 0.);
+	result.emplace("encoder_cpu_usage", buffer);
+
+	snprintf(buffer, sizeof(buffer), "%.3f", cpu);
+	result.emplace("encoder_cpu_time", buffer);
+
+	result.emplace("encoder_queue", std::to_string(stats.queued.load()));
+
+	return result;
+}
+
+PreparedEncoder *
+MakeThreadedEncoder(std::unique_ptr<PreparedEncoder> inner,
+		    size_t max_queued)
+{
+	return new ThreadedPreparedEncoder(std::move(inner), max_queued);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_ENCODER_THREADED_HXX
+#define MPD_ENCODER_THREADED_HXX
+
+#include <cstddef>
+#include <memory>
+
+class PreparedEncoder;
+
+/**
+ * Wrap a #PreparedEncoder: the #Encoder instances it creates run the
+ * actual encoder in a separate thread.  PCM data passed to
+ * Encoder::Write() is queued (up to the given number of bytes), and
+ * Encoder::Read() returns whatever has been encoded so far, which
+ * pipelines encoding with the output thread.
+ *
+ * The returned object reports CPU usage and queue depth with
+ * PreparedEncoder::GetAttributes().
+ */
+PreparedEncoder *
+MakeThreadedEncoder(std::unique_ptr<PreparedEncoder> inner,
+		    size_t max_queued);
+
+#endif
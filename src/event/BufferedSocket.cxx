@@ -21,7 +21,132 @@
 #include "net/SocketError.hxx"
 #include "util/Compiler.h"
 
+#ifdef HAVE_URING
+#include "Loop.hxx"
+#include "SocketBufferPool.hxx"
+#endif
+
 #include <stdexcept>
+#include <utility>
+
+#include <string.h>
+
+BufferedSocket::~BufferedSocket() noexcept
+{
+#ifdef HAVE_URING
+	if (uring_receive != nullptr)
+		uring_receive->Orphan();
+#endif
+}
+
+void
+BufferedSocket::Close() noexcept
+{
+#ifdef HAVE_URING
+	/* this must be done before the socket is closed, because a
+	   pending operation is aborted by shutting down the socket */
+	if (uring_receive != nullptr)
+		std::exchange(uring_receive, nullptr)->Orphan();
+#endif
+
+	SocketMonitor::Close();
+}
+
+#ifdef HAVE_URING
+
+bool
+BufferedSocket::EnableUring() noexcept
+{
+	assert(IsDefined());
+	assert(uring_receive == nullptr);
+
+	auto *queue = GetEventLoop().GetUring();
+	if (queue == nullptr)
+		return false;
+
+	const bool reading = GetScheduledFlags() & READ;
+	CancelRead();
+
+	uring_receive = new UringSocketOperation(*queue, buffer_pool,
+						 *this, GetSocket());
+	if (reading)
+		ScheduleInput();
+	else
+		uring_input_paused = true;
+	return true;
+}
+
+void
+BufferedSocket::OnUringReceive(void *segment, int res) noexcept
+{
+	assert(uring_receive != nullptr);
+
+	if (res <= 0) {
+		if (res == 0 || IsSocketErrorClosed(-res))
+			OnSocketClosed();
+		else
+			OnSocketError(std::make_exception_ptr(MakeSocketError(-res, "Failed to receive from socket")));
+		return;
+	}
+
+	if (!input.Adopt(segment, res)) {
+		const auto w = input.Write();
+		assert(w.size >= size_t(res));
+		memcpy(w.data, segment, res);
+		input.Append(res);
+		buffer_pool.Free(segment);
+	}
+
+	if (!uring_input_paused)
+		ResumeInput();
+}
+
+#endif
+
+bool
+BufferedSocket::ScheduleInput() noexcept
+{
+#ifdef HAVE_URING
+	if (uring_receive != nullptr) {
+		uring_input_paused = false;
+
+		if (uring_receive->IsPending())
+			return true;
+
+		switch (uring_receive->StartReceive(input.GetSpace())) {
+		case UringSocketOperation::StartResult::OK:
+			return true;
+
+		case UringSocketOperation::StartResult::NO_BUFFER:
+			OnSocketError(std::make_exception_ptr(std::runtime_error("Out of buffer memory")));
+			return false;
+
+		case UringSocketOperation::StartResult::QUEUE_FULL:
+			/* fall back to epoll for this socket */
+			delete std::exchange(uring_receive, nullptr);
+			break;
+		}
+	}
+#endif
+
+	ScheduleRead();
+	return true;
+}
+
+void
+BufferedSocket::PauseInput() noexcept
+{
+#ifdef HAVE_URING
+	if (uring_receive != nullptr) {
+		/* a pending "recv" will still be completed, but its
+		   data stays in the input buffer */
+		uring_input_paused = true;
+		return;
+	}
+#endif
+
+	CancelRead();
+}
 
 BufferedSocket::ssize_t
 BufferedSocket::DirectRead(void *data, size_t length) noexcept
@@ -52,7 +177,10 @@ BufferedSocket::ReadToBuffer() noexcept
 	assert(IsDefined());
 
 	const auto buffer = input.Write();
-	assert(!buffer.empty());
+	if (buffer.empty()) {
+		OnSocketError(std::make_exception_ptr(std::runtime_error("Out of buffer memory")));
+		return false;
+	}
 
 	const auto nbytes = DirectRead(buffer.data, buffer.size);
 	if (nbytes > 0)
@@ -69,23 +197,25 @@ BufferedSocket::ResumeInput() noexcept
 	while (true) {
 		const auto buffer = input.Read();
 		if (buffer.empty()) {
-			ScheduleRead();
-			return true;
+			input.FreeIfEmpty();
+			return ScheduleInput();
 		}
 
 		const auto result = OnSocketInput(buffer.data, buffer.size);
 		switch (result) {
 		case InputResult::MORE:
+			input.FreeIfEmpty();
+
 			if (input.IsFull()) {
 				OnSocketError(std::make_exception_ptr(std::runtime_error("Input buffer is full")));
 				return false;
 			}
 
-			ScheduleRead();
-			return true;
+			return ScheduleInput();
 
 		case InputResult::PAUSE:
-			CancelRead();
+			input.FreeIfEmpty();
+			PauseInput();
 			return true;
 
 		case InputResult::AGAIN:
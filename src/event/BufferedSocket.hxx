@@ -21,7 +21,12 @@
 #define MPD_BUFFERED_SOCKET_HXX
 
 #include "SocketMonitor.hxx"
-#include "util/StaticFifoBuffer.hxx"
+#include "PooledInputBuffer.hxx"
+#include "io/uring/Features.h"
+
+#ifdef HAVE_URING
+#include "UringSocketOperation.hxx"
+#endif
 
 #include <cassert>
 #include <cstdint>
@@ -30,20 +35,65 @@
 class EventLoop;
 
 /**
- * A #SocketMonitor specialization that adds an input buffer.
+ * A #SocketMonitor specialization that adds an input buffer.  The
+ * buffer memory is borrowed from a #SocketBufferPool only while
+ * there is pending input.
  */
-class BufferedSocket : protected SocketMonitor {
-	StaticFifoBuffer<uint8_t, 8192> input;
+class BufferedSocket : protected SocketMonitor
+#ifdef HAVE_URING
+		     , protected UringSocketHandler
+#endif
+{
+	SocketBufferPool &buffer_pool;
+
+	PooledInputBuffer input;
+
+#ifdef HAVE_URING
+	/**
+	 * If set, then data is received with io_uring instead of
+	 * waiting for readiness with epoll.
+	 */
+	UringSocketOperation *uring_receive = nullptr;
+
+	/**
+	 * Has OnSocketInput() returned InputResult::PAUSE?  Only
+	 * used if #uring_receive is set.
+	 */
+	bool uring_input_paused = false;
+#endif
 
 public:
-	BufferedSocket(SocketDescriptor _fd, EventLoop &_loop) noexcept
-		:SocketMonitor(_fd, _loop) {
+	/**
+	 * @param _buffer_pool the pool which provides the buffer
+	 * memory
+	 */
+	BufferedSocket(SocketDescriptor _fd, EventLoop &_loop,
+		       SocketBufferPool &_buffer_pool=socket_buffer_pool) noexcept
+		:SocketMonitor(_fd, _loop),
+		 buffer_pool(_buffer_pool), input(_buffer_pool) {
 		ScheduleRead();
 	}
 
+	~BufferedSocket() noexcept;
+
 	using SocketMonitor::GetEventLoop;
 	using SocketMonitor::IsDefined;
-	using SocketMonitor::Close;
+
+	void Close() noexcept;
+
+#ifdef HAVE_URING
+	/**
+	 * Receive data with io_uring instead of epoll.  Call this
+	 * right after construction.
+	 *
+	 * @return false if io_uring is not available
+	 */
+	bool EnableUring() noexcept;
+
+	bool IsUring() const noexcept {
+		return uring_receive != nullptr;
+	}
+#endif
 
 private:
 	/**
@@ -60,7 +110,23 @@ private:
 	 */
 	bool ReadToBuffer() noexcept;
 
+	/**
+	 * Wait for more data from the socket.
+	 *
+	 * @return false if the socket has been closed
+	 */
+	bool ScheduleInput() noexcept;
+
+	/**
+	 * Stop receiving data until ResumeInput() is called.
+	 */
+	void PauseInput() noexcept;
+
 protected:
+	SocketBufferPool &GetBufferPool() const noexcept {
+		return buffer_pool;
+	}
+
 	/**
 	 * @return false if the socket has been closed
 	 */
@@ -118,6 +184,15 @@ protected:
 
 	/* virtual methods from class SocketMonitor */
 	bool OnSocketReady(unsigned flags) noexcept override;
+
+#ifdef HAVE_URING
+	/* virtual methods from class UringSocketHandler */
+	void OnUringReceive(void *segment, int res) noexcept final;
+
+	void OnUringSend(int) noexcept override {
+		/* only used by FullyBufferedSocket */
+	}
+#endif
 };
 
 #endif
@@ -21,10 +21,144 @@
 #include "net/SocketError.hxx"
 #include "util/Compiler.h"
 
+#ifdef HAVE_URING
+#include "Loop.hxx"
+#endif
+
 #include <cassert>
+#include <cerrno>
+#include <stdexcept>
+#include <utility>
 
 #include <string.h>
 
+FullyBufferedSocket::~FullyBufferedSocket() noexcept
+{
+#ifdef HAVE_URING
+	if (uring_send != nullptr)
+		uring_send->Orphan();
+#endif
+}
+
+void
+FullyBufferedSocket::Close() noexcept
+{
+	IdleMonitor::Cancel();
+
+#ifdef HAVE_URING
+	if (uring_send != nullptr)
+		std::exchange(uring_send, nullptr)->Orphan();
+#endif
+
+	BufferedSocket::Close();
+}
+
+#ifdef HAVE_URING
+
+bool
+FullyBufferedSocket::EnableUring() noexcept
+{
+	assert(uring_send == nullptr);
+
+	if (!BufferedSocket::EnableUring())
+		return false;
+
+	/* BufferedSocket::EnableUring() has already initialized the
+	   io_uring, this cannot fail */
+	auto *queue = GetEventLoop().GetUring();
+	assert(queue != nullptr);
+
+	uring_send = new UringSocketOperation(*queue, GetBufferPool(),
+					      *this, GetSocket());
+	CancelWrite();
+	return true;
+}
+
+bool
+FullyBufferedSocket::StartUringSend() noexcept
+{
+	assert(uring_send != nullptr);
+
+	if (uring_send->IsPending())
+		return true;
+
+	if (uring_send->HasRemainder()) {
+		/* a partial send could not be resubmitted; send the
+		   rest directly before anything else */
+		const int res = uring_send->SendRemainder();
+		if (res == -EAGAIN) {
+			ScheduleWrite();
+			return true;
+		}
+
+		if (res < 0) {
+			OnUringSendError(res);
+			return false;
+		}
+
+		CancelWrite();
+	}
+
+	const auto data = output.Read();
+	if (data.empty())
+		return true;
+
+	switch (uring_send->StartSend(data.data, data.size)) {
+	case UringSocketOperation::StartResult::OK:
+		output.Consume(uring_send->GetSendSize());
+		return true;
+
+	case UringSocketOperation::StartResult::NO_BUFFER:
+		OnSocketError(std::make_exception_ptr(std::runtime_error("Out of buffer memory")));
+		return false;
+
+	case UringSocketOperation::StartResult::QUEUE_FULL:
+		break;
+	}
+
+	/* fall back to epoll for this socket */
+	delete std::exchange(uring_send, nullptr);
+
+	if (!Flush())
+		return false;
+
+	if (!output.empty())
+		ScheduleWrite();
+	return true;
+}
+
+void
+FullyBufferedSocket::OnUringSendError(int res) noexcept
+{
+	assert(res < 0);
+
+	if (IsSocketErrorClosed(-res))
+		OnSocketClosed();
+	else
+		OnSocketError(std::make_exception_ptr(MakeSocketError(-res, "Failed to send to socket")));
+}
+
+void
+FullyBufferedSocket::OnUringSend(int res) noexcept
+{
+	if (res == -EAGAIN) {
+		/* back-pressure: the rest of a partial send is
+		   still in the operation; wait until the socket
+		   becomes writable (see StartUringSend()) */
+		ScheduleWrite();
+		return;
+	}
+
+	if (res < 0) {
+		OnUringSendError(res);
+		return;
+	}
+
+	StartUringSend();
+}
+
+#endif
+
 FullyBufferedSocket::ssize_t
 FullyBufferedSocket::DirectWrite(const void *data, size_t length) noexcept
 {
@@ -51,6 +185,13 @@ FullyBufferedSocket::Flush() noexcept
 {
 	assert(IsDefined());
 
+#ifdef HAVE_URING
+	if (uring_send != nullptr) {
+		IdleMonitor::Cancel();
+		return StartUringSend();
+	}
+#endif
+
 	const auto data = output.Read();
 	if (data.empty()) {
 		IdleMonitor::Cancel();
@@ -92,12 +233,40 @@ FullyBufferedSocket::Write(const void *data, size_t length) noexcept
 	return true;
 }
 
+void
+FullyBufferedSocket::CommitWrite(size_t length) noexcept
+{
+	assert(IsDefined());
+
+	if (length == 0) {
+		/* let the buffer free the segment which may have
+		   been allocated by PrepareWrite() */
+		output.Append(0);
+		return;
+	}
+
+	const bool was_empty = output.empty();
+
+	output.Append(length);
+
+	if (was_empty)
+		IdleMonitor::Schedule();
+}
+
 bool
 FullyBufferedSocket::OnSocketReady(unsigned flags) noexcept
 {
 	if (flags & WRITE) {
+#ifdef HAVE_URING
+		/* with io_uring, WRITE is only scheduled for the
+		   rest of a partial send (which is not in the output
+		   buffer) */
+		assert(uring_send != nullptr || !output.empty());
+		assert(uring_send != nullptr || !IdleMonitor::IsActive());
+#else
 		assert(!output.empty());
 		assert(!IdleMonitor::IsActive());
+#endif
 
 		if (!Flush())
 			return false;
@@ -109,6 +278,13 @@ FullyBufferedSocket::OnSocketReady(unsigned flags) noexcept
 void
 FullyBufferedSocket::OnIdle() noexcept
 {
+#ifdef HAVE_URING
+	if (uring_send != nullptr) {
+		StartUringSend();
+		return;
+	}
+#endif
+
 	if (Flush() && !output.empty())
 		ScheduleWrite();
 }
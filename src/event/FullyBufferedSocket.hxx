@@ -22,28 +22,53 @@
 
 #include "BufferedSocket.hxx"
 #include "IdleMonitor.hxx"
-#include "util/PeakBuffer.hxx"
+#include "PooledOutputBuffer.hxx"
+#include "util/WritableBuffer.hxx"
 
 /**
  * A #BufferedSocket specialization that adds an output buffer.
  */
 class FullyBufferedSocket : protected BufferedSocket, private IdleMonitor {
-	PeakBuffer output;
+	PooledOutputBuffer output;
+
+#ifdef HAVE_URING
+	/**
+	 * If set, then data is sent with io_uring instead of waiting
+	 * for readiness with epoll.
+	 */
+	UringSocketOperation *uring_send = nullptr;
+#endif
 
 public:
+	/**
+	 * @param max_output the maximum number of bytes in the
+	 * output buffer
+	 * @param _buffer_pool the pool which provides the buffer
+	 * memory
+	 */
 	FullyBufferedSocket(SocketDescriptor _fd, EventLoop &_loop,
-			    size_t normal_size, size_t peak_size=0) noexcept
-		:BufferedSocket(_fd, _loop), IdleMonitor(_loop),
-		 output(normal_size, peak_size) {
+			    size_t max_output,
+			    SocketBufferPool &_buffer_pool=socket_buffer_pool) noexcept
+		:BufferedSocket(_fd, _loop, _buffer_pool), IdleMonitor(_loop),
+		 output(_buffer_pool, max_output) {
 	}
 
+	~FullyBufferedSocket() noexcept;
+
 	using BufferedSocket::GetEventLoop;
 	using BufferedSocket::IsDefined;
 
-	void Close() noexcept {
-		IdleMonitor::Cancel();
-		BufferedSocket::Close();
-	}
+	void Close() noexcept;
+
+#ifdef HAVE_URING
+	/**
+	 * Send and receive data with io_uring instead of epoll.  Call
+	 * this right after construction.
+	 *
+	 * @return false if io_uring is not available
+	 */
+	bool EnableUring() noexcept;
+#endif
 
 private:
 	/**
@@ -53,6 +78,18 @@ private:
 	 */
 	ssize_t DirectWrite(const void *data, size_t length) noexcept;
 
+#ifdef HAVE_URING
+	/**
+	 * Submit the head of the output buffer to io_uring, unless
+	 * a "send" is already pending.
+	 *
+	 * @return false if the socket has been closed
+	 */
+	bool StartUringSend() noexcept;
+
+	void OnUringSendError(int res) noexcept;
+#endif
+
 protected:
 	/**
 	 * Send data from the output buffer to the socket.
@@ -66,10 +103,39 @@ protected:
 	 */
 	bool Write(const void *data, size_t length) noexcept;
 
+	/**
+	 * Obtain a writable area at the tail of the output buffer,
+	 * allowing the caller to format data in-place.  May return an
+	 * empty buffer, and the caller shall then fall back to
+	 * Write().
+	 */
+	WritableBuffer<void> PrepareWrite() noexcept {
+		return output.Write();
+	}
+
+	/**
+	 * Commit data which was written into the area returned by
+	 * PrepareWrite().
+	 */
+	void CommitWrite(size_t length) noexcept;
+
+	/**
+	 * @return the number of bytes in the output buffer which
+	 * have not yet been sent
+	 */
+	size_t GetOutputSize() const noexcept {
+		return output.GetSize();
+	}
+
 	/* virtual methods from class SocketMonitor */
 	bool OnSocketReady(unsigned flags) noexcept override;
 
 	void OnIdle() noexcept override;
+
+#ifdef HAVE_URING
+	/* virtual methods from class UringSocketHandler */
+	void OnUringSend(int res) noexcept override;
+#endif
 };
 
 #endif
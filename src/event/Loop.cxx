@@ -47,6 +47,7 @@ EventLoop::~EventLoop() noexcept
 {
 	assert(idle.empty());
 	assert(timers.empty());
+	assert(coarse_timers.IsEmpty());
 }
 
 #ifdef HAVE_URING
@@ -55,6 +56,7 @@ Uring::Queue *
 EventLoop::GetUring() noexcept
 {
 	if (!uring_initialized) {
+		uring_initialized = true;
 		try {
 			uring = std::make_unique<Uring::Manager>(*this);
 		} catch (...) {
@@ -130,10 +132,36 @@ EventLoop::CancelTimer(TimerEvent &t) noexcept
 	timers.erase(timers.iterator_to(t));
 }
 
+void
+EventLoop::AddCoarseTimer(CoarseTimerEvent &t,
+			  std::chrono::steady_clock::duration d) noexcept
+{
+	assert(IsInside());
+
+	t.due = now + d;
+	coarse_timers.Insert(t);
+	again = true;
+}
+
+/**
+ * Return the earlier of two timeouts, where a negative value means
+ * "no timeout".
+ */
+static constexpr std::chrono::steady_clock::duration
+GetEarliestTimeout(std::chrono::steady_clock::duration a,
+		   std::chrono::steady_clock::duration b) noexcept
+{
+	return a < a.zero()
+		? b
+		: (b < b.zero() || a < b ? a : b);
+}
+
 inline std::chrono::steady_clock::duration
 EventLoop::HandleTimers() noexcept
 {
-	std::chrono::steady_clock::duration timeout;
+	const auto coarse_timeout = coarse_timers.Run(now);
+
+	std::chrono::steady_clock::duration timeout(-1);
 
 	while (!quit) {
 		auto i = timers.begin();
@@ -143,14 +171,16 @@ EventLoop::HandleTimers() noexcept
 		TimerEvent &t = *i;
 		timeout = t.due - now;
 		if (timeout > timeout.zero())
-			return timeout;
+			break;
+
+		timeout = std::chrono::steady_clock::duration(-1);
 
 		timers.erase(i);
 
 		t.Run();
 	}
 
-	return std::chrono::steady_clock::duration(-1);
+	return GetEarliestTimeout(timeout, coarse_timeout);
 }
 
 /**
@@ -192,6 +222,9 @@ EventLoop::Run() noexcept
 		SocketMonitor::Cancel();
 	};
 
+	stats.start = std::chrono::steady_clock::now();
+	auto busy_since = stats.start;
+
 	do {
 		now = std::chrono::steady_clock::now();
 		again = false;
@@ -229,9 +262,18 @@ EventLoop::Run() noexcept
 
 		/* wait for new event */
 
+		{
+			const auto busy_duration =
+				std::chrono::steady_clock::now() - busy_since;
+			stats.busy_time += busy_duration;
+			if (busy_duration > stats.longest_busy)
+				stats.longest_busy = busy_duration;
+		}
+
 		poll_group.ReadEvents(poll_result, ExportTimeoutMS(timeout));
 
-		now = std::chrono::steady_clock::now();
+		now = busy_since = std::chrono::steady_clock::now();
+		++stats.wakeups;
 
 		{
 			const std::lock_guard<Mutex> lock(mutex);
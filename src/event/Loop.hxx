@@ -28,6 +28,7 @@
 #include "WakeFD.hxx"
 #include "SocketMonitor.hxx"
 #include "TimerEvent.hxx"
+#include "TimerWheel.hxx"
 #include "IdleMonitor.hxx"
 #include "DeferEvent.hxx"
 
@@ -37,6 +38,7 @@
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 
 #include "io/uring/Features.h"
 #ifdef HAVE_URING
@@ -51,7 +53,8 @@ namespace Uring { class Queue; class Manager; }
  * thread that runs it, except where explicitly documented as
  * thread-safe.
  *
- * @see SocketMonitor, MultiSocketMonitor, TimerEvent, IdleMonitor
+ * @see SocketMonitor, MultiSocketMonitor, TimerEvent,
+ * CoarseTimerEvent, IdleMonitor
  */
 class EventLoop final : SocketMonitor
 {
@@ -72,6 +75,8 @@ class EventLoop final : SocketMonitor
 					   boost::intrusive::constant_time_size<false>> TimerSet;
 	TimerSet timers;
 
+	TimerWheel coarse_timers;
+
 	typedef boost::intrusive::list<IdleMonitor,
 				       boost::intrusive::member_hook<IdleMonitor,
 								     IdleMonitor::ListHook,
@@ -130,6 +135,40 @@ class EventLoop final : SocketMonitor
 	 */
 	ThreadId thread = ThreadId::Null();
 
+public:
+	/**
+	 * Counters which help finding latency spikes.  They are only
+	 * updated inside Run(), and may only be read from within the
+	 * #EventLoop's thread.
+	 */
+	struct Stats {
+		/**
+		 * When did Run() start?
+		 */
+		std::chrono::steady_clock::time_point start;
+
+		/**
+		 * How often has the #EventLoop woken up from
+		 * PollGroup::ReadEvents()?
+		 */
+		uint64_t wakeups = 0;
+
+		/**
+		 * The total time spent in handlers, i.e. not
+		 * waiting for events.
+		 */
+		std::chrono::steady_clock::duration busy_time{};
+
+		/**
+		 * The longest time spent in handlers between two
+		 * ReadEvents() calls.
+		 */
+		std::chrono::steady_clock::duration longest_busy{};
+	};
+
+private:
+	Stats stats;
+
 public:
 	/**
 	 * Throws on error.
@@ -189,6 +228,15 @@ public:
 		      std::chrono::steady_clock::duration d) noexcept;
 	void CancelTimer(TimerEvent &t) noexcept;
 
+	void AddCoarseTimer(CoarseTimerEvent &t,
+			    std::chrono::steady_clock::duration d) noexcept;
+
+	const Stats &GetStats() const noexcept {
+		assert(IsInside());
+
+		return stats;
+	}
+
 	/**
 	 * Schedule a call to DeferEvent::RunDeferred().
 	 *
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_POOLED_INPUT_BUFFER_HXX
+#define MPD_POOLED_INPUT_BUFFER_HXX
+
+#include "SocketBufferPool.hxx"
+#include "util/ForeignFifoBuffer.hxx"
+
+#include <cstdint>
+
+/**
+ * A FIFO buffer for socket input which borrows its memory from a
+ * #SocketBufferPool only while it contains data.  Its interface
+ * resembles #StaticFifoBuffer.
+ */
+class PooledInputBuffer {
+	SocketBufferPool &pool;
+
+	ForeignFifoBuffer<uint8_t> buffer{nullptr};
+
+public:
+	using Range = ForeignFifoBuffer<uint8_t>::Range;
+
+	explicit PooledInputBuffer(SocketBufferPool &_pool) noexcept
+		:pool(_pool) {}
+
+	~PooledInputBuffer() noexcept {
+		if (buffer.IsDefined())
+			pool.Free(buffer.GetBuffer());
+	}
+
+	PooledInputBuffer(const PooledInputBuffer &) = delete;
+	PooledInputBuffer &operator=(const PooledInputBuffer &) = delete;
+
+	bool empty() const noexcept {
+		return buffer.empty();
+	}
+
+	bool IsFull() const noexcept {
+		return buffer.IsDefined() && buffer.IsFull();
+	}
+
+	/**
+	 * Returns the number of bytes which can be written (after
+	 * borrowing a segment if necessary).
+	 */
+	std::size_t GetSpace() const noexcept {
+		return buffer.IsNull()
+			? SocketBufferPool::SEGMENT_SIZE
+			: buffer.GetCapacity() - buffer.GetAvailable();
+	}
+
+	/**
+	 * Take over a segment from #pool which contains
+	 * #length bytes of data, instead of copying it.  This is
+	 * only possible if this buffer is empty.
+	 *
+	 * @return true on success, false if the caller keeps
+	 * ownership of the segment
+	 */
+	bool Adopt(void *segment, std::size_t length) noexcept {
+		if (!buffer.empty())
+			return false;
+
+		FreeIfEmpty();
+		buffer.SetBuffer((uint8_t *)segment,
+				 SocketBufferPool::SEGMENT_SIZE);
+		buffer.Append(length);
+		return true;
+	}
+
+	/**
+	 * Prepare writing.  Borrows a segment from the pool if
+	 * necessary.  Returns an empty range if the pool is
+	 * exhausted.
+	 */
+	Range Write() noexcept {
+		if (buffer.IsNull()) {
+			void *segment = pool.Allocate();
+			if (segment == nullptr)
+				return nullptr;
+
+			buffer.SetBuffer((uint8_t *)segment,
+					 SocketBufferPool::SEGMENT_SIZE);
+		}
+
+		return buffer.Write();
+	}
+
+	void Append(std::size_t n) noexcept {
+		buffer.Append(n);
+	}
+
+	Range Read() const noexcept {
+		return buffer.Read();
+	}
+
+	/**
+	 * Mark data as consumed.  This does not return the memory to
+	 * the pool, so pointers obtained by Read() remain valid; call
+	 * FreeIfEmpty() when they are no longer used.
+	 */
+	void Consume(std::size_t n) noexcept {
+		buffer.Consume(n);
+	}
+
+	/**
+	 * Return the memory to the pool if the buffer is empty.
+	 */
+	void FreeIfEmpty() noexcept {
+		if (buffer.IsDefined() && buffer.empty()) {
+			pool.Free(buffer.GetBuffer());
+			buffer.SetNull();
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "PooledOutputBuffer.hxx"
+#include "SocketBufferPool.hxx"
+#include "util/WritableBuffer.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include <string.h>
+
+/**
+ * The header of a segment; the payload follows it in the same
+ * block obtained from #pool.
+ */
+struct PooledOutputBuffer::Segment {
+	Segment *next = nullptr;
+
+	std::size_t start = 0, end = 0;
+
+	static constexpr std::size_t CAPACITY =
+		SocketBufferPool::SEGMENT_SIZE - sizeof(Segment *) - 2 * sizeof(std::size_t);
+
+	uint8_t *GetData() noexcept {
+		return (uint8_t *)(this + 1);
+	}
+
+	WritableBuffer<void> Read() noexcept {
+		return {GetData() + start, end - start};
+	}
+
+	WritableBuffer<void> Write() noexcept {
+		return {GetData() + end, CAPACITY - end};
+	}
+};
+
+PooledOutputBuffer::~PooledOutputBuffer() noexcept
+{
+	while (head != nullptr)
+		FreeHead();
+
+	if (pending != nullptr)
+		FreeSegment(pending);
+}
+
+inline PooledOutputBuffer::Segment *
+PooledOutputBuffer::NewSegment() noexcept
+{
+	static_assert(sizeof(Segment) + Segment::CAPACITY ==
+		      SocketBufferPool::SEGMENT_SIZE);
+
+	void *p = pool.Allocate();
+	if (p == nullptr)
+		return nullptr;
+
+	return new(p) Segment();
+}
+
+inline void
+PooledOutputBuffer::FreeSegment(Segment *s) noexcept
+{
+	s->~Segment();
+	pool.Free(s);
+}
+
+inline void
+PooledOutputBuffer::FreeHead() noexcept
+{
+	assert(head != nullptr);
+
+	Segment *s = head;
+	head = s->next;
+	if (head == nullptr)
+		tail = nullptr;
+
+	FreeSegment(s);
+}
+
+bool
+PooledOutputBuffer::AppendSegment() noexcept
+{
+	Segment *s = pending != nullptr
+		? std::exchange(pending, nullptr)
+		: NewSegment();
+	if (s == nullptr)
+		return false;
+
+	if (tail != nullptr)
+		tail->next = s;
+	else
+		head = s;
+	tail = s;
+	return true;
+}
+
+WritableBuffer<void>
+PooledOutputBuffer::Read() const noexcept
+{
+	if (head == nullptr)
+		return nullptr;
+
+	return head->Read();
+}
+
+void
+PooledOutputBuffer::Consume(std::size_t length) noexcept
+{
+	assert(head != nullptr);
+	assert(length <= head->end - head->start);
+	assert(length <= size);
+
+	head->start += length;
+	size -= length;
+
+	if (head->start == head->end)
+		FreeHead();
+}
+
+bool
+PooledOutputBuffer::Append(const void *data, std::size_t length) noexcept
+{
+	if (length == 0)
+		return true;
+
+	if (size + length > max_size)
+		return false;
+
+	/* reserve all segments first, so nothing gets copied if the
+	   pool is exhausted */
+	std::size_t available = tail != nullptr
+		? Segment::CAPACITY - tail->end
+		: 0;
+	Segment *const old_tail = tail;
+	while (available < length) {
+		if (!AppendSegment()) {
+			/* roll back */
+			Segment *s = old_tail != nullptr
+				? std::exchange(old_tail->next, nullptr)
+				: std::exchange(head, nullptr);
+			tail = old_tail;
+
+			while (s != nullptr) {
+				Segment *next = s->next;
+				FreeSegment(s);
+				s = next;
+			}
+
+			return false;
+		}
+
+		available += Segment::CAPACITY;
+	}
+
+	Segment *s = old_tail != nullptr ? old_tail : head;
+	while (length > 0) {
+		assert(s != nullptr);
+
+		const auto w = s->Write();
+		const std::size_t nbytes = std::min(length, w.size);
+		memcpy(w.data, data, nbytes);
+		s->end += nbytes;
+		size += nbytes;
+
+		data = (const uint8_t *)data + nbytes;
+		length -= nbytes;
+		s = s->next;
+	}
+
+	return true;
+}
+
+WritableBuffer<void>
+PooledOutputBuffer::Write() noexcept
+{
+	if (size >= max_size)
+		return nullptr;
+
+	Segment *s = tail;
+	if (s == nullptr || s->end == Segment::CAPACITY) {
+		/* don't link the new segment yet, see #pending */
+		if (pending == nullptr) {
+			pending = NewSegment();
+			if (pending == nullptr)
+				return nullptr;
+		}
+
+		s = pending;
+	}
+
+	auto w = s->Write();
+	w.size = std::min(w.size, max_size - size);
+	return w;
+}
+
+void
+PooledOutputBuffer::Append(std::size_t length) noexcept
+{
+	if (pending != nullptr) {
+		if (length == 0) {
+			/* nothing was written: give the segment
+			   back to the pool */
+			FreeSegment(std::exchange(pending, nullptr));
+			return;
+		}
+
+		AppendSegment();
+	} else if (length == 0)
+		return;
+
+	assert(tail != nullptr);
+	assert(length <= Segment::CAPACITY - tail->end);
+
+	tail->end += length;
+	size += length;
+}
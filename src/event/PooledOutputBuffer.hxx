@@ -0,0 +1,127 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_POOLED_OUTPUT_BUFFER_HXX
+#define MPD_POOLED_OUTPUT_BUFFER_HXX
+
+#include "util/Compiler.h"
+
+#include <cstddef>
+
+template<typename T> struct WritableBuffer;
+class SocketBufferPool;
+
+/**
+ * A FIFO buffer for socket output consisting of a chain of segments
+ * borrowed from a #SocketBufferPool.  Each segment is returned as
+ * soon as it has been consumed, so an empty buffer occupies no
+ * memory.  Its interface resembles #PeakBuffer.
+ */
+class PooledOutputBuffer {
+	struct Segment;
+
+	SocketBufferPool &pool;
+
+	Segment *head = nullptr, *tail = nullptr;
+
+	/**
+	 * A segment which was allocated by Write() because the tail
+	 * was full.  It is linked into the chain only when data gets
+	 * committed into it, so an aborted or empty write doesn't
+	 * leave an empty segment behind.
+	 */
+	Segment *pending = nullptr;
+
+	/**
+	 * The number of bytes in this buffer.
+	 */
+	std::size_t size = 0;
+
+	/**
+	 * The maximum number of bytes in this buffer.
+	 */
+	const std::size_t max_size;
+
+public:
+	PooledOutputBuffer(SocketBufferPool &_pool,
+			   std::size_t _max_size) noexcept
+		:pool(_pool), max_size(_max_size) {}
+
+	~PooledOutputBuffer() noexcept;
+
+	PooledOutputBuffer(const PooledOutputBuffer &) = delete;
+	PooledOutputBuffer &operator=(const PooledOutputBuffer &) = delete;
+
+	bool empty() const noexcept {
+		return size == 0;
+	}
+
+	std::size_t GetSize() const noexcept {
+		return size;
+	}
+
+	gcc_pure
+	WritableBuffer<void> Read() const noexcept;
+
+	void Consume(std::size_t length) noexcept;
+
+	/**
+	 * Copy data to the end of the buffer.
+	 *
+	 * @return false if the buffer is full or if the pool is
+	 * exhausted (nothing has been copied then)
+	 */
+	bool Append(const void *data, std::size_t length) noexcept;
+
+	/**
+	 * Prepare writing directly into the buffer.  Returns a
+	 * writable area at the tail of the buffer, or an empty buffer
+	 * if the caller should use the copying Append() overload
+	 * instead.  Call Append(size_t) to commit the data.
+	 */
+	WritableBuffer<void> Write() noexcept;
+
+	/**
+	 * Commit data which was written into the area returned by
+	 * Write().  If the length is zero and Write() had to allocate
+	 * a new segment, that segment is freed.
+	 */
+	void Append(std::size_t length) noexcept;
+
+private:
+	/**
+	 * @return nullptr if the pool is exhausted
+	 */
+	Segment *NewSegment() noexcept;
+
+	void FreeSegment(Segment *s) noexcept;
+
+	/**
+	 * Append a new segment to the chain (reusing #pending if
+	 * set).
+	 *
+	 * @return false if the pool is exhausted
+	 */
+	bool AppendSegment() noexcept;
+
+	void FreeHead() noexcept;
+};
+
+#endif
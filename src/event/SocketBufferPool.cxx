@@ -0,0 +1,106 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "SocketBufferPool.hxx"
+
+#include <cassert>
+#include <new>
+
+SocketBufferPool socket_buffer_pool;
+
+SocketBufferPool::~SocketBufferPool() noexcept
+{
+	while (free_list != nullptr) {
+		auto *segment = free_list;
+		free_list = segment->next;
+		operator delete(segment);
+	}
+}
+
+void
+SocketBufferPool::SetLimit(std::size_t max_bytes) noexcept
+{
+	const std::lock_guard<Mutex> lock(mutex);
+	max_segments = (max_bytes + SEGMENT_SIZE - 1) / SEGMENT_SIZE;
+}
+
+void *
+SocketBufferPool::Allocate() noexcept
+{
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+
+		if (max_segments > 0 && n_allocated >= max_segments)
+			return nullptr;
+
+		++n_allocated;
+		if (n_allocated > n_peak)
+			n_peak = n_allocated;
+
+		if (free_list != nullptr) {
+			auto *segment = free_list;
+			free_list = segment->next;
+			--n_cached;
+			return segment;
+		}
+	}
+
+	/* allocate outside of the lock */
+	void *segment = operator new(SEGMENT_SIZE, std::nothrow);
+	if (segment == nullptr) {
+		const std::lock_guard<Mutex> lock(mutex);
+		--n_allocated;
+	}
+
+	return segment;
+}
+
+void
+SocketBufferPool::Free(void *_segment) noexcept
+{
+	assert(_segment != nullptr);
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		assert(n_allocated > 0);
+		--n_allocated;
+
+		if (n_cached < MAX_CACHED) {
+			auto *segment = ::new(_segment) FreeSegment{free_list};
+			free_list = segment;
+			++n_cached;
+			return;
+		}
+	}
+
+	operator delete(_segment);
+}
+
+SocketBufferPool::Stats
+SocketBufferPool::GetStats() const noexcept
+{
+	const std::lock_guard<Mutex> lock(mutex);
+	return {
+		n_allocated * SEGMENT_SIZE,
+		n_cached * SEGMENT_SIZE,
+		n_peak * SEGMENT_SIZE,
+		max_segments * SEGMENT_SIZE,
+	};
+}
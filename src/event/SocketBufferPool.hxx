@@ -0,0 +1,125 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_SOCKET_BUFFER_POOL_HXX
+#define MPD_SOCKET_BUFFER_POOL_HXX
+
+#include "thread/Mutex.hxx"
+#include "util/Compiler.h"
+
+#include <cstddef>
+
+/**
+ * A pool of fixed-size memory segments for socket input and output
+ * buffers.  Sockets borrow segments when they have data to buffer
+ * and return them as soon as the data has been consumed, so idle
+ * connections don't occupy any buffer memory.  A small number of
+ * returned segments is kept for reuse; the rest is freed.
+ *
+ * The total amount of memory handed out can be limited with
+ * SetLimit(); Allocate() fails when the limit has been reached.
+ *
+ * This class is thread-safe.
+ */
+class SocketBufferPool {
+public:
+	static constexpr std::size_t SEGMENT_SIZE = 8192;
+
+	struct Stats {
+		/**
+		 * The number of bytes currently handed out.
+		 */
+		std::size_t allocated;
+
+		/**
+		 * The number of bytes kept for reuse.
+		 */
+		std::size_t cached;
+
+		/**
+		 * The highest value of #allocated so far.
+		 */
+		std::size_t peak;
+
+		/**
+		 * The configured limit; 0 means no limit.
+		 */
+		std::size_t limit;
+	};
+
+private:
+	/**
+	 * The number of free segments to keep for reuse.
+	 */
+	static constexpr std::size_t MAX_CACHED = 64;
+
+	struct FreeSegment {
+		FreeSegment *next;
+	};
+
+	mutable Mutex mutex;
+
+	FreeSegment *free_list = nullptr;
+
+	std::size_t n_cached = 0, n_allocated = 0, n_peak = 0;
+
+	/**
+	 * The maximum number of segments to hand out; 0 means no
+	 * limit.
+	 */
+	std::size_t max_segments = 0;
+
+public:
+	constexpr SocketBufferPool() noexcept = default;
+	~SocketBufferPool() noexcept;
+
+	SocketBufferPool(const SocketBufferPool &) = delete;
+	SocketBufferPool &operator=(const SocketBufferPool &) = delete;
+
+	/**
+	 * Set the maximum number of bytes to hand out.  0 means no
+	 * limit.
+	 */
+	void SetLimit(std::size_t max_bytes) noexcept;
+
+	/**
+	 * Borrow a segment of #SEGMENT_SIZE bytes.
+	 *
+	 * @return the segment or nullptr if the limit has been
+	 * reached or if memory allocation has failed
+	 */
+	void *Allocate() noexcept;
+
+	/**
+	 * Return a segment obtained by Allocate().
+	 */
+	void Free(void *segment) noexcept;
+
+	gcc_pure
+	Stats GetStats() const noexcept;
+};
+
+/**
+ * The default pool used by #BufferedSocket and #FullyBufferedSocket.
+ * It has no limit.
+ */
+extern SocketBufferPool socket_buffer_pool;
+
+#endif
@@ -0,0 +1,553 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "ThreadedBufferedSocket.hxx"
+#include "FullyBufferedSocket.hxx"
+#include "Call.hxx"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <string.h>
+
+class ThreadedBufferedSocket::Inner final : public FullyBufferedSocket {
+	ThreadedBufferedSocket &parent;
+
+	/**
+	 * Does this object live in a separate I/O thread?  Only
+	 * then, the size of the output buffer needs to be published
+	 * to the #parent.
+	 */
+	const bool threaded;
+
+	/**
+	 * Wakes up the I/O thread to transfer output or to resume
+	 * input.
+	 */
+	DeferEvent defer_io;
+
+public:
+	Inner(ThreadedBufferedSocket &_parent, bool _threaded,
+	      SocketDescriptor _fd, EventLoop &_loop,
+	      size_t max_output, SocketBufferPool &_buffer_pool) noexcept
+		:FullyBufferedSocket(_fd, _loop, max_output, _buffer_pool),
+		 parent(_parent), threaded(_threaded),
+		 defer_io(_loop, BIND_THIS_METHOD(OnDeferred)) {}
+
+	using FullyBufferedSocket::IsDefined;
+	using FullyBufferedSocket::Close;
+	using FullyBufferedSocket::ResumeInput;
+	using FullyBufferedSocket::ConsumeInput;
+	using FullyBufferedSocket::Flush;
+	using FullyBufferedSocket::Write;
+	using FullyBufferedSocket::PrepareWrite;
+	using FullyBufferedSocket::CommitWrite;
+	using FullyBufferedSocket::GetOutputSize;
+#ifdef HAVE_URING
+	using FullyBufferedSocket::EnableUring;
+#endif
+
+	void ScheduleDeferred() noexcept {
+		defer_io.Schedule();
+	}
+
+	void CancelDeferred() noexcept {
+		defer_io.Cancel();
+	}
+
+private:
+	void OnDeferred() noexcept {
+		parent.OnInnerDeferred();
+	}
+
+	/* virtual methods from class FullyBufferedSocket which may
+	   send data from the output buffer */
+	bool OnSocketReady(unsigned flags) noexcept override {
+		const bool result = FullyBufferedSocket::OnSocketReady(flags);
+		if (threaded)
+			parent.OnInnerOutputConsumed();
+		return result;
+	}
+
+	void OnIdle() noexcept override {
+		FullyBufferedSocket::OnIdle();
+		if (threaded)
+			parent.OnInnerOutputConsumed();
+	}
+
+#ifdef HAVE_URING
+	void OnUringSend(int res) noexcept override {
+		FullyBufferedSocket::OnUringSend(res);
+		if (threaded)
+			parent.OnInnerOutputConsumed();
+	}
+#endif
+
+	/* virtual methods from class BufferedSocket */
+	InputResult OnSocketInput(void *data, size_t length) noexcept override {
+		switch (parent.OnInnerInput(data, length)) {
+		case ThreadedBufferedSocket::InputResult::MORE:
+			break;
+
+		case ThreadedBufferedSocket::InputResult::PAUSE:
+			return InputResult::PAUSE;
+
+		case ThreadedBufferedSocket::InputResult::AGAIN:
+			return InputResult::AGAIN;
+
+		case ThreadedBufferedSocket::InputResult::CLOSED:
+			return InputResult::CLOSED;
+		}
+
+		return InputResult::MORE;
+	}
+
+	void OnSocketError(std::exception_ptr ep) noexcept override {
+		parent.OnInnerError(std::move(ep));
+	}
+
+	void OnSocketClosed() noexcept override {
+		parent.OnInnerClosed();
+	}
+};
+
+ThreadedBufferedSocket::ThreadedBufferedSocket(SocketDescriptor fd,
+					       EventLoop &_owner_loop,
+					       EventLoop *_io_loop,
+					       size_t _max_output,
+					       SocketBufferPool &buffer_pool) noexcept
+	:owner_loop(_owner_loop), io_loop(_io_loop), max_output(_max_output),
+	 defer_input(owner_loop, BIND_THIS_METHOD(OnDeferredInput)),
+	 input(buffer_pool),
+	 shared_input(buffer_pool), shared_output(buffer_pool, max_output)
+{
+	if (io_loop == nullptr) {
+		inner = std::make_unique<Inner>(*this, false, fd, owner_loop,
+						max_output, buffer_pool);
+		return;
+	}
+
+	/* the socket must be registered inside the I/O thread */
+	BlockingCall(*io_loop, [this, fd, &buffer_pool](){
+		inner = std::make_unique<Inner>(*this, true, fd, *io_loop,
+						max_output, buffer_pool);
+	});
+}
+
+ThreadedBufferedSocket::~ThreadedBufferedSocket() noexcept
+{
+	if (IsDefined())
+		Close();
+}
+
+bool
+ThreadedBufferedSocket::IsDefined() const noexcept
+{
+	if (io_loop == nullptr)
+		return inner->IsDefined();
+
+	return inner != nullptr;
+}
+
+void
+ThreadedBufferedSocket::Close() noexcept
+{
+	if (io_loop == nullptr) {
+		inner->Close();
+		return;
+	}
+
+	BlockingCall(*io_loop, [this](){
+		inner->CancelDeferred();
+		if (inner->IsDefined())
+			inner->Close();
+		inner.reset();
+	});
+
+	defer_input.Cancel();
+}
+
+#ifdef HAVE_URING
+
+void
+ThreadedBufferedSocket::EnableUring() noexcept
+{
+	if (io_loop == nullptr) {
+		inner->EnableUring();
+		return;
+	}
+
+	BlockingCall(*io_loop, [this](){
+		if (inner->IsDefined())
+			inner->EnableUring();
+	});
+}
+
+#endif
+
+bool
+ThreadedBufferedSocket::ResumeInput() noexcept
+{
+	if (io_loop == nullptr)
+		return inner->ResumeInput();
+
+	assert(IsDefined());
+
+	input_paused = false;
+	defer_input.Schedule();
+	return true;
+}
+
+void
+ThreadedBufferedSocket::ConsumeInput(size_t nbytes) noexcept
+{
+	if (io_loop == nullptr)
+		inner->ConsumeInput(nbytes);
+	else
+		input.Consume(nbytes);
+}
+
+bool
+ThreadedBufferedSocket::Flush() noexcept
+{
+	if (io_loop == nullptr)
+		return inner->Flush();
+
+	bool result = false;
+	BlockingCall(*io_loop, [this, &result](){
+		result = inner->IsDefined() && TransferOutput() &&
+			inner->Flush();
+		OnInnerOutputConsumed();
+	});
+
+	if (!result)
+		CheckSharedError();
+
+	return result;
+}
+
+bool
+ThreadedBufferedSocket::Write(const void *data, size_t length) noexcept
+{
+	if (io_loop == nullptr)
+		return inner->Write(data, length);
+
+	assert(IsDefined());
+
+	if (length == 0)
+		return true;
+
+	bool was_empty, success;
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		was_empty = shared_output.empty();
+
+		/* the data which has already been moved to the
+		   #Inner output buffer counts against the same
+		   limit */
+		success = shared_output.GetSize() + shared_inner_output +
+			length <= max_output &&
+			shared_output.Append(data, length);
+	}
+
+	if (!success) {
+		OnSocketError(std::make_exception_ptr(std::runtime_error("Output buffer is full")));
+		return false;
+	}
+
+	if (was_empty)
+		inner->ScheduleDeferred();
+
+	return true;
+}
+
+WritableBuffer<void>
+ThreadedBufferedSocket::PrepareWrite() noexcept
+{
+	if (io_loop != nullptr)
+		/* the output buffer is owned by the I/O thread; the
+		   caller falls back to Write() */
+		return nullptr;
+
+	return inner->PrepareWrite();
+}
+
+void
+ThreadedBufferedSocket::CommitWrite(size_t length) noexcept
+{
+	assert(io_loop == nullptr || length == 0);
+
+	if (io_loop == nullptr)
+		inner->CommitWrite(length);
+}
+
+bool
+ThreadedBufferedSocket::ProcessInput() noexcept
+{
+	while (true) {
+		const auto r = input.Read();
+		if (r.empty())
+			return true;
+
+		switch (OnSocketInput(r.data, r.size)) {
+		case InputResult::MORE:
+			if (input.IsFull()) {
+				OnSocketError(std::make_exception_ptr(std::runtime_error("Input buffer is full")));
+				return false;
+			}
+
+			return true;
+
+		case InputResult::PAUSE:
+			input_paused = true;
+			return true;
+
+		case InputResult::AGAIN:
+			continue;
+
+		case InputResult::CLOSED:
+			return false;
+		}
+	}
+}
+
+bool
+ThreadedBufferedSocket::CheckSharedError() noexcept
+{
+	std::exception_ptr error;
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		error = std::exchange(shared_error, nullptr);
+	}
+
+	if (!error)
+		return false;
+
+	OnSocketError(std::move(error));
+	return true;
+}
+
+void
+ThreadedBufferedSocket::OnDeferredInput() noexcept
+{
+	assert(io_loop != nullptr);
+
+	if (!IsDefined())
+		return;
+
+	bool more_pending, resume = false, closed, out_of_memory = false;
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+
+		while (true) {
+			const auto r = shared_input.Read();
+			if (r.empty())
+				break;
+
+			const auto w = input.Write();
+			if (w.empty()) {
+				out_of_memory = input.empty();
+				break;
+			}
+
+			const size_t nbytes = std::min(r.size, w.size);
+			memcpy(w.data, r.data, nbytes);
+			input.Append(nbytes);
+			shared_input.Consume(nbytes);
+		}
+
+		shared_input.FreeIfEmpty();
+
+		more_pending = !shared_input.empty();
+
+		if (shared_input_paused && !shared_input.IsFull()) {
+			shared_input_paused = false;
+			shared_resume_input = resume = true;
+		}
+
+		closed = shared_closed;
+	}
+
+	if (resume)
+		inner->ScheduleDeferred();
+
+	if (out_of_memory) {
+		OnSocketError(std::make_exception_ptr(std::runtime_error("Out of buffer memory")));
+		return;
+	}
+
+	if (!input_paused) {
+		if (!ProcessInput())
+			return;
+
+		input.FreeIfEmpty();
+
+		if (more_pending && !input_paused)
+			/* more data is waiting in #shared_input */
+			defer_input.Schedule();
+	}
+
+	if (CheckSharedError())
+		return;
+
+	if (closed)
+		OnSocketClosed();
+}
+
+ThreadedBufferedSocket::InputResult
+ThreadedBufferedSocket::OnInnerInput(void *data, size_t length) noexcept
+{
+	if (io_loop == nullptr)
+		return OnSocketInput(data, length);
+
+	size_t nbytes = 0;
+	bool out_of_memory = false;
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+
+		auto w = shared_input.Write();
+		if (w.empty() && shared_input.empty()) {
+			/* the buffer pool is exhausted, and there
+			   is nothing which would resume input
+			   later */
+			out_of_memory = true;
+		} else {
+			nbytes = std::min(length, w.size);
+			memcpy(w.data, data, nbytes);
+			shared_input.Append(nbytes);
+
+			if (nbytes < length)
+				shared_input_paused = true;
+		}
+	}
+
+	if (out_of_memory) {
+		OnInnerError(std::make_exception_ptr(std::runtime_error("Out of buffer memory")));
+		return InputResult::CLOSED;
+	}
+
+	inner->ConsumeInput(nbytes);
+
+	if (nbytes > 0)
+		defer_input.Schedule();
+
+	return nbytes < length
+		? InputResult::PAUSE
+		: InputResult::MORE;
+}
+
+void
+ThreadedBufferedSocket::OnInnerError(std::exception_ptr ep) noexcept
+{
+	if (io_loop == nullptr) {
+		OnSocketError(std::move(ep));
+		return;
+	}
+
+	inner->Close();
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		shared_error = std::move(ep);
+	}
+
+	defer_input.Schedule();
+}
+
+void
+ThreadedBufferedSocket::OnInnerClosed() noexcept
+{
+	if (io_loop == nullptr) {
+		OnSocketClosed();
+		return;
+	}
+
+	inner->Close();
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		shared_closed = true;
+	}
+
+	defer_input.Schedule();
+}
+
+bool
+ThreadedBufferedSocket::TransferOutput() noexcept
+{
+	while (true) {
+		uint8_t buffer[16384];
+		size_t nbytes;
+
+		{
+			const std::lock_guard<Mutex> lock(mutex);
+
+			const auto r = shared_output.Read();
+			if (r.empty())
+				return true;
+
+			nbytes = std::min(r.size, sizeof(buffer));
+			memcpy(buffer, r.data, nbytes);
+			shared_output.Consume(nbytes);
+
+			/* account for the data right away, so
+			   Write() doesn't miss it while it is in
+			   neither buffer */
+			shared_inner_output += nbytes;
+		}
+
+		if (!inner->Write(buffer, nbytes))
+			return false;
+	}
+}
+
+void
+ThreadedBufferedSocket::OnInnerDeferred() noexcept
+{
+	assert(io_loop != nullptr);
+
+	if (!inner->IsDefined() || !TransferOutput())
+		return;
+
+	bool resume;
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		resume = std::exchange(shared_resume_input, false);
+	}
+
+	if (resume)
+		inner->ResumeInput();
+}
+
+void
+ThreadedBufferedSocket::OnInnerOutputConsumed() noexcept
+{
+	assert(io_loop != nullptr);
+
+	const size_t size = inner->GetOutputSize();
+
+	const std::lock_guard<Mutex> lock(mutex);
+	shared_inner_output = size;
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_THREADED_BUFFERED_SOCKET_HXX
+#define MPD_THREADED_BUFFERED_SOCKET_HXX
+
+#include "DeferEvent.hxx"
+#include "thread/Mutex.hxx"
+#include "net/SocketDescriptor.hxx"
+#include "PooledInputBuffer.hxx"
+#include "PooledOutputBuffer.hxx"
+#include "util/WritableBuffer.hxx"
+#include "util/Compiler.h"
+#include "io/uring/Features.h"
+
+#include <cstdint>
+#include <exception>
+#include <memory>
+
+class EventLoop;
+
+/**
+ * A replacement for #FullyBufferedSocket which can optionally move
+ * the socket I/O to another #EventLoop running in a different
+ * thread.  The virtual methods are always invoked in the "owner"
+ * #EventLoop passed to the constructor, and all public/protected
+ * methods must be called from there; only the system calls and the
+ * buffer management run in the I/O thread.
+ *
+ * Without an I/O #EventLoop, this is just a thin wrapper for
+ * #FullyBufferedSocket.
+ */
+class ThreadedBufferedSocket {
+	class Inner;
+
+	/**
+	 * The #EventLoop which invokes the virtual methods.
+	 */
+	EventLoop &owner_loop;
+
+	/**
+	 * The #EventLoop which performs the socket I/O, or nullptr if
+	 * that happens in #owner_loop.
+	 */
+	EventLoop *const io_loop;
+
+	/**
+	 * The maximum number of bytes in #shared_output and the
+	 * #Inner output buffer together.
+	 */
+	const size_t max_output;
+
+	/**
+	 * Notifies the owner thread about new input, errors and end
+	 * of stream.  Only used if #io_loop is set.
+	 */
+	DeferEvent defer_input;
+
+	/**
+	 * Input which has been moved from #shared_input and is being
+	 * parsed by OnSocketInput().  Only used if #io_loop is set.
+	 */
+	PooledInputBuffer input;
+
+	/**
+	 * Has OnSocketInput() returned InputResult::PAUSE?  Only
+	 * used if #io_loop is set.
+	 */
+	bool input_paused = false;
+
+	/**
+	 * Protects the "shared" fields below.
+	 */
+	Mutex mutex;
+
+	/**
+	 * Data received by the I/O thread, to be moved to #input by
+	 * the owner thread.
+	 */
+	PooledInputBuffer shared_input;
+
+	/**
+	 * Data submitted by the owner thread, to be sent by the I/O
+	 * thread.
+	 */
+	PooledOutputBuffer shared_output;
+
+	/**
+	 * An error which occurred in the I/O thread, to be reported
+	 * by the owner thread.
+	 */
+	std::exception_ptr shared_error;
+
+	/**
+	 * The number of bytes in the #Inner output buffer, published
+	 * by the I/O thread.  Counts against #max_output together
+	 * with #shared_output.
+	 */
+	size_t shared_inner_output = 0;
+
+	/**
+	 * Has the peer closed the connection?
+	 */
+	bool shared_closed = false;
+
+	/**
+	 * Has the I/O thread stopped reading because #shared_input
+	 * is full?
+	 */
+	bool shared_input_paused = false;
+
+	/**
+	 * Shall the I/O thread call ResumeInput()?
+	 */
+	bool shared_resume_input = false;
+
+	/**
+	 * The actual socket.  With #io_loop, this object lives in
+	 * that thread, and it is only ever created, used and
+	 * destroyed there.
+	 */
+	std::unique_ptr<Inner> inner;
+
+public:
+	/**
+	 * @param _io_loop the #EventLoop which performs the socket
+	 * I/O; nullptr to do everything in #_owner_loop
+	 * @param max_output the maximum number of bytes in the
+	 * output buffer
+	 * @param buffer_pool the pool which provides the buffer
+	 * memory
+	 */
+	ThreadedBufferedSocket(SocketDescriptor fd, EventLoop &_owner_loop,
+			       EventLoop *_io_loop,
+			       size_t max_output,
+			       SocketBufferPool &buffer_pool) noexcept;
+
+	~ThreadedBufferedSocket() noexcept;
+
+	ThreadedBufferedSocket(const ThreadedBufferedSocket &) = delete;
+	ThreadedBufferedSocket &operator=(const ThreadedBufferedSocket &) = delete;
+
+	EventLoop &GetEventLoop() const noexcept {
+		return owner_loop;
+	}
+
+	gcc_pure
+	bool IsDefined() const noexcept;
+
+	void Close() noexcept;
+
+#ifdef HAVE_URING
+	/**
+	 * Send and receive data with io_uring instead of epoll (in
+	 * the I/O thread, if there is one).  Call this right after
+	 * construction.  If io_uring is not available, this is a
+	 * no-op.
+	 */
+	void EnableUring() noexcept;
+#endif
+
+protected:
+	/**
+	 * The same as BufferedSocket::InputResult.
+	 */
+	enum class InputResult {
+		MORE,
+		PAUSE,
+		AGAIN,
+		CLOSED,
+	};
+
+	/**
+	 * @return false if the socket has been closed
+	 */
+	bool ResumeInput() noexcept;
+
+	/**
+	 * Mark a portion of the input buffer "consumed".  Only
+	 * allowed to be called from OnSocketInput().
+	 */
+	void ConsumeInput(size_t nbytes) noexcept;
+
+	/**
+	 * Send data from the output buffer to the socket.
+	 *
+	 * @return false if the socket has been closed
+	 */
+	bool Flush() noexcept;
+
+	/**
+	 * @return false if the socket has been closed
+	 */
+	bool Write(const void *data, size_t length) noexcept;
+
+	/**
+	 * See FullyBufferedSocket::PrepareWrite().  Always returns
+	 * an empty buffer if the I/O runs in another thread.
+	 */
+	WritableBuffer<void> PrepareWrite() noexcept;
+
+	void CommitWrite(size_t length) noexcept;
+
+	virtual InputResult OnSocketInput(void *data, size_t length) noexcept = 0;
+	virtual void OnSocketError(std::exception_ptr ep) noexcept = 0;
+	virtual void OnSocketClosed() noexcept = 0;
+
+private:
+	/**
+	 * Feed #input to OnSocketInput().
+	 *
+	 * @return false if the socket has been closed
+	 */
+	bool ProcessInput() noexcept;
+
+	/**
+	 * Report a pending #shared_error to OnSocketError().
+	 *
+	 * @return true if there was an error
+	 */
+	bool CheckSharedError() noexcept;
+
+	/* callback for #defer_input (owner thread) */
+	void OnDeferredInput() noexcept;
+
+	/* callbacks for #Inner (I/O thread) */
+	InputResult OnInnerInput(void *data, size_t length) noexcept;
+	void OnInnerError(std::exception_ptr ep) noexcept;
+	void OnInnerClosed() noexcept;
+	void OnInnerDeferred() noexcept;
+
+	/**
+	 * Publish the size of the #Inner output buffer after it has
+	 * sent data.  Runs in the I/O thread.
+	 */
+	void OnInnerOutputConsumed() noexcept;
+
+	/**
+	 * Move data from #shared_output to the #Inner output buffer.
+	 * Runs in the I/O thread.
+	 *
+	 * @return false if the socket has been closed
+	 */
+	bool TransferOutput() noexcept;
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "TimerWheel.hxx"
+
+#include <algorithm>
+
+TimerWheel::TimerWheel() noexcept = default;
+TimerWheel::~TimerWheel() noexcept = default;
+
+bool
+TimerWheel::IsEmpty() const noexcept
+{
+	return std::all_of(buckets.begin(), buckets.end(),
+			   [](const auto &list){ return list.empty(); });
+}
+
+void
+TimerWheel::Insert(CoarseTimerEvent &t) noexcept
+{
+	buckets[BucketIndexAt(t.due)].push_back(t);
+}
+
+inline void
+TimerWheel::Run(List &list, std::chrono::steady_clock::time_point now) noexcept
+{
+	/* move all timers to a temporary list to avoid problems
+	   with callbacks which schedule or cancel timers in the same
+	   bucket */
+	List tmp;
+	tmp.splice(tmp.end(), list);
+
+	while (!tmp.empty()) {
+		auto &t = tmp.front();
+		tmp.pop_front();
+
+		if (t.due <= now)
+			t.Run();
+		else
+			/* due in a later revolution of the wheel */
+			list.push_back(t);
+	}
+}
+
+std::chrono::steady_clock::duration
+TimerWheel::GetSleep(std::chrono::steady_clock::time_point now) const noexcept
+{
+	const std::size_t current = BucketIndexAt(now);
+
+	for (std::size_t i = 0; i < N_BUCKETS; ++i) {
+		if (!buckets[(current + i) % N_BUCKETS].empty())
+			/* wake up at the end of this bucket, when
+			   all of its timers have expired */
+			return GetBucketStartTime(now) + (i + 1) * RESOLUTION
+				- now;
+	}
+
+	return std::chrono::steady_clock::duration(-1);
+}
+
+std::chrono::steady_clock::duration
+TimerWheel::Run(std::chrono::steady_clock::time_point now) noexcept
+{
+	/* visit all buckets which have been passed since the last
+	   call, including the current one */
+	const auto n_passed = std::size_t((GetBucketStartTime(now) -
+					   GetBucketStartTime(last_time)) /
+					  RESOLUTION) + 1;
+	const std::size_t n = std::min(n_passed, N_BUCKETS);
+	const std::size_t first = BucketIndexAt(last_time);
+
+	last_time = now;
+
+	for (std::size_t i = 0; i < n; ++i)
+		Run(buckets[(first + i) % N_BUCKETS], now);
+
+	return GetSleep(now);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_TIMER_WHEEL_HXX
+#define MPD_TIMER_WHEEL_HXX
+
+#include "CoarseTimerEvent.hxx"
+#include "util/Compiler.h"
+
+#include <boost/intrusive/list.hpp>
+
+#include <array>
+#include <chrono>
+
+/**
+ * A timer wheel for #CoarseTimerEvent instances.  Each bucket covers
+ * #RESOLUTION; timers which are due after one revolution of the
+ * wheel stay in their bucket and are skipped until they expire.
+ * Waking up only at bucket boundaries coalesces the wakeups of all
+ * timers of a bucket.
+ */
+class TimerWheel final {
+	static constexpr std::chrono::steady_clock::duration RESOLUTION =
+		std::chrono::seconds(1);
+	static constexpr std::size_t N_BUCKETS = 64;
+
+	typedef boost::intrusive::list<CoarseTimerEvent,
+				       boost::intrusive::member_hook<CoarseTimerEvent,
+								     CoarseTimerEvent::ListHook,
+								     &CoarseTimerEvent::list_hook>,
+				       boost::intrusive::constant_time_size<false>> List;
+
+	std::array<List, N_BUCKETS> buckets;
+
+	/**
+	 * The time of the last Run() call.  Buckets before this one
+	 * have already been handled.
+	 */
+	std::chrono::steady_clock::time_point last_time{};
+
+public:
+	TimerWheel() noexcept;
+	~TimerWheel() noexcept;
+
+	TimerWheel(const TimerWheel &) = delete;
+	TimerWheel &operator=(const TimerWheel &) = delete;
+
+	gcc_pure
+	bool IsEmpty() const noexcept;
+
+	void Insert(CoarseTimerEvent &t) noexcept;
+
+	/**
+	 * Invoke all expired #CoarseTimerEvent instances and return
+	 * the duration until the next wakeup.  Returns a negative
+	 * duration if there is no timer.
+	 */
+	std::chrono::steady_clock::duration
+	Run(std::chrono::steady_clock::time_point now) noexcept;
+
+private:
+	static constexpr std::size_t
+	BucketIndexAt(std::chrono::steady_clock::time_point t) noexcept {
+		return std::size_t(t.time_since_epoch() / RESOLUTION)
+			% N_BUCKETS;
+	}
+
+	static constexpr std::chrono::steady_clock::time_point
+	GetBucketStartTime(std::chrono::steady_clock::time_point t) noexcept {
+		return t - t.time_since_epoch() % RESOLUTION;
+	}
+
+	/**
+	 * Determine the time until the end of the next non-empty
+	 * bucket.
+	 */
+	gcc_pure
+	std::chrono::steady_clock::duration
+	GetSleep(std::chrono::steady_clock::time_point now) const noexcept;
+
+	/**
+	 * Invoke all expired timers in the given bucket.
+	 */
+	void Run(List &list, std::chrono::steady_clock::time_point now) noexcept;
+};
+
+#endif
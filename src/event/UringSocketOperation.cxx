@@ -0,0 +1,227 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "UringSocketOperation.hxx"
+#include "SocketBufferPool.hxx"
+#include "io/uring/Queue.hxx"
+#include "net/SocketError.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <utility>
+
+#include <string.h>
+#include <sys/socket.h>
+
+UringSocketOperation::~UringSocketOperation() noexcept
+{
+	assert(!IsPending());
+
+	FreeSegment();
+}
+
+inline void
+UringSocketOperation::FreeSegment() noexcept
+{
+	if (segment != nullptr) {
+		pool.Free(segment);
+		segment = nullptr;
+	}
+}
+
+struct io_uring_sqe *
+UringSocketOperation::GetSubmitEntry() noexcept
+{
+	auto *s = queue.GetSubmitEntry();
+	if (s != nullptr)
+		return s;
+
+	/* the submission queue is full; this can happen if many
+	   sockets start an operation in the same event loop
+	   iteration, before Uring::Manager gets a chance to submit
+	   them; submit now to make room */
+	try {
+		queue.Submit();
+	} catch (...) {
+		return nullptr;
+	}
+
+	return queue.GetSubmitEntry();
+}
+
+UringSocketOperation::StartResult
+UringSocketOperation::StartReceive(std::size_t max_size) noexcept
+{
+	assert(!IsPending());
+	assert(segment == nullptr);
+	assert(max_size > 0);
+
+	segment = pool.Allocate();
+	if (segment == nullptr)
+		return StartResult::NO_BUFFER;
+
+	auto *s = GetSubmitEntry();
+	if (s == nullptr) {
+		FreeSegment();
+		return StartResult::QUEUE_FULL;
+	}
+
+	sending = false;
+
+	io_uring_prep_recv(s, socket.Get(), segment,
+			   std::min(max_size, SocketBufferPool::SEGMENT_SIZE),
+			   0);
+	queue.Push(*s, *this);
+	return StartResult::OK;
+}
+
+UringSocketOperation::StartResult
+UringSocketOperation::StartSend(const void *data, std::size_t size) noexcept
+{
+	assert(!IsPending());
+	assert(segment == nullptr);
+	assert(size > 0);
+
+	segment = pool.Allocate();
+	if (segment == nullptr)
+		return StartResult::NO_BUFFER;
+
+	sending = true;
+	position = 0;
+	end = std::min(size, SocketBufferPool::SEGMENT_SIZE);
+	memcpy(segment, data, end);
+
+	if (!SubmitSend()) {
+		FreeSegment();
+		return StartResult::QUEUE_FULL;
+	}
+
+	return StartResult::OK;
+}
+
+bool
+UringSocketOperation::SubmitSend() noexcept
+{
+	assert(sending);
+	assert(position < end);
+
+	auto *s = GetSubmitEntry();
+	if (s == nullptr)
+		return false;
+
+	io_uring_prep_send(s, socket.Get(),
+			   (const char *)segment + position, end - position,
+			   MSG_NOSIGNAL);
+	queue.Push(*s, *this);
+	return true;
+}
+
+int
+UringSocketOperation::SendRemainder() noexcept
+{
+	assert(HasRemainder());
+	assert(sending);
+	assert(position < end);
+
+	const auto nbytes = socket.Write((const char *)segment + position,
+					 end - position);
+	if (nbytes < 0) {
+		const auto code = GetSocketError();
+		if (IsSocketErrorAgain(code))
+			return -EAGAIN;
+
+		FreeSegment();
+		return -code;
+	}
+
+	position += nbytes;
+	if (position < end)
+		return -EAGAIN;
+
+	FreeSegment();
+	return 0;
+}
+
+void
+UringSocketOperation::Orphan() noexcept
+{
+	if (!IsPending()) {
+		delete this;
+		return;
+	}
+
+	/* the kernel owns the buffer until the operation completes;
+	   shutting down the socket makes it complete right away */
+	handler = nullptr;
+	socket.Shutdown();
+}
+
+void
+UringSocketOperation::OnUringCompletion(int res) noexcept
+{
+	if (handler == nullptr) {
+		/* orphaned */
+		delete this;
+		return;
+	}
+
+	if (res == -ECANCELED) {
+		/* the io_uring is being shut down; Uring::Queue
+		   delivers this only after the kernel has completed
+		   (or cancelled) the operation, so the segment can
+		   be freed */
+		FreeSegment();
+		return;
+	}
+
+	if (sending) {
+		if (res > 0) {
+			position += res;
+			if (position < end) {
+				/* partial send: submit the rest */
+				if (SubmitSend())
+					return;
+
+				/* the submission queue is full; keep
+				   the rest in the segment and let the
+				   handler send it with
+				   SendRemainder() when the socket
+				   becomes writable */
+				handler->OnUringSend(-EAGAIN);
+				return;
+			} else
+				res = 0;
+		} else if (res == 0)
+			res = -EPIPE;
+
+		FreeSegment();
+		handler->OnUringSend(res);
+	} else {
+		void *data = res > 0
+			? std::exchange(segment, nullptr)
+			: nullptr;
+		FreeSegment();
+
+		/* this must be the last access to "this", because the
+		   handler may delete us */
+		handler->OnUringReceive(data, res);
+	}
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_URING_SOCKET_OPERATION_HXX
+#define MPD_URING_SOCKET_OPERATION_HXX
+
+#include "io/uring/Operation.hxx"
+#include "net/SocketDescriptor.hxx"
+
+#include <cstddef>
+
+namespace Uring { class Queue; }
+class SocketBufferPool;
+
+class UringSocketHandler {
+public:
+	/**
+	 * A receive operation has completed.
+	 *
+	 * @param segment the buffer segment containing the received
+	 * data; the handler takes ownership and must return it to
+	 * the #SocketBufferPool; nullptr if nothing was received
+	 * @param res the number of bytes received, 0 on end of
+	 * stream or a negative errno value
+	 */
+	virtual void OnUringReceive(void *segment, int res) noexcept = 0;
+
+	/**
+	 * A send operation has completed.
+	 *
+	 * @param res 0 on success or a negative errno value; -EAGAIN
+	 * means that only part was sent and the rest could not be
+	 * resubmitted because the submission queue was full; the
+	 * rest remains in the operation, and the handler should call
+	 * UringSocketOperation::SendRemainder() as soon as the
+	 * socket becomes writable
+	 */
+	virtual void OnUringSend(int res) noexcept = 0;
+};
+
+/**
+ * A "recv" or "send" operation on a socket performed by io_uring.
+ * The data is transferred from/to a buffer segment owned by this
+ * object (borrowed from a #SocketBufferPool), because the kernel
+ * may access it until the operation completes, even after the
+ * socket object has been closed.  In that case, the socket calls
+ * Orphan(), and this object deletes itself upon completion.
+ */
+class UringSocketOperation final : Uring::Operation {
+	Uring::Queue &queue;
+
+	SocketBufferPool &pool;
+
+	UringSocketHandler *handler;
+
+	SocketDescriptor socket;
+
+	/**
+	 * The buffer segment; only set while an operation is
+	 * pending.
+	 */
+	void *segment = nullptr;
+
+	/**
+	 * The portion of #segment which remains to be sent.
+	 */
+	std::size_t position, end;
+
+	bool sending;
+
+public:
+	UringSocketOperation(Uring::Queue &_queue,
+			     SocketBufferPool &_pool,
+			     UringSocketHandler &_handler,
+			     SocketDescriptor _socket) noexcept
+		:queue(_queue), pool(_pool),
+		 handler(&_handler), socket(_socket) {}
+
+	~UringSocketOperation() noexcept;
+
+	UringSocketOperation(const UringSocketOperation &) = delete;
+	UringSocketOperation &operator=(const UringSocketOperation &) = delete;
+
+	bool IsPending() const noexcept {
+		return IsUringPending();
+	}
+
+	enum class StartResult {
+		OK,
+
+		/**
+		 * No buffer segment could be allocated.
+		 */
+		NO_BUFFER,
+
+		/**
+		 * The io_uring submission queue is full, even after
+		 * submitting all queued entries.  The caller should
+		 * fall back to plain send()/recv().
+		 */
+		QUEUE_FULL,
+	};
+
+	/**
+	 * Submit a "recv" operation.
+	 *
+	 * @param max_size the maximum number of bytes to receive
+	 */
+	StartResult StartReceive(std::size_t max_size) noexcept;
+
+	/**
+	 * Copy data into the buffer segment and submit a "send"
+	 * operation.  On success, GetSendSize() returns the number
+	 * of bytes which were copied (and will be sent).
+	 */
+	StartResult StartSend(const void *data, std::size_t size) noexcept;
+
+	std::size_t GetSendSize() const noexcept {
+		return end;
+	}
+
+	/**
+	 * Is there unsent data left over from a partial send which
+	 * could not be resubmitted?  See UringSocketHandler::OnUringSend().
+	 */
+	bool HasRemainder() const noexcept {
+		return !IsPending() && segment != nullptr;
+	}
+
+	/**
+	 * Send the rest of a partial send with a plain
+	 * (non-blocking) send() call.
+	 *
+	 * @return 0 if everything has been sent, -EAGAIN if the
+	 * socket buffer is full (call again when the socket becomes
+	 * writable) or another negative errno value
+	 */
+	int SendRemainder() noexcept;
+
+	/**
+	 * The socket is about to be closed or destroyed.  If an
+	 * operation is pending, it is aborted by shutting down the
+	 * socket, and this object deletes itself when the kernel has
+	 * completed it; else it is deleted immediately.
+	 */
+	void Orphan() noexcept;
+
+private:
+	/**
+	 * Obtain a submission queue entry.  If the queue is full,
+	 * submit all queued entries to the kernel to make room.
+	 *
+	 * @return nullptr if the queue is still full
+	 */
+	struct io_uring_sqe *GetSubmitEntry() noexcept;
+
+	/**
+	 * @return false if the submission queue is full
+	 */
+	bool SubmitSend() noexcept;
+
+	void FreeSegment() noexcept;
+
+	/* virtual methods from class Uring::Operation */
+	void OnUringCompletion(int res) noexcept override;
+};
+
+#endif
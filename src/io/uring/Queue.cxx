@@ -34,6 +34,8 @@
 #include "CancellableOperation.hxx"
 #include "util/DeleteDisposer.hxx"
 
+#include <cerrno>
+
 namespace Uring {
 
 Queue::Queue(unsigned entries, unsigned flags)
@@ -43,7 +45,57 @@ Queue::Queue(unsigned entries, unsigned flags)
 
 Queue::~Queue() noexcept
 {
-	operations.clear_and_dispose(DeleteDisposer{});
+	/* the kernel may still access the buffers of pending
+	   operations; cancel them and wait for their completions
+	   before notifying them */
+	try {
+		CancelAndReapPending();
+	} catch (...) {
+	}
+
+	/* notify all pending operations, so they don't refer to
+	   this object after it has been destroyed */
+	operations.clear_and_dispose([](CancellableOperation *c){
+		c->OnUringCompletion(-ECANCELED);
+		delete c;
+	});
+}
+
+void
+Queue::CancelAndReapPending()
+{
+	for (auto &c : operations) {
+		auto *s = ring.GetSubmitEntry();
+		if (s == nullptr) {
+			ring.Submit();
+			s = ring.GetSubmitEntry();
+			if (s == nullptr)
+				break;
+		}
+
+		io_uring_prep_cancel(s, &c, 0);
+		io_uring_sqe_set_data(s, nullptr);
+	}
+
+	ring.Submit();
+
+	while (!operations.empty()) {
+		auto *cqe = ring.WaitCompletion();
+		if (cqe == nullptr)
+			break;
+
+		/* the kernel is done with this operation; report it
+		   as cancelled, no matter what the result was */
+		void *data = io_uring_cqe_get_data(cqe);
+		if (data != nullptr) {
+			auto *c = (CancellableOperation *)data;
+			c->OnUringCompletion(-ECANCELED);
+			operations.erase_and_dispose(operations.iterator_to(*c),
+						     DeleteDisposer{});
+		}
+
+		ring.SeenCompletion(*cqe);
+	}
 }
 
 void
@@ -99,6 +99,14 @@ public:
 
 private:
 	void DispatchOneCompletion(struct io_uring_cqe &cqe) noexcept;
+
+	/**
+	 * Cancel all pending operations and wait until the kernel
+	 * has completed them, notifying each with -ECANCELED.
+	 *
+	 * Throws on error.
+	 */
+	void CancelAndReapPending();
 };
 
 } // namespace Uring
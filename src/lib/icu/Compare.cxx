@@ -20,6 +20,7 @@
 #include "Compare.hxx"
 #include "CaseFold.hxx"
 #include "util/StringAPI.hxx"
+#include "util/StringSearch.hxx"
 #include "config.h"
 
 #ifdef _WIN32
@@ -30,7 +31,11 @@
 #ifdef HAVE_ICU_CASE_FOLD
 
 IcuCompare::IcuCompare(std::string_view _needle) noexcept
-	:needle(IcuCaseFold(_needle)) {}
+	:needle(IcuCaseFold(_needle))
+{
+	if (!needle.IsNull())
+		needle_length = strlen(needle.c_str());
+}
 
 #elif defined(_WIN32)
 
@@ -50,6 +55,24 @@ IcuCompare::IcuCompare(std::string_view _needle) noexcept
 
 #endif
 
+#ifdef HAVE_ICU_CASE_FOLD
+
+bool
+IcuCompare::EqualsFolded(std::string_view folded_haystack) const noexcept
+{
+	return folded_haystack == std::string_view(needle.c_str(),
+						   needle_length);
+}
+
+bool
+IcuCompare::IsInFolded(std::string_view folded_haystack) const noexcept
+{
+	return ContainsSubstring(folded_haystack,
+				 {needle.c_str(), needle_length});
+}
+
+#endif
+
 bool
 IcuCompare::operator==(const char *haystack) const noexcept
 {
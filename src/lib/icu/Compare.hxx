@@ -20,6 +20,7 @@
 #ifndef MPD_ICU_COMPARE_HXX
 #define MPD_ICU_COMPARE_HXX
 
+#include "CaseFold.hxx"
 #include "util/Compiler.h"
 #include "util/AllocatedString.hxx"
 
@@ -43,6 +44,14 @@ class IcuCompare {
 	AllocatedString<> needle;
 #endif
 
+#ifdef HAVE_ICU_CASE_FOLD
+	/**
+	 * The length of the case-folded #needle, for
+	 * EqualsFolded() and IsInFolded().
+	 */
+	std::size_t needle_length = 0;
+#endif
+
 public:
 	IcuCompare():needle(nullptr) {}
 
@@ -51,12 +60,19 @@ public:
 	IcuCompare(const IcuCompare &src) noexcept
 		:needle(src
 			? src.needle.Clone()
-			: nullptr) {}
+			: nullptr)
+#ifdef HAVE_ICU_CASE_FOLD
+		, needle_length(src.needle_length)
+#endif
+	{}
 
 	IcuCompare &operator=(const IcuCompare &src) noexcept {
 		needle = src
 			? src.needle.Clone()
 			: nullptr;
+#ifdef HAVE_ICU_CASE_FOLD
+		needle_length = src.needle_length;
+#endif
 		return *this;
 	}
 
@@ -73,6 +89,23 @@ public:
 
 	gcc_pure
 	bool IsIn(const char *haystack) const noexcept;
+
+#ifdef HAVE_ICU_CASE_FOLD
+	/**
+	 * Like operator==(), but the haystack has already been
+	 * case-folded with IcuCaseFold(), so this is a plain byte
+	 * comparison.
+	 */
+	gcc_pure
+	bool EqualsFolded(std::string_view folded_haystack) const noexcept;
+
+	/**
+	 * Like IsIn(), but the haystack has already been case-folded
+	 * with IcuCaseFold().
+	 */
+	gcc_pure
+	bool IsInFolded(std::string_view folded_haystack) const noexcept;
+#endif
 };
 
 #endif
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "FlacHeaderScan.hxx"
+#include "FlacAudioFormat.hxx"
+#include "ScanVorbisComment.hxx"
+#include "VorbisCommentBlock.hxx"
+#include "input/InputStream.hxx"
+#include "pcm/CheckAudioFormat.hxx"
+#include "tag/Handler.hxx"
+#include "tag/Id3Picture.hxx"
+#include "util/AllocatedArray.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/StringView.hxx"
+
+#include <cstdint>
+#include <vector>
+
+#include <string.h>
+
+enum FlacBlockType : uint8_t {
+	STREAMINFO = 0,
+	VORBIS_COMMENT = 4,
+	PICTURE = 6,
+	INVALID = 127,
+};
+
+static constexpr size_t FLAC_STREAMINFO_SIZE = 34;
+
+/**
+ * Comment blocks larger than this are not parsed here; libFLAC will
+ * deal with them.
+ */
+static constexpr size_t MAX_COMMENT_SIZE = 1024 * 1024;
+
+static AllocatedArray<uint8_t>
+ReadBlock(InputStream &is, std::unique_lock<Mutex> &lock, size_t size)
+{
+	AllocatedArray<uint8_t> buffer(size);
+	is.ReadFull(lock, buffer.begin(), size);
+	return buffer;
+}
+
+static void
+ScanStreamInfo(const uint8_t *p, TagHandler &handler) noexcept
+{
+	/* skip the block sizes (2 * 16 bits) and frame sizes (2 *
+	   24 bits) */
+	p += 10;
+
+	const unsigned sample_rate = (p[0] << 12) | (p[1] << 4) | (p[2] >> 4);
+	const unsigned channels = ((p[2] >> 1) & 0x7) + 1;
+	const unsigned bits_per_sample = (((p[2] & 0x1) << 4) | (p[3] >> 4)) + 1;
+	const uint64_t total_samples = (uint64_t(p[3] & 0xf) << 32) |
+		(uint64_t(p[4]) << 24) | (p[5] << 16) | (p[6] << 8) | p[7];
+
+	if (sample_rate > 0)
+		handler.OnDuration(SongTime::FromScale<uint64_t>(total_samples,
+								 sample_rate));
+
+	try {
+		handler.OnAudioFormat(CheckAudioFormat(sample_rate,
+						       FlacSampleFormat(bits_per_sample),
+						       channels));
+	} catch (...) {
+	}
+}
+
+static void
+ScanPicture(ConstBuffer<uint8_t> picture, TagHandler &handler) noexcept
+{
+	/* a MIME type of "-->" means this is a URL, not image
+	   data */
+	if (picture.size >= 11 && memcmp(picture.data + 4,
+					  "\0\0\0\3-->", 7) == 0)
+		return;
+
+	ScanId3Apic(picture.ToVoid(), handler);
+}
+
+bool
+ScanFlacHeader(InputStream &is, TagHandler &handler)
+{
+	std::unique_lock<Mutex> lock(is.mutex);
+
+	char magic[4];
+	is.ReadFull(lock, magic, sizeof(magic));
+	if (memcmp(magic, "fLaC", sizeof(magic)) != 0)
+		return false;
+
+	uint8_t stream_info[FLAC_STREAMINFO_SIZE];
+	bool have_stream_info = false;
+	AllocatedArray<uint8_t> comment;
+	std::vector<AllocatedArray<uint8_t>> pictures;
+
+	bool last;
+	do {
+		uint8_t header[4];
+		is.ReadFull(lock, header, sizeof(header));
+
+		last = (header[0] & 0x80) != 0;
+		const auto type = FlacBlockType(header[0] & 0x7f);
+		size_t size = (header[1] << 16) | (header[2] << 8) | header[3];
+
+		if (!have_stream_info && type != STREAMINFO)
+			/* STREAMINFO must be the first block */
+			return false;
+
+		switch (type) {
+		case STREAMINFO:
+			if (have_stream_info || size < sizeof(stream_info))
+				return false;
+
+			is.ReadFull(lock, stream_info, sizeof(stream_info));
+			size -= sizeof(stream_info);
+			have_stream_info = true;
+			break;
+
+		case VORBIS_COMMENT:
+			if (!comment.empty() || size > MAX_COMMENT_SIZE)
+				return false;
+
+			comment = ReadBlock(is, lock, size);
+			size = 0;
+			break;
+
+		case PICTURE:
+			if (!handler.WantPicture())
+				break;
+
+			pictures.emplace_back(ReadBlock(is, lock, size));
+			size = 0;
+			break;
+
+		case INVALID:
+			return false;
+		}
+
+		if (size > 0)
+			is.Skip(lock, size);
+	} while (!last);
+
+	lock.unlock();
+
+	std::vector<StringView> comments;
+	if (!comment.empty() &&
+	    !SplitVorbisCommentBlock({comment.begin(), comment.size()},
+				     comments))
+		return false;
+
+	/* all metadata has been read and validated; now submit it
+	   to the TagHandler */
+
+	ScanStreamInfo(stream_info, handler);
+
+	for (const auto &i : comments)
+		ScanVorbisComment(i, handler);
+
+	for (const auto &i : pictures)
+		ScanPicture({i.begin(), i.size()}, handler);
+
+	return true;
+}
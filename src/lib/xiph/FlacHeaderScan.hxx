@@ -0,0 +1,43 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_FLAC_HEADER_SCAN_HXX
+#define MPD_FLAC_HEADER_SCAN_HXX
+
+class InputStream;
+class TagHandler;
+
+/**
+ * Scan the metadata blocks of a native FLAC file without libFLAC.
+ * Only the STREAMINFO, VORBIS_COMMENT and (if the #TagHandler wants
+ * it) PICTURE blocks are read; all other blocks are skipped.  The
+ * #TagHandler is only invoked after all metadata blocks have been
+ * read successfully, so the caller can fall back to libFLAC if this
+ * function fails.
+ *
+ * Throws on I/O error.
+ *
+ * @return false if this is not a FLAC file (or one this parser
+ * cannot handle, e.g. with a leading ID3 tag)
+ */
+bool
+ScanFlacHeader(InputStream &is, TagHandler &handler);
+
+#endif
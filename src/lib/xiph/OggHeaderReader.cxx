@@ -0,0 +1,199 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "OggHeaderReader.hxx"
+#include "input/InputStream.hxx"
+#include "util/ByteOrder.hxx"
+
+#include <string.h>
+
+static constexpr uint8_t OGG_CONTINUED = 0x01;
+static constexpr uint8_t OGG_BOS = 0x02;
+static constexpr uint8_t OGG_EOS = 0x04;
+
+/**
+ * The fixed part of an Ogg page header, followed by the lacing
+ * values.
+ */
+struct OggPageHeader {
+	char capture_pattern[4];
+	uint8_t version;
+	uint8_t header_type;
+	uint8_t granule_position[8];
+	uint8_t serial[4];
+	uint8_t sequence[4];
+	uint8_t checksum[4];
+	uint8_t n_segments;
+
+	bool IsValid() const noexcept {
+		return memcmp(capture_pattern, "OggS", 4) == 0 &&
+			version == 0;
+	}
+
+	uint32_t GetSerial() const noexcept {
+		uint32_t value;
+		memcpy(&value, serial, sizeof(value));
+		return FromLE32(value);
+	}
+
+	uint64_t GetGranulePosition() const noexcept {
+		uint64_t value;
+		memcpy(&value, granule_position, sizeof(value));
+		return FromLE64(value);
+	}
+};
+
+static_assert(sizeof(OggPageHeader) == 27, "Wrong struct size");
+
+static size_t
+SumSegments(const uint8_t *segments, unsigned n) noexcept
+{
+	size_t size = 0;
+	for (unsigned i = 0; i < n; ++i)
+		size += segments[i];
+	return size;
+}
+
+bool
+OggHeaderReader::ReadPage()
+{
+	std::unique_lock<Mutex> lock(is.mutex);
+
+	while (true) {
+		OggPageHeader header;
+		is.ReadFull(lock, &header, sizeof(header));
+		if (!header.IsValid())
+			return false;
+
+		n_segments = header.n_segments;
+		is.ReadFull(lock, segments, n_segments);
+
+		const size_t size = SumSegments(segments, n_segments);
+
+		if (first) {
+			if ((header.header_type & OGG_BOS) == 0)
+				return false;
+
+			serial = header.GetSerial();
+			first = false;
+		} else if (header.GetSerial() != serial) {
+			/* skip pages of other logical streams */
+			is.Skip(lock, size);
+			continue;
+		}
+
+		body.resize(size);
+		is.ReadFull(lock, body.data(), size);
+		body_position = 0;
+		segment_index = 0;
+		continued = (header.header_type & OGG_CONTINUED) != 0;
+		return true;
+	}
+}
+
+bool
+OggHeaderReader::ReadPacket(std::vector<uint8_t> &packet, size_t max_size)
+{
+	packet.clear();
+
+	while (true) {
+		if (segment_index >= n_segments) {
+			const bool start = packet.empty();
+			if (!ReadPage() || continued == start)
+				/* packet boundaries do not match page
+				   boundaries */
+				return false;
+
+			continue;
+		}
+
+		const size_t length = segments[segment_index++];
+		if (packet.size() + length > max_size)
+			return false;
+
+		packet.insert(packet.end(),
+			      body.begin() + body_position,
+			      body.begin() + body_position + length);
+		body_position += length;
+
+		if (length < 255)
+			return true;
+	}
+}
+
+bool
+OggFindEOSGranule(InputStream &is, uint32_t serial, uint64_t &granule_r)
+{
+	std::unique_lock<Mutex> lock(is.mutex);
+
+	if (!is.KnownSize())
+		return false;
+
+	static constexpr offset_type TAIL_SIZE = 65536;
+
+	const offset_type size = is.GetSize();
+	offset_type start = size > TAIL_SIZE ? size - TAIL_SIZE : 0;
+	if (start < is.GetOffset())
+		/* the end of the stream cannot be before the header
+		   pages we have already read */
+		start = is.GetOffset();
+
+	if (start > is.GetOffset()) {
+		if (!is.CheapSeeking())
+			return false;
+
+		is.Seek(lock, start);
+	}
+
+	std::vector<uint8_t> tail(size - start);
+	is.ReadFull(lock, tail.data(), tail.size());
+
+	bool found = false;
+
+	size_t i = 0;
+	while (i + sizeof(OggPageHeader) <= tail.size()) {
+		const auto &header = *(const OggPageHeader *)&tail[i];
+		const size_t segments_end = i + sizeof(header) +
+			header.n_segments;
+		if (!header.IsValid() || segments_end > tail.size()) {
+			/* not a page header: resynchronize */
+			++i;
+			continue;
+		}
+
+		const size_t page_end = segments_end +
+			SumSegments(&tail[i + sizeof(header)],
+				    header.n_segments);
+		if (page_end > tail.size()) {
+			++i;
+			continue;
+		}
+
+		if (header.GetSerial() == serial &&
+		    (header.header_type & OGG_EOS) != 0) {
+			granule_r = header.GetGranulePosition();
+			found = true;
+		}
+
+		i = page_end;
+	}
+
+	return found;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_OGG_HEADER_READER_HXX
+#define MPD_OGG_HEADER_READER_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class InputStream;
+
+/**
+ * A minimal Ogg page parser which reassembles the header packets of
+ * the first logical stream of a file, without libogg.  It is meant
+ * for scanning tags: it reads only as many pages as needed and does
+ * not verify page checksums, so a caller should fall back to the
+ * libogg code path if it fails.
+ */
+class OggHeaderReader {
+	InputStream &is;
+
+	uint32_t serial;
+
+	/**
+	 * The lacing values of the current page.
+	 */
+	uint8_t segments[255];
+	unsigned n_segments = 0, segment_index = 0;
+
+	/**
+	 * The body of the current page and the read position within
+	 * it.
+	 */
+	std::vector<uint8_t> body;
+	size_t body_position = 0;
+
+	/**
+	 * Does the current page continue a packet from the previous
+	 * page?
+	 */
+	bool continued;
+
+	bool first = true;
+
+public:
+	explicit OggHeaderReader(InputStream &_is) noexcept
+		:is(_is) {}
+
+	OggHeaderReader(const OggHeaderReader &) = delete;
+	OggHeaderReader &operator=(const OggHeaderReader &) = delete;
+
+	uint32_t GetSerial() const noexcept {
+		return serial;
+	}
+
+	/**
+	 * Read the next packet of the first logical stream.
+	 *
+	 * Throws on I/O error.
+	 *
+	 * @param max_size fail if the packet is larger than this
+	 * @return false if the stream is malformed or the packet is
+	 * too large
+	 */
+	bool ReadPacket(std::vector<uint8_t> &packet, size_t max_size);
+
+private:
+	bool ReadPage();
+};
+
+/**
+ * Find the granule position of the page which finishes the given
+ * logical stream ("end of stream" flag), by reading the last 64 kB of
+ * the file in one chunk.
+ *
+ * Throws on I/O error.
+ *
+ * @return false if no such page was found or if the stream is not
+ * cheaply seekable
+ */
+bool
+OggFindEOSGranule(InputStream &is, uint32_t serial, uint64_t &granule_r);
+
+#endif
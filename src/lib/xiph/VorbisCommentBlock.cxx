@@ -0,0 +1,80 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "VorbisCommentBlock.hxx"
+#include "util/ByteOrder.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/StringView.hxx"
+
+#include <cstdint>
+
+#include <string.h>
+
+static bool
+ReadLE32(ConstBuffer<uint8_t> &src, uint32_t &value_r) noexcept
+{
+	if (src.size < 4)
+		return false;
+
+	uint32_t value;
+	memcpy(&value, src.data, sizeof(value));
+	value_r = FromLE32(value);
+	src.skip_front(4);
+	return true;
+}
+
+static StringView
+ReadString(ConstBuffer<uint8_t> &src) noexcept
+{
+	uint32_t length;
+	if (!ReadLE32(src, length) || src.size < length)
+		return nullptr;
+
+	StringView result((const char *)src.data, length);
+	src.skip_front(length);
+	return result;
+}
+
+bool
+SplitVorbisCommentBlock(ConstBuffer<void> _src,
+			std::vector<StringView> &dest)
+{
+	auto src = ConstBuffer<uint8_t>::FromVoid(_src);
+
+	/* vendor string */
+	if (ReadString(src).IsNull())
+		return false;
+
+	uint32_t n;
+	if (!ReadLE32(src, n) || n > src.size / 4)
+		return false;
+
+	dest.reserve(dest.size() + n);
+
+	while (n-- > 0) {
+		const auto s = ReadString(src);
+		if (s.IsNull())
+			return false;
+
+		dest.push_back(s);
+	}
+
+	return true;
+}
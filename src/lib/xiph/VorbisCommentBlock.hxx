@@ -0,0 +1,42 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_VORBIS_COMMENT_BLOCK_HXX
+#define MPD_VORBIS_COMMENT_BLOCK_HXX
+
+#include <vector>
+
+struct StringView;
+template<typename T> struct ConstBuffer;
+
+/**
+ * Split a raw Vorbis comment block (the vendor string, the number of
+ * comments and the length-prefixed comments, as found in FLAC's
+ * VORBIS_COMMENT block and in the Vorbis comment header after the
+ * packet type) into its comments.  The resulting #StringView
+ * instances point into the source buffer.
+ *
+ * @return false if the block is malformed
+ */
+bool
+SplitVorbisCommentBlock(ConstBuffer<void> src,
+			std::vector<StringView> &dest);
+
+#endif
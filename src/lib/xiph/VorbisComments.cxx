@@ -63,8 +63,8 @@ VorbisCommentToReplayGain(ReplayGainInfo &rgi,
 	return found;
 }
 
-static void
-vorbis_scan_comment(StringView comment, TagHandler &handler) noexcept
+void
+VorbisCommentScan(StringView comment, TagHandler &handler) noexcept
 {
 	const auto picture_b64 = handler.WantPicture()
 		? GetVorbisCommentValue(comment, "METADATA_BLOCK_PICTURE")
@@ -79,7 +79,7 @@ void
 VorbisCommentScan(const vorbis_comment &vc, TagHandler &handler) noexcept
 {
 	ForEachUserComment(vc, [&](StringView s){
-		vorbis_scan_comment(s, handler);
+		VorbisCommentScan(s, handler);
 	});
 }
 
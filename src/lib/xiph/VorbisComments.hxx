@@ -23,6 +23,7 @@
 #include <memory>
 
 struct vorbis_comment;
+struct StringView;
 struct ReplayGainInfo;
 class TagHandler;
 struct Tag;
@@ -31,6 +32,13 @@ bool
 VorbisCommentToReplayGain(ReplayGainInfo &rgi,
 			  const vorbis_comment &vc) noexcept;
 
+/**
+ * Scan one "NAME=value" comment, including embedded pictures
+ * ("METADATA_BLOCK_PICTURE").
+ */
+void
+VorbisCommentScan(StringView comment, TagHandler &handler) noexcept;
+
 void
 VorbisCommentScan(const vorbis_comment &vc, TagHandler &handler) noexcept;
 
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2014-2018 Max Kellermann <max.kellermann@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the
+ * distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Deflate.hxx"
+#include "Error.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/WritableBuffer.hxx"
+
+ZlibDeflate::ZlibDeflate(int level)
+{
+	z.next_in = nullptr;
+	z.avail_in = 0;
+	z.zalloc = Z_NULL;
+	z.zfree = Z_NULL;
+	z.opaque = Z_NULL;
+
+	int result = deflateInit(&z, level);
+	if (result != Z_OK)
+		throw ZlibError(result);
+}
+
+ZlibDeflate::~ZlibDeflate() noexcept
+{
+	deflateEnd(&z);
+}
+
+size_t
+ZlibDeflate::Deflate(ConstBuffer<void> &input, WritableBuffer<void> output,
+		     bool sync) noexcept
+{
+	/* zlib's API requires non-const input pointer */
+	z.next_in = (Bytef *)const_cast<void *>(input.data);
+	z.avail_in = input.size;
+	z.next_out = (Bytef *)output.data;
+	z.avail_out = output.size;
+
+	/* the only possible error is Z_BUF_ERROR ("no progress"),
+	   which is harmless */
+	deflate(&z, sync ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+
+	input.data = z.next_in;
+	input.size = z.avail_in;
+	return output.size - z.avail_out;
+}
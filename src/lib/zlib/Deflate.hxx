@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2014-2018 Max Kellermann <max.kellermann@gmail.com>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the
+ * distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * FOUNDATION OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ZLIB_DEFLATE_HXX
+#define ZLIB_DEFLATE_HXX
+
+#include <zlib.h>
+
+#include <cstddef>
+
+template<typename T> struct ConstBuffer;
+template<typename T> struct WritableBuffer;
+
+/**
+ * A zlib "deflate" stream producing the "zlib" format, suitable for
+ * compressing a stream incrementally.
+ */
+class ZlibDeflate {
+	z_stream z;
+
+public:
+	/**
+	 * Throws #ZlibError on error.
+	 */
+	explicit ZlibDeflate(int level=Z_DEFAULT_COMPRESSION);
+
+	~ZlibDeflate() noexcept;
+
+	ZlibDeflate(const ZlibDeflate &) = delete;
+	ZlibDeflate &operator=(const ZlibDeflate &) = delete;
+
+	/**
+	 * Compress data from the input buffer into the output
+	 * buffer.  Consumed data is removed from the input buffer.
+	 *
+	 * @param sync if true, then all pending output is flushed
+	 * (Z_SYNC_FLUSH); the caller must repeat the call until it
+	 * returns less than the size of the output buffer
+	 * @return the number of bytes written to the output buffer
+	 */
+	size_t Deflate(ConstBuffer<void> &input, WritableBuffer<void> output,
+		       bool sync) noexcept;
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include "Control.hxx"
 #include "Filtered.hxx"
 #include "Client.hxx"
+#include "WorkerPool.hxx"
 #include "mixer/MixerControl.hxx"
 #include "config/Block.hxx"
 #include "Log.hxx"
@@ -31,10 +32,12 @@
 static constexpr PeriodClock::Duration REOPEN_AFTER = std::chrono::seconds(10);
 
 AudioOutputControl::AudioOutputControl(std::unique_ptr<FilteredAudioOutput> _output,
-				       AudioOutputClient &_client) noexcept
+				       AudioOutputClient &_client,
+				       OutputWorkerPool *_worker_pool) noexcept
 	:output(std::move(_output)),
 	 name(output->GetName()),
 	 client(_client),
+	 worker_pool(_worker_pool),
 	 thread(BIND_THIS_METHOD(Task))
 {
 }
@@ -165,7 +168,7 @@ AudioOutputControl::CommandAsync(Command cmd) noexcept
 	assert(IsCommandFinished());
 
 	command = cmd;
-	wake_cond.notify_one();
+	WakeThread();
 }
 
 void
@@ -189,7 +192,7 @@ AudioOutputControl::EnableAsync()
 	if (!output)
 		return;
 
-	if (!thread.IsDefined()) {
+	if (!IsThreadDefined()) {
 		if (!output->SupportsEnableDisable()) {
 			/* don't bother to start the thread now if the
 			   device doesn't even have a enable() method;
@@ -210,7 +213,7 @@ AudioOutputControl::DisableAsync() noexcept
 	if (!output)
 		return;
 
-	if (!thread.IsDefined()) {
+	if (!IsThreadDefined()) {
 		if (!output->SupportsEnableDisable())
 			really_enabled = false;
 		else
@@ -258,7 +261,7 @@ AudioOutputControl::Open(std::unique_lock<Mutex> &lock,
 	request.audio_format = audio_format;
 	request.pipe = &mp;
 
-	if (!thread.IsDefined()) {
+	if (!IsThreadDefined()) {
 		try {
 			StartThread();
 		} catch (...) {
@@ -346,7 +349,7 @@ AudioOutputControl::LockPlay() noexcept
 
 	if (IsOpen() && !in_playback_loop && !woken_for_play) {
 		woken_for_play = true;
-		wake_cond.notify_one();
+		WakeThread();
 	}
 }
 
@@ -394,7 +397,7 @@ AudioOutputControl::LockAllowPlay() noexcept
 
 	allow_play = true;
 	if (IsOpen())
-		wake_cond.notify_one();
+		WakeThread();
 }
 
 void
@@ -433,12 +436,10 @@ AudioOutputControl::LockCloseWait() noexcept
 void
 AudioOutputControl::BeginDestroy() noexcept
 {
-	if (thread.IsDefined()) {
-		const std::lock_guard<Mutex> protect(mutex);
-		if (!killed) {
-			killed = true;
-			CommandAsync(Command::KILL);
-		}
+	const std::lock_guard<Mutex> protect(mutex);
+	if (IsThreadDefined() && !killed) {
+		killed = true;
+		CommandAsync(Command::KILL);
 	}
 }
 
@@ -450,5 +451,28 @@ AudioOutputControl::StopThread() noexcept
 	if (thread.IsDefined())
 		thread.Join();
 
+	std::unique_lock<Mutex> lock(mutex);
+	if (pooled) {
+		/* there is no thread to join; wait for the worker
+		   thread to finish the KILL command and unregister */
+		WaitForCommand(lock);
+
+		{
+			const ScopeUnlock unlock(mutex);
+			worker_pool->Remove(*this);
+		}
+
+		pooled = false;
+	}
+
 	assert(IsCommandFinished());
 }
+
+void
+AudioOutputControl::WakeThread() noexcept
+{
+	if (pooled)
+		worker_pool->Wake(*this);
+	else
+		wake_cond.notify_one();
+}
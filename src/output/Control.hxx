@@ -28,6 +28,7 @@
 #include "system/PeriodClock.hxx"
 #include "util/Compiler.h"
 
+#include <chrono>
 #include <cstdint>
 #include <exception>
 #include <map>
@@ -41,6 +42,7 @@ struct ConfigBlock;
 class MusicPipe;
 class Mixer;
 class AudioOutputClient;
+class OutputWorkerPool;
 
 /**
  * Controller for an #AudioOutput and its output thread.
@@ -61,6 +63,13 @@ class AudioOutputControl {
 	 */
 	AudioOutputClient &client;
 
+	/**
+	 * If not nullptr, then outputs which support it (see
+	 * FilteredAudioOutput::CanShareThread()) are run by this
+	 * pool instead of a dedicated thread.
+	 */
+	OutputWorkerPool *const worker_pool;
+
 	/**
 	 * Source of audio data.
 	 */
@@ -87,6 +96,21 @@ class AudioOutputControl {
 	 */
 	Thread thread;
 
+	/**
+	 * Is this output being run by the #worker_pool instead of
+	 * #thread?
+	 *
+	 * Protected by #mutex.
+	 */
+	bool pooled = false;
+
+	/**
+	 * The delay requested by PlayChunk() in #pooled mode instead
+	 * of blocking the worker thread.
+	 */
+	std::chrono::steady_clock::duration pool_delay =
+		std::chrono::steady_clock::duration::zero();
+
 	/**
 	 * This condition object wakes up the output thread after
 	 * #command has been set.
@@ -234,7 +258,8 @@ public:
 	mutable Mutex mutex;
 
 	AudioOutputControl(std::unique_ptr<FilteredAudioOutput> _output,
-			   AudioOutputClient &_client) noexcept;
+			   AudioOutputClient &_client,
+			   OutputWorkerPool *_worker_pool=nullptr) noexcept;
 
 	~AudioOutputControl() noexcept;
 
@@ -314,6 +339,26 @@ public:
 
 	void StartThread();
 
+	/**
+	 * Is the output thread running (or is this output registered
+	 * in the #worker_pool)?
+	 *
+	 * Caller must lock the mutex.
+	 */
+	bool IsThreadDefined() const noexcept {
+		return pooled || thread.IsDefined();
+	}
+
+	/**
+	 * Perform all pending work.  This is called by the
+	 * #OutputWorkerPool in #pooled mode instead of Task().
+	 *
+	 * @return the duration after which this method shall be
+	 * called again, or duration::max() to wait for the next
+	 * wakeup
+	 */
+	std::chrono::steady_clock::duration RunPooled() noexcept;
+
 	/**
 	 * Caller must lock the mutex.
 	 */
@@ -570,6 +615,18 @@ private:
 	 */
 	bool InternalPlay(std::unique_lock<Mutex> &lock) noexcept;
 
+	/**
+	 * Runs inside the OutputThread.
+	 * Caller must lock the mutex.
+	 */
+	void InternalBeginPause() noexcept;
+
+	/**
+	 * Runs inside the OutputThread.
+	 * Caller must lock the mutex.
+	 */
+	void InternalEndPause() noexcept;
+
 	/**
 	 * Runs inside the OutputThread.
 	 * Caller must lock the mutex.
@@ -586,10 +643,29 @@ private:
 
 	void StopThread() noexcept;
 
+	/**
+	 * Wake up the OutputThread (or schedule this output in the
+	 * #worker_pool).
+	 *
+	 * Caller must lock the mutex.
+	 */
+	void WakeThread() noexcept;
+
 	/**
 	 * The OutputThread.
 	 */
 	void Task() noexcept;
+
+	/**
+	 * The #pooled counterpart of Task(): like one iteration of
+	 * its loop, but never blocks.
+	 *
+	 * Caller must lock the mutex.
+	 *
+	 * @return see RunPooled()
+	 */
+	std::chrono::steady_clock::duration
+	InternalRunPooled(std::unique_lock<Mutex> &lock) noexcept;
 };
 
 #endif
@@ -39,6 +39,12 @@ FilteredAudioOutput::SupportsPause() const noexcept
 	return output->SupportsPause();
 }
 
+bool
+FilteredAudioOutput::CanShareThread() const noexcept
+{
+	return output->CanShareThread();
+}
+
 std::map<std::string, std::string>
 FilteredAudioOutput::GetAttributes() const noexcept
 {
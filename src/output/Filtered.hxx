@@ -170,6 +170,12 @@ public:
 	gcc_pure
 	bool SupportsPause() const noexcept;
 
+	/**
+	 * May this output be run by the #OutputWorkerPool?
+	 */
+	gcc_pure
+	bool CanShareThread() const noexcept;
+
 	std::map<std::string, std::string> GetAttributes() const noexcept;
 	void SetAttribute(std::string &&name, std::string &&value);
 
@@ -40,6 +40,14 @@ protected:
 	 */
 	static constexpr unsigned FLAG_NEED_FULLY_DEFINED_AUDIO_FORMAT = 0x4;
 
+	/**
+	 * This output's Play() method never blocks for a long time
+	 * (it either throttles with Delay() or writes to a buffer),
+	 * so it may be run by the #OutputWorkerPool instead of a
+	 * dedicated thread.
+	 */
+	static constexpr unsigned FLAG_SHARED_THREAD = 0x8;
+
 public:
 	explicit AudioOutput(unsigned _flags):flags(_flags) {}
 	virtual ~AudioOutput() = default;
@@ -59,6 +67,10 @@ public:
 		return flags & FLAG_NEED_FULLY_DEFINED_AUDIO_FORMAT;
 	}
 
+	bool CanShareThread() const {
+		return flags & FLAG_SHARED_THREAD;
+	}
+
 	/**
 	 * Returns a map of runtime attributes.
 	 *
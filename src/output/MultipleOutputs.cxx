@@ -36,8 +36,10 @@
 #include <string.h>
 
 MultipleOutputs::MultipleOutputs(AudioOutputClient &_client,
-				 MixerListener &_mixer_listener) noexcept
-	:client(_client), mixer_listener(_mixer_listener)
+				 MixerListener &_mixer_listener,
+				 OutputWorkerPool *_worker_pool) noexcept
+	:client(_client), mixer_listener(_mixer_listener),
+	 worker_pool(_worker_pool)
 {
 }
 
@@ -72,14 +74,18 @@ static std::unique_ptr<AudioOutputControl>
 LoadOutputControl(EventLoop &event_loop,
 		  const ReplayGainConfig &replay_gain_config,
 		  MixerListener &mixer_listener,
-		  AudioOutputClient &client, const ConfigBlock &block,
+		  AudioOutputClient &client,
+		  OutputWorkerPool *worker_pool,
+		  const ConfigBlock &block,
 		  const AudioOutputDefaults &defaults,
 		  FilterFactory *filter_factory)
 {
 	auto output = LoadOutput(event_loop, replay_gain_config,
 				 mixer_listener,
 				 block, defaults, filter_factory);
-	auto control = std::make_unique<AudioOutputControl>(std::move(output), client);
+	auto control = std::make_unique<AudioOutputControl>(std::move(output),
+							    client,
+							    worker_pool);
 	control->Configure(block);
 	return control;
 }
@@ -97,7 +103,8 @@ MultipleOutputs::Configure(EventLoop &event_loop,
 		auto output = LoadOutputControl(event_loop,
 						replay_gain_config,
 						mixer_listener,
-						client, block, defaults,
+						client, worker_pool,
+						block, defaults,
 						&filter_factory);
 		if (HasName(output->GetName()))
 			throw FormatRuntimeError("output devices with identical "
@@ -112,7 +119,8 @@ MultipleOutputs::Configure(EventLoop &event_loop,
 		outputs.emplace_back(LoadOutputControl(event_loop,
 						       replay_gain_config,
 						       mixer_listener,
-						       client, empty, defaults,
+						       client, worker_pool,
+						       empty, defaults,
 						       nullptr));
 	}
 }
@@ -133,7 +141,8 @@ MultipleOutputs::Add(std::unique_ptr<FilteredAudioOutput> output,
 {
 	// TODO: this operation needs to be protected with a mutex
 	outputs.emplace_back(std::make_unique<AudioOutputControl>(std::move(output),
-								  client));
+								  client,
+								  worker_pool));
 
 	outputs.back()->LockSetEnabled(enable);
 
@@ -290,7 +299,7 @@ MultipleOutputs::CheckPipe() noexcept
 				ao->LockClearTailChunk(*chunk);
 
 		/* remove the chunk from the pipe */
-		const auto shifted = pipe->Shift();
+		auto shifted = pipe->Shift();
 		assert(shifted.get() == chunk);
 
 		if (is_tail)
@@ -299,8 +308,7 @@ MultipleOutputs::CheckPipe() noexcept
 			for (const auto &ao : outputs)
 				ao->LockAllowPlay();
 
-		/* chunk is automatically returned to the buffer by
-		   ~MusicChunkPtr() */
+		AddHistory(std::move(shifted));
 	}
 
 	return 0;
@@ -341,6 +349,8 @@ MultipleOutputs::Cancel() noexcept
 	if (pipe != nullptr)
 		pipe->Clear();
 
+	ClearHistory();
+
 	/* the audio outputs are now waiting for a signal, to
 	   synchronize the cleared music pipe */
 
@@ -351,6 +361,85 @@ MultipleOutputs::Cancel() noexcept
 	elapsed_time = SignedSongTime::Negative();
 }
 
+void
+MultipleOutputs::CancelToPipe(MusicPipe &dest) noexcept
+{
+	for (const auto &ao : outputs)
+		ao->LockCancelAsync();
+
+	WaitAll();
+
+	/* move the history and the chunks which have not been played
+	   yet to the destination pipe, in this order */
+
+	if (history != nullptr)
+		dest.Prepend(*history);
+
+	if (pipe != nullptr) {
+		/* skip chunks of the previous song */
+		for (; history_skip > 0; --history_skip)
+			pipe->Shift();
+
+		while (auto chunk = pipe->Shift())
+			dest.Push(std::move(chunk));
+	}
+
+	history_skip = 0;
+
+	AllowPlay();
+
+	elapsed_time = SignedSongTime::Negative();
+}
+
+void
+MultipleOutputs::AddHistory(MusicChunkPtr chunk) noexcept
+{
+	if (history_skip > 0) {
+		/* this chunk belongs to the previous song */
+		--history_skip;
+		return;
+	}
+
+	if (history == nullptr || history_size == 0 ||
+	    /* cross-fading chunks reference the next song, and
+	       tag-only chunks are useless for seeking */
+	    chunk->other != nullptr || chunk->length == 0)
+		/* chunk is automatically returned to the buffer by
+		   ~MusicChunkPtr() */
+		return;
+
+	history->Push(std::move(chunk));
+
+	while (history->GetSize() > history_size)
+		history->Shift();
+}
+
+void
+MultipleOutputs::ClearHistory() noexcept
+{
+	history_skip = 0;
+
+	if (history != nullptr)
+		history->Clear();
+}
+
+void
+MultipleOutputs::SetHistorySize(unsigned n) noexcept
+{
+	history_size = n;
+
+	if (n == 0) {
+		history.reset();
+		return;
+	}
+
+	if (history == nullptr)
+		history = std::make_unique<MusicPipe>();
+
+	while (history->GetSize() > history_size)
+		history->Shift();
+}
+
 void
 MultipleOutputs::Close() noexcept
 {
@@ -358,6 +447,7 @@ MultipleOutputs::Close() noexcept
 		ao->LockCloseWait();
 
 	pipe.reset();
+	ClearHistory();
 
 	input_audio_format.Clear();
 
@@ -371,6 +461,7 @@ MultipleOutputs::Release() noexcept
 		ao->LockRelease();
 
 	pipe.reset();
+	ClearHistory();
 
 	input_audio_format.Clear();
 
@@ -383,4 +474,10 @@ MultipleOutputs::SongBorder() noexcept
 	/* clear the elapsed_time pointer at the beginning of a new
 	   song */
 	elapsed_time = SignedSongTime::zero();
+
+	/* the history must contain only chunks of the current
+	   song */
+	ClearHistory();
+	if (pipe != nullptr)
+		history_skip = pipe->GetSize();
 }
@@ -37,6 +37,7 @@ class MusicPipe;
 class EventLoop;
 class MixerListener;
 class AudioOutputClient;
+class OutputWorkerPool;
 struct ConfigData;
 struct ReplayGainConfig;
 
@@ -49,6 +50,12 @@ class MultipleOutputs final : public PlayerOutputs {
 
 	MixerListener &mixer_listener;
 
+	/**
+	 * Passed to all #AudioOutputControl instances; may be
+	 * nullptr.
+	 */
+	OutputWorkerPool *const worker_pool;
+
 	std::vector<std::unique_ptr<AudioOutputControl>> outputs;
 
 	AudioFormat input_audio_format = AudioFormat::Undefined();
@@ -59,6 +66,25 @@ class MultipleOutputs final : public PlayerOutputs {
 	 */
 	std::unique_ptr<MusicPipe> pipe;
 
+	/**
+	 * Chunks of the current song which have already been played
+	 * by all audio outputs, kept for seeking backwards without
+	 * restarting the decoder.  Allocated by SetHistorySize().
+	 */
+	std::unique_ptr<MusicPipe> history;
+
+	/**
+	 * The maximum number of chunks in #history.
+	 */
+	unsigned history_size = 0;
+
+	/**
+	 * The number of chunks at the head of #pipe which belong to
+	 * the previous song; they must not be added to #history.
+	 * Set by SongBorder().
+	 */
+	unsigned history_skip = 0;
+
 	/**
 	 * The "elapsed_time" stamp of the most recently finished
 	 * chunk.
@@ -71,7 +97,8 @@ public:
 	 * initialize them.
 	 */
 	MultipleOutputs(AudioOutputClient &_client,
-			MixerListener &_mixer_listener) noexcept;
+			MixerListener &_mixer_listener,
+			OutputWorkerPool *_worker_pool=nullptr) noexcept;
 	~MultipleOutputs() noexcept;
 
 	void Configure(EventLoop &event_loop,
@@ -195,6 +222,14 @@ private:
 	 */
 	bool IsChunkConsumed(const MusicChunk *chunk) const noexcept;
 
+	/**
+	 * Add a consumed chunk to #history (if enabled), or return it
+	 * to the #MusicBuffer.
+	 */
+	void AddHistory(MusicChunkPtr chunk) noexcept;
+
+	void ClearHistory() noexcept;
+
 	/* virtual methods from class PlayerOutputs */
 	void EnableDisable() override;
 	void Open(const AudioFormat audio_format) override;
@@ -205,6 +240,8 @@ private:
 	void Pause() noexcept override;
 	void Drain() noexcept override;
 	void Cancel() noexcept override;
+	void CancelToPipe(MusicPipe &dest) noexcept override;
+	void SetHistorySize(unsigned n) noexcept override;
 	void SongBorder() noexcept override;
 	SignedSongTime GetElapsedTime() const noexcept override {
 		return elapsed_time;
@@ -21,6 +21,7 @@
 #include "Filtered.hxx"
 #include "Client.hxx"
 #include "Domain.hxx"
+#include "WorkerPool.hxx"
 #include "thread/Util.hxx"
 #include "thread/Slack.hxx"
 #include "thread/Name.hxx"
@@ -257,7 +258,13 @@ AudioOutputControl::PlayChunk(std::unique_lock<Mutex> &lock) noexcept
 
 		if (skip_delay)
 			skip_delay = false;
-		else if (!WaitForDelay(lock))
+		else if (pooled) {
+			/* don't block the shared worker thread; let
+			   the OutputWorkerPool call us again later */
+			pool_delay = output->Delay();
+			if (pool_delay > std::chrono::steady_clock::duration::zero())
+				break;
+		} else if (!WaitForDelay(lock))
 			break;
 
 		size_t nbytes;
@@ -304,6 +311,11 @@ AudioOutputControl::InternalPlay(std::unique_lock<Mutex> &lock) noexcept
 			return true;
 
 		if (++n >= 64) {
+			if (pooled)
+				/* give the other outputs sharing this
+				   worker thread a chance */
+				break;
+
 			/* wake up the player every now and then to
 			   give it a chance to refill the pipe before
 			   it runs empty */
@@ -314,6 +326,9 @@ AudioOutputControl::InternalPlay(std::unique_lock<Mutex> &lock) noexcept
 
 		if (!PlayChunk(lock))
 			break;
+
+		if (pool_delay > std::chrono::steady_clock::duration::zero())
+			break;
 	} while (FillSourceOrClose());
 
 	const ScopeUnlock unlock(mutex);
@@ -323,7 +338,7 @@ AudioOutputControl::InternalPlay(std::unique_lock<Mutex> &lock) noexcept
 }
 
 inline void
-AudioOutputControl::InternalPause(std::unique_lock<Mutex> &lock) noexcept
+AudioOutputControl::InternalBeginPause() noexcept
 {
 	{
 		const ScopeUnlock unlock(mutex);
@@ -333,6 +348,25 @@ AudioOutputControl::InternalPause(std::unique_lock<Mutex> &lock) noexcept
 	pause = true;
 
 	CommandFinished();
+}
+
+inline void
+AudioOutputControl::InternalEndPause() noexcept
+{
+	pause = false;
+
+	{
+		const ScopeUnlock unlock(mutex);
+		output->EndPause();
+	}
+
+	skip_delay = true;
+}
+
+inline void
+AudioOutputControl::InternalPause(std::unique_lock<Mutex> &lock) noexcept
+{
+	InternalBeginPause();
 
 	do {
 		if (!WaitForDelay(lock))
@@ -350,14 +384,7 @@ AudioOutputControl::InternalPause(std::unique_lock<Mutex> &lock) noexcept
 		}
 	} while (command == Command::NONE);
 
-	pause = false;
-
-	{
-		const ScopeUnlock unlock(mutex);
-		output->EndPause();
-	}
-
-	skip_delay = true;
+	InternalEndPause();
 }
 
 static void
@@ -522,6 +549,130 @@ AudioOutputControl::Task() noexcept
 	}
 }
 
+inline std::chrono::steady_clock::duration
+AudioOutputControl::InternalRunPooled(std::unique_lock<Mutex> &lock) noexcept
+{
+	using Duration = std::chrono::steady_clock::duration;
+
+	pool_delay = Duration::zero();
+
+	while (true) {
+		if (pause) {
+			/* one iteration of the InternalPause() loop */
+
+			if (command == Command::NONE) {
+				const auto delay = output->Delay();
+				if (delay > Duration::zero())
+					return delay;
+
+				bool success;
+				{
+					const ScopeUnlock unlock(mutex);
+					success = output->IteratePause();
+				}
+
+				if (success)
+					return Duration::zero();
+
+				InternalClose(false);
+			}
+
+			InternalEndPause();
+		}
+
+		switch (command) {
+		case Command::NONE:
+			break;
+
+		case Command::ENABLE:
+			InternalEnable();
+			CommandFinished();
+			break;
+
+		case Command::DISABLE:
+			InternalDisable();
+			CommandFinished();
+			break;
+
+		case Command::OPEN:
+			InternalOpen(request.audio_format, *request.pipe);
+			CommandFinished();
+			break;
+
+		case Command::CLOSE:
+			InternalCheckClose(false);
+			CommandFinished();
+			break;
+
+		case Command::PAUSE:
+			if (!open) {
+				CommandFinished();
+				break;
+			}
+
+			InternalBeginPause();
+			continue;
+
+		case Command::RELEASE:
+			if (!open) {
+				CommandFinished();
+				break;
+			}
+
+			if (always_on) {
+				source.Cancel();
+				InternalBeginPause();
+			} else {
+				InternalClose(false);
+				CommandFinished();
+			}
+
+			continue;
+
+		case Command::DRAIN:
+			if (open)
+				InternalDrain();
+
+			CommandFinished();
+			continue;
+
+		case Command::CANCEL:
+			source.Cancel();
+
+			if (open) {
+				const ScopeUnlock unlock(mutex);
+				output->Cancel();
+			}
+
+			CommandFinished();
+			continue;
+
+		case Command::KILL:
+			InternalDisable();
+			source.Cancel();
+			CommandFinished();
+			return Duration::max();
+		}
+
+		if (open && allow_play && InternalPlay(lock))
+			/* there may be more chunks in the pipe, or
+			   PlayChunk() has requested a delay */
+			return pool_delay;
+
+		if (command == Command::NONE) {
+			woken_for_play = false;
+			return Duration::max();
+		}
+	}
+}
+
+std::chrono::steady_clock::duration
+AudioOutputControl::RunPooled() noexcept
+{
+	std::unique_lock<Mutex> lock(mutex);
+	return InternalRunPooled(lock);
+}
+
 void
 AudioOutputControl::StartThread()
 {
@@ -529,6 +680,12 @@ AudioOutputControl::StartThread()
 
 	killed = false;
 
+	if (worker_pool != nullptr && output->CanShareThread()) {
+		pooled = true;
+		worker_pool->Add(*this);
+		return;
+	}
+
 	const ScopeUnlock unlock(mutex);
 	thread.Start();
 }
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "WorkerPool.hxx"
+#include "Control.hxx"
+#include "thread/Name.hxx"
+#include "thread/Slack.hxx"
+
+#include <algorithm>
+#include <cassert>
+
+OutputWorkerPool::OutputWorkerPool(unsigned n_threads)
+{
+	assert(n_threads > 0);
+
+	try {
+		for (unsigned i = 0; i < n_threads; ++i) {
+			threads.emplace_back(BIND_THIS_METHOD(Run));
+			threads.back().Start();
+		}
+	} catch (...) {
+		threads.pop_back();
+		Stop();
+		throw;
+	}
+}
+
+OutputWorkerPool::~OutputWorkerPool() noexcept
+{
+	Stop();
+}
+
+void
+OutputWorkerPool::Stop() noexcept
+{
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		quit = true;
+		cond.notify_all();
+	}
+
+	for (auto &i : threads)
+		i.Join();
+
+	threads.clear();
+
+	assert(entries.empty());
+}
+
+void
+OutputWorkerPool::Add(AudioOutputControl &control) noexcept
+{
+	const std::lock_guard<Mutex> lock(mutex);
+	entries.emplace(&control, Entry());
+}
+
+void
+OutputWorkerPool::Remove(AudioOutputControl &control) noexcept
+{
+	std::unique_lock<Mutex> lock(mutex);
+
+	auto i = entries.find(&control);
+	assert(i != entries.end());
+
+	done_cond.wait(lock, [i]{ return !i->second.running; });
+
+	if (i->second.queued)
+		ready.erase(std::find(ready.begin(), ready.end(), &control));
+
+	entries.erase(i);
+}
+
+inline void
+OutputWorkerPool::Enqueue(AudioOutputControl &control, Entry &entry) noexcept
+{
+	if (entry.running) {
+		/* the worker thread which is currently running
+		   this output will enqueue it again when it's
+		   done */
+		entry.again = true;
+		return;
+	}
+
+	if (entry.queued)
+		return;
+
+	entry.queued = true;
+	ready.push_back(&control);
+	cond.notify_one();
+}
+
+void
+OutputWorkerPool::Wake(AudioOutputControl &control) noexcept
+{
+	const std::lock_guard<Mutex> lock(mutex);
+
+	auto i = entries.find(&control);
+	if (i != entries.end())
+		Enqueue(control, i->second);
+}
+
+inline std::chrono::steady_clock::time_point
+OutputWorkerPool::CheckDeadlines() noexcept
+{
+	const auto now = std::chrono::steady_clock::now();
+	auto next = std::chrono::steady_clock::time_point::max();
+
+	for (auto &[control, entry] : entries) {
+		if (entry.deadline <= now) {
+			entry.deadline = std::chrono::steady_clock::time_point::max();
+			Enqueue(*control, entry);
+		} else if (entry.deadline < next)
+			next = entry.deadline;
+	}
+
+	return next;
+}
+
+void
+OutputWorkerPool::Run() noexcept
+{
+	SetThreadName("output_pool");
+	SetThreadTimerSlack(std::chrono::microseconds(100));
+
+	std::unique_lock<Mutex> lock(mutex);
+
+	while (!quit) {
+		const auto next = CheckDeadlines();
+
+		if (ready.empty()) {
+			if (next == std::chrono::steady_clock::time_point::max())
+				cond.wait(lock);
+			else
+				cond.wait_until(lock, next);
+			continue;
+		}
+
+		auto &control = *ready.front();
+		ready.pop_front();
+
+		auto &entry = entries.find(&control)->second;
+		assert(entry.queued);
+		assert(!entry.running);
+
+		entry.queued = false;
+		entry.running = true;
+		entry.again = false;
+		entry.deadline = std::chrono::steady_clock::time_point::max();
+
+		std::chrono::steady_clock::duration delay;
+
+		{
+			const ScopeUnlock unlock(mutex);
+			delay = control.RunPooled();
+		}
+
+		entry.running = false;
+
+		if (entry.again ||
+		    delay <= std::chrono::steady_clock::duration::zero())
+			Enqueue(control, entry);
+		else if (delay != std::chrono::steady_clock::duration::max())
+			entry.deadline = std::chrono::steady_clock::now() + delay;
+
+		done_cond.notify_all();
+	}
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_OUTPUT_WORKER_POOL_HXX
+#define MPD_OUTPUT_WORKER_POOL_HXX
+
+#include "thread/Thread.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+
+#include <chrono>
+#include <deque>
+#include <list>
+#include <map>
+
+class AudioOutputControl;
+
+/**
+ * A small set of threads which is shared by all audio outputs which
+ * don't need a dedicated (real-time) thread, i.e. those whose
+ * AudioOutput::Play() method doesn't block for long (see
+ * AudioOutput::CanShareThread()).
+ *
+ * Instead of blocking on a condition variable, each of these outputs
+ * performs one step of work (AudioOutputControl::RunPooled()) when
+ * it has been woken up with Wake() or when the delay it requested
+ * has expired.
+ */
+class OutputWorkerPool {
+	struct Entry {
+		/**
+		 * When shall this output be run again?  This is
+		 * time_point::max() if it waits for Wake().
+		 */
+		std::chrono::steady_clock::time_point deadline =
+			std::chrono::steady_clock::time_point::max();
+
+		/**
+		 * Is this output in the #ready queue?
+		 */
+		bool queued = false;
+
+		/**
+		 * Is a worker thread currently running this output?
+		 */
+		bool running = false;
+
+		/**
+		 * Has Wake() been called while #running was set?
+		 */
+		bool again = false;
+	};
+
+	Mutex mutex;
+
+	/**
+	 * Wakes up a worker thread after the #ready queue or a
+	 * #Entry::deadline has been modified.
+	 */
+	Cond cond;
+
+	/**
+	 * Signalled after a worker thread has finished running an
+	 * output; Remove() waits for it.
+	 */
+	Cond done_cond;
+
+	std::map<AudioOutputControl *, Entry> entries;
+
+	/**
+	 * Outputs which shall be run as soon as possible.
+	 */
+	std::deque<AudioOutputControl *> ready;
+
+	std::list<Thread> threads;
+
+	bool quit = false;
+
+public:
+	/**
+	 * Throws on error.
+	 */
+	explicit OutputWorkerPool(unsigned n_threads);
+
+	~OutputWorkerPool() noexcept;
+
+	OutputWorkerPool(const OutputWorkerPool &) = delete;
+	OutputWorkerPool &operator=(const OutputWorkerPool &) = delete;
+
+	/**
+	 * Register an output.  It will not be run until Wake() is
+	 * called.
+	 */
+	void Add(AudioOutputControl &control) noexcept;
+
+	/**
+	 * Unregister an output.  If a worker thread is currently
+	 * running it, wait for that to finish.
+	 */
+	void Remove(AudioOutputControl &control) noexcept;
+
+	/**
+	 * Schedule a call to AudioOutputControl::RunPooled().  This
+	 * method is thread-safe, and it may be called while the
+	 * output's mutex is locked.
+	 */
+	void Wake(AudioOutputControl &control) noexcept;
+
+private:
+	void Stop() noexcept;
+
+	/**
+	 * Caller must lock the mutex.
+	 */
+	void Enqueue(AudioOutputControl &control, Entry &entry) noexcept;
+
+	/**
+	 * Move all outputs whose deadline has expired to the #ready
+	 * queue.
+	 *
+	 * Caller must lock the mutex.
+	 *
+	 * @return the earliest deadline which has not yet expired
+	 */
+	std::chrono::steady_clock::time_point CheckDeadlines() noexcept;
+
+	void Run() noexcept;
+};
+
+#endif
@@ -90,6 +90,19 @@ class AlsaOutput final
 	/** libasound's period_time setting (in microseconds) */
 	const unsigned period_time;
 
+	/**
+	 * Shall we try to use SND_PCM_ACCESS_MMAP_INTERLEAVED?
+	 */
+	const bool mmap_setting;
+
+	/**
+	 * Has SND_PCM_ACCESS_MMAP_INTERLEAVED been configured?  Then
+	 * full periods are copied from the #ring_buffer directly
+	 * into the hardware buffer (see WriteRingToMmap()), and
+	 * snd_pcm_mmap_writei() is used instead of snd_pcm_writei().
+	 */
+	bool use_mmap;
+
 	/** the mode flags passed to snd_pcm_open */
 	int mode = 0;
 
@@ -118,6 +131,19 @@ class AlsaOutput final
 	 */
 	snd_pcm_uframes_t period_frames;
 
+	/**
+	 * The size of the hardware buffer, in number of frames.
+	 */
+	snd_pcm_uframes_t buffer_frames;
+
+	/**
+	 * The software start threshold passed to libasound, in
+	 * number of frames.  snd_pcm_mmap_commit() does not start
+	 * the stream by itself, so WriteRingToMmap() compares the
+	 * buffer fill level against this value.
+	 */
+	snd_pcm_uframes_t start_threshold;
+
 	std::chrono::steady_clock::duration effective_period_duration;
 
 	/**
@@ -350,8 +376,11 @@ private:
 		assert(period_buffer.IsFull());
 		assert(period_buffer.GetFrames(out_frame_size) > 0);
 
-		auto frames_written = snd_pcm_writei(pcm, period_buffer.GetHead(),
-						     period_buffer.GetFrames(out_frame_size));
+		auto frames_written = use_mmap
+			? snd_pcm_mmap_writei(pcm, period_buffer.GetHead(),
+					      period_buffer.GetFrames(out_frame_size))
+			: snd_pcm_writei(pcm, period_buffer.GetHead(),
+					 period_buffer.GetFrames(out_frame_size));
 		if (frames_written > 0) {
 			written = true;
 			period_buffer.ConsumeFrames(frames_written,
@@ -361,6 +390,17 @@ private:
 		return frames_written;
 	}
 
+	/**
+	 * Copy one period from the #ring_buffer directly into the
+	 * hardware buffer, bypassing #period_buffer (mmap mode
+	 * only).
+	 *
+	 * @return the number of frames written, 0 if less than one
+	 * period is available in the #ring_buffer, or a negative
+	 * error code
+	 */
+	snd_pcm_sframes_t WriteRingToMmap() noexcept;
+
 	void LockCaughtError() noexcept {
 		period_buffer.Clear();
 
@@ -404,7 +444,8 @@ AlsaOutput::AlsaOutput(EventLoop &_loop, const ConfigBlock &block)
 #endif
 	 buffer_time(block.GetPositiveValue("buffer_time",
 					    MPD_ALSA_BUFFER_TIME_US)),
-	 period_time(block.GetPositiveValue("period_time", 0U))
+	 period_time(block.GetPositiveValue("period_time", 0U)),
+	 mmap_setting(block.GetBlockValue("mmap", false))
 {
 #ifdef SND_PCM_NO_AUTO_RESAMPLE
 	if (!block.GetBlockValue("auto_resample", true))
@@ -529,8 +570,15 @@ AlsaOutput::Setup(AudioFormat &audio_format,
 {
 	const auto hw_result = Alsa::SetupHw(pcm,
 					     buffer_time, period_time,
+					     mmap_setting,
 					     audio_format, params);
 
+	use_mmap = hw_result.mmap;
+	if (mmap_setting && !use_mmap)
+		FormatWarning(alsa_output_domain,
+			      "ALSA device \"%s\" does not support mmap, falling back to snd_pcm_writei()",
+			      GetDevice());
+
 	FormatDebug(alsa_output_domain, "format=%s (%s)",
 		    snd_pcm_format_name(hw_result.format),
 		    snd_pcm_format_description(hw_result.format));
@@ -539,8 +587,9 @@ AlsaOutput::Setup(AudioFormat &audio_format,
 		    (unsigned)hw_result.buffer_size,
 		    (unsigned)hw_result.period_size);
 
-	AlsaSetupSw(pcm, hw_result.buffer_size - hw_result.period_size,
-		    hw_result.period_size);
+	buffer_frames = hw_result.buffer_size;
+	start_threshold = hw_result.buffer_size - hw_result.period_size;
+	AlsaSetupSw(pcm, start_threshold, hw_result.period_size);
 
 	auto alsa_period_size = hw_result.period_size;
 	if (alsa_period_size == 0)
@@ -1005,6 +1054,70 @@ AlsaOutput::Play(const void *chunk, size_t size)
 	return size;
 }
 
+inline snd_pcm_sframes_t
+AlsaOutput::WriteRingToMmap() noexcept
+{
+	assert(use_mmap);
+	assert(period_buffer.IsCleared());
+
+	if (ring_buffer->read_available() < period_frames * out_frame_size)
+		return 0;
+
+	const snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm);
+	if (avail < 0)
+		return avail;
+
+	if (snd_pcm_uframes_t(avail) < period_frames)
+		/* not enough room in the hardware buffer; wait for
+		   the next DispatchSockets() call */
+		return -EAGAIN;
+
+	const snd_pcm_channel_area_t *areas;
+	snd_pcm_uframes_t offset, frames = period_frames;
+	int err = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames);
+	if (err < 0)
+		return err;
+
+	/* with SND_PCM_ACCESS_MMAP_INTERLEAVED, all channels share
+	   one area, and "step" is the size of a frame in bits */
+	auto *dest = (uint8_t *)areas[0].addr
+		+ (areas[0].first + offset * areas[0].step) / 8;
+	const size_t nbytes = ring_buffer->pop(dest, frames * out_frame_size);
+	assert(nbytes == frames * out_frame_size);
+	(void)nbytes;
+
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		/* notify the OutputThread that there is now
+		   room in ring_buffer */
+		cond.notify_one();
+	}
+
+	const auto frames_written = snd_pcm_mmap_commit(pcm, offset, frames);
+	if (frames_written <= 0)
+		return frames_written;
+
+	written = true;
+
+	/* unlike snd_pcm_writei(), snd_pcm_mmap_commit() does not
+	   start the stream when the start threshold is reached; do
+	   it manually, or we'd stay at SND_PCM_STATE_PREPARED
+	   forever */
+	if (snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED) {
+		const snd_pcm_sframes_t new_avail = snd_pcm_avail_update(pcm);
+		if (new_avail < 0)
+			return new_avail;
+
+		if (buffer_frames - snd_pcm_uframes_t(new_avail) >= start_threshold) {
+			err = snd_pcm_start(pcm);
+			if (err < 0)
+				return err;
+		}
+	}
+
+	return frames_written;
+}
+
 std::chrono::steady_clock::duration
 AlsaOutput::PrepareSockets() noexcept
 {
@@ -1057,6 +1170,30 @@ try {
 		}
 	}
 
+	if (use_mmap && period_buffer.IsCleared()) {
+		/* fast path: no partial period is pending, so copy
+		   the next period straight from the ring_buffer into
+		   the hardware buffer */
+		const auto frames_written = WriteRingToMmap();
+		if (frames_written < 0) {
+			if (frames_written == -EAGAIN || frames_written == -EINTR)
+				return;
+
+			if (Recover(frames_written) < 0)
+				throw FormatRuntimeError("ALSA mmap write failed: %s",
+							 snd_strerror(-frames_written));
+
+			return;
+		}
+
+		if (frames_written > 0)
+			return;
+
+		/* less than one period available: fall back to
+		   the period_buffer code below, which knows how to
+		   wait for more data or to generate silence */
+	}
+
 	CopyRingToPeriodBuffer();
 
 	if (!period_buffer.IsFull()) {
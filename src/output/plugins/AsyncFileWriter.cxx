@@ -0,0 +1,160 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "AsyncFileWriter.hxx"
+#include "fs/io/FileOutputStream.hxx"
+#include "thread/Name.hxx"
+#include "Log.hxx"
+
+#include <cassert>
+#include <utility>
+
+AsyncFileWriter::AsyncFileWriter(size_t _max_buffered)
+	:max_buffered(_max_buffered),
+	 thread(BIND_THIS_METHOD(Run))
+{
+	thread.Start();
+}
+
+AsyncFileWriter::~AsyncFileWriter() noexcept
+{
+	{
+		const std::lock_guard<Mutex> lock(mutex);
+		quit = true;
+		cond.notify_one();
+	}
+
+	thread.Join();
+
+	assert(queue.empty());
+}
+
+bool
+AsyncFileWriter::Write(FileOutputStream &file, const void *data, size_t size)
+{
+	const std::lock_guard<Mutex> lock(mutex);
+
+	if (error)
+		std::rethrow_exception(std::exchange(error, nullptr));
+
+	if (size > max_buffered - buffered)
+		return false;
+
+	if (queue.empty() || queue.back().file != &file ||
+	    queue.back().finish != Job::Finish::NONE)
+		queue.emplace_back(file);
+
+	auto &dest = queue.back().data;
+	const auto *p = (const uint8_t *)data;
+	dest.insert(dest.end(), p, p + size);
+	buffered += size;
+
+	cond.notify_one();
+	return true;
+}
+
+void
+AsyncFileWriter::Finish(std::unique_ptr<FileOutputStream> file,
+			Job::Finish finish) noexcept
+{
+	assert(file);
+	assert(finish != Job::Finish::NONE);
+
+	const std::lock_guard<Mutex> lock(mutex);
+
+	queue.emplace_back(*file.release());
+	queue.back().finish = finish;
+
+	cond.notify_one();
+}
+
+inline void
+AsyncFileWriter::RunJob(Job &job) noexcept
+{
+	std::exception_ptr new_error;
+
+	{
+		const ScopeUnlock unlock(mutex);
+
+		if (job.file != failed_file && !job.data.empty()) {
+			try {
+				job.file->Write(job.data.data(),
+						job.data.size());
+			} catch (...) {
+				new_error = std::current_exception();
+				failed_file = job.file;
+			}
+		}
+
+		if (job.finish != Job::Finish::NONE) {
+			/* the destructor deletes the file unless it
+			   has been committed */
+			std::unique_ptr<FileOutputStream> file(job.file);
+
+			if (file.get() == failed_file)
+				/* don't commit a file with missing
+				   data */
+				failed_file = nullptr;
+			else if (job.finish == Job::Finish::COMMIT) {
+				try {
+					file->Commit();
+				} catch (...) {
+					LogError(std::current_exception());
+				}
+			}
+		}
+	}
+
+	assert(buffered >= job.data.size());
+	buffered -= job.data.size();
+
+	if (new_error) {
+		if (job.finish != Job::Finish::NONE || error)
+			/* nobody will see this error, because the
+			   file is already finished (or because
+			   there's already a pending error) */
+			LogError(new_error);
+		else
+			error = std::move(new_error);
+	}
+}
+
+void
+AsyncFileWriter::Run() noexcept
+{
+	SetThreadName("file_writer");
+
+	std::unique_lock<Mutex> lock(mutex);
+
+	while (true) {
+		if (queue.empty()) {
+			if (quit)
+				break;
+
+			cond.wait(lock);
+			continue;
+		}
+
+		Job job = std::move(queue.front());
+		queue.pop_front();
+
+		RunJob(job);
+	}
+}
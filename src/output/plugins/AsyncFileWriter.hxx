@@ -0,0 +1,167 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_ASYNC_FILE_WRITER_HXX
+#define MPD_ASYNC_FILE_WRITER_HXX
+
+#include "thread/Thread.hxx"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <vector>
+
+class FileOutputStream;
+
+/**
+ * Writes data to #FileOutputStream instances in a separate thread,
+ * so a slow disk (or a file system which blocks in fsync()) doesn't
+ * block the caller.
+ *
+ * Memory usage is bounded: if the buffer is full, Write() refuses
+ * the data instead of waiting, and reports this to the caller.
+ */
+class AsyncFileWriter {
+	struct Job {
+		/**
+		 * The file which shall be written to.  If #finish is
+		 * not #Finish::NONE, then this object owns it.
+		 */
+		FileOutputStream *file;
+
+		std::vector<uint8_t> data;
+
+		/**
+		 * What to do with #file after writing #data.
+		 */
+		enum class Finish : uint8_t {
+			NONE,
+
+			/**
+			 * Commit and delete it.
+			 */
+			COMMIT,
+
+			/**
+			 * Delete it without committing it.
+			 */
+			CANCEL,
+		} finish = Finish::NONE;
+
+		explicit Job(FileOutputStream &_file) noexcept
+			:file(&_file) {}
+	};
+
+	/**
+	 * The maximum number of bytes in #queue.
+	 */
+	const size_t max_buffered;
+
+	Mutex mutex;
+
+	/**
+	 * Wakes up the writer thread after #queue has been modified
+	 * or #quit has been set.
+	 */
+	Cond cond;
+
+	Thread thread;
+
+	std::deque<Job> queue;
+
+	/**
+	 * The number of data bytes in #queue.
+	 */
+	size_t buffered = 0;
+
+	/**
+	 * An error which occurred in the writer thread; it will be
+	 * rethrown by the next Write() call.
+	 */
+	std::exception_ptr error;
+
+	/**
+	 * The file which has failed; all further data for it is
+	 * discarded, and it will be deleted instead of committed.
+	 * Only used by the writer thread.
+	 */
+	const FileOutputStream *failed_file = nullptr;
+
+	bool quit = false;
+
+public:
+	/**
+	 * Throws on error.
+	 */
+	explicit AsyncFileWriter(size_t _max_buffered);
+
+	/**
+	 * Waits until all pending jobs have been finished.
+	 */
+	~AsyncFileWriter() noexcept;
+
+	AsyncFileWriter(const AsyncFileWriter &) = delete;
+	AsyncFileWriter &operator=(const AsyncFileWriter &) = delete;
+
+	/**
+	 * Schedule writing the given data to the file.  The caller
+	 * must keep the file alive until it has been passed to
+	 * Commit().
+	 *
+	 * Throws if a previous write has failed.
+	 *
+	 * @return false if the buffer is full and the data has not
+	 * been queued
+	 */
+	bool Write(FileOutputStream &file, const void *data, size_t size);
+
+	/**
+	 * Schedule committing and deleting the file after all data
+	 * has been written.  Errors are logged.
+	 */
+	void Commit(std::unique_ptr<FileOutputStream> file) noexcept {
+		Finish(std::move(file), Job::Finish::COMMIT);
+	}
+
+	/**
+	 * Schedule deleting the file (without committing it) after
+	 * all pending jobs referring to it have been finished.
+	 */
+	void Cancel(std::unique_ptr<FileOutputStream> file) noexcept {
+		Finish(std::move(file), Job::Finish::CANCEL);
+	}
+
+private:
+	void Finish(std::unique_ptr<FileOutputStream> file,
+		    Job::Finish finish) noexcept;
+
+	/**
+	 * Runs in the writer thread.  Caller must lock the mutex.
+	 */
+	void RunJob(Job &job) noexcept;
+
+	void Run() noexcept;
+};
+
+#endif
@@ -73,7 +73,7 @@ private:
 static constexpr Domain fifo_output_domain("fifo_output");
 
 FifoOutput::FifoOutput(const ConfigBlock &block)
-	:AudioOutput(0),
+	:AudioOutput(FLAG_SHARED_THREAD),
 	 path(block.GetPath("path"))
 {
 	if (path.IsNull())
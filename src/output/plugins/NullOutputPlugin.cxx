@@ -28,7 +28,7 @@ class NullOutput final  : AudioOutput {
 
 public:
 	explicit NullOutput(const ConfigBlock &block)
-		:AudioOutput(0),
+		:AudioOutput(FLAG_SHARED_THREAD),
 		 sync(block.GetBlockValue("sync", true)) {}
 
 	static AudioOutput *Create(EventLoop &,
@@ -49,7 +49,7 @@ private:
 };
 
 PipeOutput::PipeOutput(const ConfigBlock &block)
-	:AudioOutput(0),
+	:AudioOutput(FLAG_SHARED_THREAD),
 	 cmd(block.GetBlockValue("command", ""))
 {
 	if (cmd.empty())
@@ -62,6 +62,11 @@ PipeOutput::Open([[maybe_unused]] AudioFormat &audio_format)
 	fh = popen(cmd.c_str(), "w");
 	if (fh == nullptr)
 		throw FormatErrno("Error opening pipe \"%s\"", cmd.c_str());
+
+	/* disable stdio buffering: our chunks are large enough, and
+	   this way, fwrite() passes them straight to write() instead
+	   of copying them to the stdio buffer first */
+	setvbuf(fh, nullptr, _IONBF, 0);
 }
 
 inline size_t
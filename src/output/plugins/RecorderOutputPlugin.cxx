@@ -18,9 +18,9 @@
  */
 
 #include "RecorderOutputPlugin.hxx"
+#include "AsyncFileWriter.hxx"
 #include "../OutputAPI.hxx"
 #include "tag/Format.hxx"
-#include "encoder/ToOutputStream.hxx"
 #include "encoder/EncoderInterface.hxx"
 #include "encoder/Configured.hxx"
 #include "config/Path.hxx"
@@ -28,6 +28,7 @@
 #include "fs/AllocatedPath.hxx"
 #include "fs/io/FileOutputStream.hxx"
 #include "util/Domain.hxx"
+#include "util/RuntimeError.hxx"
 #include "util/ScopeExit.hxx"
 
 #include <cassert>
@@ -63,10 +64,22 @@ class RecorderOutput final : AudioOutput {
 	AudioFormat effective_audio_format;
 
 	/**
-	 * The destination file.
+	 * The destination file.  Data is written to it by #writer.
 	 */
 	FileOutputStream *file;
 
+	/**
+	 * Writes encoded data to #file in a separate thread, so a
+	 * slow disk doesn't block the output thread.  Only defined
+	 * while the output is open.
+	 */
+	std::unique_ptr<AsyncFileWriter> writer;
+
+	/**
+	 * The maximum amount of encoded data buffered in #writer.
+	 */
+	const size_t buffer_size;
+
 	explicit RecorderOutput(const ConfigBlock &block);
 
 public:
@@ -75,13 +88,28 @@ public:
 	}
 
 private:
+	std::map<std::string, std::string> GetAttributes() const noexcept override {
+		return prepared_encoder->GetAttributes();
+	}
+
 	void Open(AudioFormat &audio_format) override;
 	void Close() noexcept override;
 
 	/**
-	 * Writes pending data from the encoder to the output file.
+	 * Writes pending data from the encoder to the output file
+	 * (via #writer).
+	 *
+	 * Throws if a previous write has failed or if #writer's
+	 * buffer is full (because the disk is too slow).
 	 */
-	void EncoderToFile();
+	void EncoderToFile(FileOutputStream &dest);
+
+	/**
+	 * Close the encoder and delete the file without committing
+	 * it.  This is called after EncoderToFile() has failed,
+	 * because a file with missing data would be corrupt.
+	 */
+	void CancelFile() noexcept;
 
 	void SendTag(const Tag &tag) override;
 
@@ -104,8 +132,9 @@ private:
 };
 
 RecorderOutput::RecorderOutput(const ConfigBlock &block)
-	:AudioOutput(0),
-	 prepared_encoder(CreateConfiguredEncoder(block))
+	:AudioOutput(FLAG_SHARED_THREAD),
+	 prepared_encoder(CreateConfiguredEncoder(block)),
+	 buffer_size(block.GetPositiveValue("buffer_size", 4u * 1024 * 1024))
 {
 	/* read configuration */
 
@@ -122,23 +151,58 @@ RecorderOutput::RecorderOutput(const ConfigBlock &block)
 		throw std::runtime_error("Cannot have both 'path' and 'format_path'");
 }
 
-inline void
-RecorderOutput::EncoderToFile()
+void
+RecorderOutput::EncoderToFile(FileOutputStream &dest)
+{
+	assert(writer);
+
+	while (true) {
+		/* read from the encoder */
+
+		char buffer[32768];
+		size_t nbytes = encoder->Read(buffer, sizeof(buffer));
+		if (nbytes == 0)
+			return;
+
+		/* pass it to the writer thread, which never blocks;
+		   if the disk can't keep up, the recording would
+		   have a gap, and it is better to fail */
+
+		if (!writer->Write(dest, buffer, nbytes))
+			throw FormatRuntimeError("Disk too slow, cannot record to \"%s\"",
+						 dest.GetPath().ToUTF8().c_str());
+	}
+}
+
+void
+RecorderOutput::CancelFile() noexcept
 {
 	assert(file != nullptr);
 
-	EncoderToOutputStream(*file, *encoder);
+	delete encoder;
+	writer->Cancel(std::unique_ptr<FileOutputStream>(file));
+	file = nullptr;
+
+	if (HasDynamicPath())
+		path.SetNull();
 }
 
 void
 RecorderOutput::Open(AudioFormat &audio_format)
 {
+	writer = std::make_unique<AsyncFileWriter>(buffer_size);
+
 	/* create the output file */
 
 	if (!HasDynamicPath()) {
 		assert(!path.IsNull());
 
-		file = new FileOutputStream(path);
+		try {
+			file = new FileOutputStream(path);
+		} catch (...) {
+			writer.reset();
+			throw;
+		}
 	} else {
 		/* don't open the file just yet; wait until we have
 		   a tag that we can use to build the path */
@@ -153,14 +217,17 @@ RecorderOutput::Open(AudioFormat &audio_format)
 		encoder = prepared_encoder->Open(audio_format);
 	} catch (...) {
 		delete file;
+		writer.reset();
 		throw;
 	}
 
 	if (!HasDynamicPath()) {
 		try {
-			EncoderToFile();
+			EncoderToFile(*file);
 		} catch (...) {
 			delete encoder;
+			writer->Cancel(std::unique_ptr<FileOutputStream>(file));
+			writer.reset();
 			throw;
 		}
 	} else {
@@ -182,34 +249,30 @@ RecorderOutput::Commit()
 
 	try {
 		encoder->End();
-		EncoderToFile();
+		EncoderToFile(*file);
 	} catch (...) {
 		delete encoder;
+		writer->Cancel(std::unique_ptr<FileOutputStream>(file));
 		throw;
 	}
 
-	/* now really close everything */
+	/* now really close everything; the file is committed by
+	   the writer thread after all pending data has been
+	   written */
 
 	delete encoder;
 
-	try {
-		file->Commit();
-	} catch (...) {
-		delete file;
-		throw;
-	}
-
-	delete file;
+	writer->Commit(std::unique_ptr<FileOutputStream>(file));
 }
 
 void
 RecorderOutput::Close() noexcept
 {
 	if (file == nullptr) {
-		/* not currently encoding to a file; nothing needs to
-		   be done now */
-		assert(HasDynamicPath());
-		assert(path.IsNull());
+		/* not currently encoding to a file (or the file has
+		   been canceled after an error); nothing needs to be
+		   done now */
+		writer.reset();
 		return;
 	}
 
@@ -223,6 +286,14 @@ RecorderOutput::Close() noexcept
 		assert(!path.IsNull());
 		path.SetNull();
 	}
+
+	/* wait for the writer thread to finish; this blocks the
+	   output thread until all pending data (at most
+	   "buffer_size" bytes) has been written and the file has
+	   been committed, because returning earlier would leave an
+	   incomplete file behind while the output might already be
+	   reopened */
+	writer.reset();
 }
 
 void
@@ -266,10 +337,10 @@ RecorderOutput::ReopenFormat(AllocatedPath &&new_path)
 	assert(new_audio_format == effective_audio_format);
 
 	try {
-		EncoderToOutputStream(*new_file, *encoder);
+		EncoderToFile(*new_file);
 	} catch (...) {
 		delete encoder;
-		delete new_file;
+		writer->Cancel(std::unique_ptr<FileOutputStream>(new_file));
 		throw;
 	}
 
@@ -317,8 +388,21 @@ RecorderOutput::SendTag(const Tag &tag)
 		}
 	}
 
-	encoder->PreTag();
-	EncoderToFile();
+	if (file == nullptr)
+		return;
+
+	try {
+		encoder->PreTag();
+		EncoderToFile(*file);
+	} catch (...) {
+		/* the caller only logs SendTag() errors and keeps
+		   the output open; with a fixed path, there is no
+		   next file to switch to, so keep this one */
+		if (HasDynamicPath())
+			CancelFile();
+		throw;
+	}
+
 	encoder->SendTag(tag);
 }
 
@@ -326,16 +410,24 @@ size_t
 RecorderOutput::Play(const void *chunk, size_t size)
 {
 	if (file == nullptr) {
+		if (!HasDynamicPath())
+			/* the file was cancelled after an error; let
+			   the output be closed and reopened */
+			throw std::runtime_error("Recording was cancelled");
+
 		/* not currently encoding to a file; discard incoming
 		   data */
-		assert(HasDynamicPath());
 		assert(path.IsNull());
 		return size;
 	}
 
-	encoder->Write(chunk, size);
-
-	EncoderToFile();
+	try {
+		encoder->Write(chunk, size);
+		EncoderToFile(*file);
+	} catch (...) {
+		CancelFile();
+		throw;
+	}
 
 	return size;
 }
@@ -54,6 +54,10 @@ struct ShoutOutput final : AudioOutput {
 	static AudioOutput *Create(EventLoop &event_loop,
 				   const ConfigBlock &block);
 
+	std::map<std::string, std::string> GetAttributes() const noexcept override {
+		return prepared_encoder->GetAttributes();
+	}
+
 	void Open(AudioFormat &audio_format) override;
 	void Close() noexcept override;
 
@@ -164,6 +164,8 @@ public:
 	void Bind();
 	void Unbind() noexcept;
 
+	std::map<std::string, std::string> GetAttributes() const noexcept override;
+
 	void Enable() override {
 		Bind();
 	}
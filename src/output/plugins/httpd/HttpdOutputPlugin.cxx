@@ -40,7 +40,7 @@ const Domain httpd_output_domain("httpd_output");
 
 inline
 HttpdOutput::HttpdOutput(EventLoop &_loop, const ConfigBlock &block)
-	:AudioOutput(FLAG_ENABLE_DISABLE|FLAG_PAUSE),
+	:AudioOutput(FLAG_ENABLE_DISABLE|FLAG_PAUSE|FLAG_SHARED_THREAD),
 	 ServerSocket(_loop),
 	 prepared_encoder(CreateConfiguredEncoder(block)),
 	 defer_broadcast(_loop, BIND_THIS_METHOD(OnDeferredBroadcast))
@@ -234,6 +234,12 @@ HttpdOutput::SendHeader(HttpdClient &client) const noexcept
 		client.PushPage(header);
 }
 
+std::map<std::string, std::string>
+HttpdOutput::GetAttributes() const noexcept
+{
+	return prepared_encoder->GetAttributes();
+}
+
 std::chrono::steady_clock::duration
 HttpdOutput::Delay() const noexcept
 {
@@ -39,6 +39,7 @@ struct Tag;
 class PlayerListener;
 class PlayerOutputs;
 class InputCacheManager;
+class SeekIndexCache;
 class DetachedSong;
 
 enum class PlayerState : uint8_t {
@@ -118,6 +119,8 @@ class PlayerControl final : public AudioOutputClient {
 
 	InputCacheManager *const input_cache;
 
+	SeekIndexCache *const seek_index_cache;
+
 	const unsigned buffer_chunks;
 
 	/**
@@ -237,6 +240,7 @@ public:
 	PlayerControl(PlayerListener &_listener,
 		      PlayerOutputs &_outputs,
 		      InputCacheManager *_input_cache,
+		      SeekIndexCache *_seek_index_cache,
 		      unsigned buffer_chunks,
 		      AudioFormat _configured_audio_format,
 		      const ReplayGainConfig &_replay_gain_config) noexcept;
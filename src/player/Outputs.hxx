@@ -26,6 +26,7 @@
 
 struct AudioFormat;
 struct MusicChunk;
+class MusicPipe;
 
 /**
  * An interface for the player thread to control all outputs.  This
@@ -97,6 +98,24 @@ public:
 	 */
 	virtual void Cancel() noexcept = 0;
 
+	/**
+	 * Like Cancel(), but instead of returning the chunks to the
+	 * #MusicBuffer, move the recently played chunks (see
+	 * SetHistorySize()) and all chunks which have not been
+	 * played yet to the given #MusicPipe, in playback order.
+	 * This allows the player to seek within data which has
+	 * already been decoded.
+	 */
+	virtual void CancelToPipe(MusicPipe &dest) noexcept = 0;
+
+	/**
+	 * Keep up to this number of chunks after they have been
+	 * played by all outputs, for CancelToPipe().  The history is
+	 * discarded at song borders.  Pass 0 to disable (and clear)
+	 * the history.
+	 */
+	virtual void SetHistorySize(unsigned n) noexcept = 0;
+
 	/**
 	 * Indicate that a new song will begin now.
 	 */
@@ -51,6 +51,8 @@
 #include "thread/Name.hxx"
 #include "Log.hxx"
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
 #include <memory>
 
@@ -64,6 +66,13 @@ static constexpr Domain player_domain("player");
  */
 static constexpr auto buffer_before_play_duration = std::chrono::seconds(1);
 
+/**
+ * Keep this duration of already played chunks (but at most a quarter
+ * of the #MusicBuffer), to be able to seek backwards without
+ * restarting the decoder.
+ */
+static constexpr auto seek_history_duration = std::chrono::seconds(10);
+
 class Player {
 	PlayerControl &pc;
 
@@ -195,6 +204,12 @@ class Player {
 	 */
 	SongTime pending_seek;
 
+	/**
+	 * The time when the most recent #PlayerCommand::SEEK was
+	 * received.  Used to log the seek latency.
+	 */
+	std::chrono::steady_clock::time_point seek_start;
+
 public:
 	Player(PlayerControl &_pc, DecoderControl &_dc,
 	       MusicBuffer &_buffer) noexcept
@@ -290,6 +305,24 @@ private:
 	 */
 	bool SeekDecoder(std::unique_lock<Mutex> &lock) noexcept;
 
+	/**
+	 * Can the seek command in PlayerControl::next_song be
+	 * fulfilled from chunks which have already been decoded (or
+	 * played recently)?  This is only a precondition check;
+	 * whether the seek target is really available is determined
+	 * by MusicPipe::SkipTo().
+	 *
+	 * Caller must lock the mutex.
+	 */
+	[[nodiscard]] gcc_pure
+	bool CanSeekInPipe() const noexcept;
+
+	/**
+	 * Log how long the current seek command took.
+	 */
+	void LogSeekLatency(SongTime seek_time,
+			    const char *method) const noexcept;
+
 	void CancelPendingSeek() noexcept {
 		pending_seek = SongTime::zero();
 		pc.CancelPendingSeek();
@@ -536,6 +569,12 @@ Player::CheckDecoderStartup(std::unique_lock<Mutex> &lock) noexcept
 			(buffer_before_play_size + sizeof(MusicChunk::data) - 1)
 			/ sizeof(MusicChunk::data);
 
+		const size_t seek_history_size =
+			play_audio_format.TimeToSize(seek_history_duration);
+		pc.outputs.SetHistorySize(std::min<size_t>((seek_history_size + sizeof(MusicChunk::data) - 1)
+							   / sizeof(MusicChunk::data),
+							   buffer.GetSize() / 4));
+
 		idle_add(IDLE_PLAYER);
 
 		if (pending_seek > SongTime::zero()) {
@@ -547,12 +586,16 @@ Player::CheckDecoderStartup(std::unique_lock<Mutex> &lock) noexcept
 			if (!success)
 				return false;
 
+			LogSeekLatency(pending_seek, "decoder startup");
+
 			/* re-fill the buffer after seeking */
 			buffering = true;
 		} else if (pc.seeking) {
 			pc.seeking = false;
 			pc.ClientSignal();
 
+			LogSeekLatency(elapsed_time, "decoder restart");
+
 			/* re-fill the buffer after seeking */
 			buffering = true;
 		}
@@ -601,11 +644,36 @@ Player::SeekDecoder(std::unique_lock<Mutex> &lock, SongTime seek_time) noexcept
 	return true;
 }
 
+inline bool
+Player::CanSeekInPipe() const noexcept
+{
+	assert(pc.next_song != nullptr);
+
+	return !decoder_starting &&
+		/* not while cross-fading, because the pipe contains
+		   chunks of two songs */
+		xfade_state != CrossFadeState::ACTIVE &&
+		IsDecoderAtCurrentSong() &&
+		song->IsSame(*pc.next_song);
+}
+
+void
+Player::LogSeekLatency(SongTime seek_time, const char *method) const noexcept
+{
+	const std::chrono::duration<double, std::milli> duration =
+		std::chrono::steady_clock::now() - seek_start;
+
+	FormatDebug(player_domain, "seek to %.3fs (%s) took %.1fms",
+		    seek_time.ToDoubleS(), method, duration.count());
+}
+
 inline bool
 Player::SeekDecoder(std::unique_lock<Mutex> &lock) noexcept
 {
 	assert(pc.next_song != nullptr);
 
+	seek_start = std::chrono::steady_clock::now();
+
 	if (pc.seek_time > SongTime::zero() && // TODO: allow this only if the song duration is known
 	    dc.IsUnseekableCurrentSong(*pc.next_song)) {
 		/* seeking into the current song; but we already know
@@ -621,13 +689,44 @@ Player::SeekDecoder(std::unique_lock<Mutex> &lock) noexcept
 
 	CancelPendingSeek();
 
+	const bool try_in_pipe = CanSeekInPipe();
+
 	{
 		const ScopeUnlock unlock(pc.mutex);
-		pc.outputs.Cancel();
+
+		if (try_in_pipe) {
+			/* keep the chunks which have not been played
+			   yet and the recently played ones; maybe the
+			   seek target is among them */
+			MusicPipe played;
+			pc.outputs.CancelToPipe(played);
+			pipe->Prepend(played);
+		} else
+			pc.outputs.Cancel();
 	}
 
 	idle_add(IDLE_PLAYER);
 
+	if (try_in_pipe && pipe->SkipTo(pc.seek_time)) {
+		/* the seek target has already been decoded; no need
+		   to seek or restart the decoder */
+
+		pc.next_song.reset();
+		queued = false;
+
+		elapsed_time = pc.seek_time;
+		LogSeekLatency(pc.seek_time, "pipe");
+
+		pc.CommandFinished();
+
+		assert(xfade_state == CrossFadeState::UNKNOWN);
+
+		/* re-fill the buffer after seeking */
+		buffering = true;
+
+		return true;
+	}
+
 	if (!dc.IsSeekableCurrentSong(*pc.next_song)) {
 		/* the decoder is already decoding the "next" song -
 		   stop it and start the previous song again */
@@ -674,6 +773,8 @@ Player::SeekDecoder(std::unique_lock<Mutex> &lock) noexcept
 				pc.CommandFinished();
 				return false;
 			}
+
+			LogSeekLatency(pc.seek_time, "decoder");
 		}
 	}
 
@@ -1124,6 +1225,9 @@ Player::Run() noexcept
 	CancelPendingSeek();
 	StopDecoder(lock);
 
+	/* return the seek history to the buffer */
+	pc.outputs.SetHistorySize(0);
+
 	pipe.reset();
 
 	cross_fade_tag.reset();
@@ -1157,7 +1261,7 @@ try {
 	SetThreadName("player");
 
 	DecoderControl dc(mutex, cond,
-			  input_cache,
+			  input_cache, seek_index_cache,
 			  configured_audio_format,
 			  replay_gain_config);
 	dc.StartThread();
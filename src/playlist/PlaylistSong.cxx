@@ -24,6 +24,11 @@
 #include "fs/Traits.hxx"
 #include "song/DetachedSong.hxx"
 #include "util/UriExtract.hxx"
+#include "config.h"
+
+#ifdef ENABLE_DATABASE
+#include "db/DatabaseError.hxx"
+#endif
 
 #include <algorithm>
 #include <string>
@@ -60,6 +65,14 @@ try {
 
 	merge_song_metadata(song, tmp);
 	return true;
+#ifdef ENABLE_DATABASE
+} catch (const DatabaseError &e) {
+	/* while the database is being loaded in the background,
+	   accept the song as it is, so restoring the queue from the
+	   state file doesn't lose all database songs; it will be
+	   resolved by playlist::DatabaseLoaded() */
+	return e.GetCode() == DatabaseErrorCode::LOADING;
+#endif
 } catch (...) {
 	return false;
 }
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_PROTOCOL_BINARY_SONG_HXX
+#define MPD_PROTOCOL_BINARY_SONG_HXX
+
+#include "tag/Type.h"
+
+#include <cstdint>
+
+/**
+ * Field keys of the binary song encoding which can be enabled with
+ * "protocol binary".  Each field is encoded as one key byte, the
+ * value length as unsigned LEB128 and the value itself; the values
+ * are the same strings which are sent in the text protocol.  Each
+ * song record begins with a #URI field.
+ */
+enum class BinarySongKey : uint8_t {
+	URI,
+	RANGE,
+	LAST_MODIFIED,
+	FORMAT,
+	TIME,
+	DURATION,
+	POS,
+	ID,
+	PRIO,
+
+	/**
+	 * Tag values: this value plus the #TagType.
+	 */
+	TAG = 0x20,
+};
+
+static_assert(unsigned(BinarySongKey::TAG) + TAG_NUM_OF_ITEM_TYPES <= 0x100,
+	      "Too many tag types for the binary song encoding");
+
+/**
+ * The names of the non-tag keys as used in the text protocol.
+ */
+static constexpr const char *binary_song_key_names[] = {
+	"file",
+	"Range",
+	"Last-Modified",
+	"Format",
+	"Time",
+	"duration",
+	"Pos",
+	"Id",
+	"Prio",
+};
+
+static constexpr BinarySongKey
+BinarySongTagKey(TagType type) noexcept
+{
+	return BinarySongKey(unsigned(BinarySongKey::TAG) + unsigned(type));
+}
+
+#endif
@@ -203,6 +203,14 @@ public:
 	 * The database has been modified.  Pull all updates.
 	 */
 	void DatabaseModified(const Database &db);
+
+	/**
+	 * The database has finished loading in the background.  Songs
+	 * which were added meanwhile could not be verified; look them
+	 * up now, copy their metadata and remove those which don't
+	 * exist.
+	 */
+	void DatabaseLoaded(PlayerControl &pc, const Database &db) noexcept;
 #endif
 
 	/**
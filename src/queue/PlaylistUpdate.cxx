@@ -70,3 +70,47 @@ playlist::DatabaseModified(const Database &db)
 	if (modified)
 		OnModified();
 }
+
+void
+playlist::DatabaseLoaded(PlayerControl &pc, const Database &db) noexcept
+{
+	/* don't remove the current song, see StaleSong() */
+	const int current_position = playing
+		? GetCurrentPosition()
+		: -1;
+
+	BeginBulk();
+
+	for (int i = queue.GetLength() - 1; i >= 0; --i) {
+		DetachedSong &song = queue.Get(i);
+		if (!song.IsInDatabase() || !song.IsFile())
+			continue;
+
+		const LightSong *original;
+		try {
+			original = db.GetSong(song.GetURI());
+		} catch (...) {
+			/* the song was accepted without verification
+			   while the database was loading, but it
+			   doesn't exist */
+			if (i != current_position)
+				DeletePosition(pc, i);
+			continue;
+		}
+
+		song.SetLastModified(original->mtime);
+		song.SetTag(original->tag);
+
+		if (song.GetStartTime().IsZero())
+			song.SetStartTime(original->start_time);
+		if (song.GetEndTime().IsZero())
+			song.SetEndTime(original->end_time);
+
+		db.ReturnSong(original);
+
+		queue.ModifyAtPosition(i);
+		OnModified();
+	}
+
+	CommitBulk(pc);
+}
@@ -21,9 +21,11 @@
 #include "Queue.hxx"
 #include "song/Filter.hxx"
 #include "SongPrint.hxx"
+#include "SongPrintCache.hxx"
 #include "song/DetachedSong.hxx"
 #include "song/LightSong.hxx"
 #include "client/Response.hxx"
+#include "util/StringView.hxx"
 
 /**
  * Send detailed information about a range of songs in the queue to a
@@ -37,13 +39,28 @@ static void
 queue_print_song_info(Response &r, const Queue &queue,
 		      unsigned position)
 {
-	song_print_info(r, queue.Get(position));
-	r.Format("Pos: %u\nId: %u\n",
-		 position, queue.PositionToId(position));
+	auto *cache = r.GetSongPrintCache();
+	if (cache != nullptr)
+		cache->PrintQueueSong(r, queue, position);
+	else
+		song_print_info(r, queue.Get(position));
+
+	const unsigned id = queue.PositionToId(position);
+	const uint8_t priority = queue.GetPriorityAtPosition(position);
+
+	if (r.IsBinarySongs()) {
+		r.WriteBinaryUnsigned(BinarySongKey::POS, position);
+		r.WriteBinaryUnsigned(BinarySongKey::ID, id);
+		if (priority != 0)
+			r.WriteBinaryUnsigned(BinarySongKey::PRIO, priority);
+		return;
+	}
+
+	r.WriteKeyUnsigned("Pos", position);
+	r.WriteKeyUnsigned("Id", id);
 
-	uint8_t priority = queue.GetPriorityAtPosition(position);
 	if (priority != 0)
-		r.Format("Prio: %u\n", priority);
+		r.WriteKeyUnsigned("Prio", priority);
 }
 
 void
@@ -18,6 +18,8 @@
  */
 
 #include "AndSongFilter.hxx"
+#include "LightSong.hxx"
+#include "tag/Tag.hxx"
 
 #include <algorithm>
 
@@ -29,6 +31,8 @@ AndSongFilter::Clone() const noexcept
 	for (const auto &i : items)
 		result->items.emplace_back(i->Clone());
 
+	result->required_tags = required_tags;
+
 	return result;
 }
 
@@ -56,5 +60,9 @@ AndSongFilter::ToExpression() const noexcept
 bool
 AndSongFilter::Match(const LightSong &song) const noexcept
 {
+	for (const auto &m : required_tags)
+		if (!(song.tag.mask & m).TestAny())
+			return false;
+
 	return std::all_of(items.begin(), items.end(), [&song](const auto &i) { return i->Match(song); });
 }
@@ -21,9 +21,11 @@
 #define MPD_AND_SONG_FILTER_HXX
 
 #include "ISongFilter.hxx"
+#include "tag/Mask.hxx"
 #include "util/Compiler.h"
 
 #include <list>
+#include <vector>
 
 /**
  * Combine multiple #ISongFilter instances with logical "and".
@@ -31,6 +33,15 @@
 class AndSongFilter final : public ISongFilter {
 	std::list<ISongFilterPtr> items;
 
+	/**
+	 * Tag types which must be present for a song to match,
+	 * calculated by OptimizeSongFilter().  For each mask, at
+	 * least one of its types must be present (a tag type plus
+	 * its fallbacks).  This allows rejecting songs by looking at
+	 * Tag::mask before evaluating the items.
+	 */
+	std::vector<TagMask> required_tags;
+
 	friend void OptimizeSongFilter(AndSongFilter &) noexcept;
 	friend ISongFilterPtr OptimizeSongFilter(ISongFilterPtr) noexcept;
 
@@ -35,6 +35,7 @@
 #include "util/StringStrip.hxx"
 #include "util/StringView.hxx"
 #include "util/ASCII.hxx"
+#include "util/UriRelative.hxx"
 #include "util/UriUtil.hxx"
 
 #include <cassert>
@@ -466,6 +467,25 @@ SongFilter::GetBase() const noexcept
 	return nullptr;
 }
 
+SongFilter
+SongFilter::WithoutImpliedBase(const char *uri) const noexcept
+{
+	SongFilter result;
+
+	for (const auto &i : and_filter.GetItems()) {
+		const auto *f = dynamic_cast<const BaseSongFilter *>(i.get());
+		if (f != nullptr && uri_is_child_or_same(f->GetValue(), uri))
+			continue;
+
+		result.and_filter.AddItem(i->Clone());
+	}
+
+	/* recalculate the information collected by
+	   OptimizeSongFilter() */
+	result.Optimize();
+	return result;
+}
+
 SongFilter
 SongFilter::WithoutBasePrefix(const std::string_view prefix) const noexcept
 {
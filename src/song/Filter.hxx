@@ -107,6 +107,16 @@ public:
 	 * filter songs in mounted databases.
 	 */
 	SongFilter WithoutBasePrefix(std::string_view prefix) const noexcept;
+
+	/**
+	 * Create a copy of the filter without the
+	 * #LOCATE_TAG_BASE_TYPE items which are implied by the given
+	 * URI, i.e. the URI is the "base" directory or inside it.
+	 * This is used when the database walk is already limited to
+	 * that directory, so the items don't need to be evaluated
+	 * for each song.
+	 */
+	SongFilter WithoutImpliedBase(const char *uri) const noexcept;
 };
 
 #endif
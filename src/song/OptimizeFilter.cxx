@@ -22,6 +22,106 @@
 #include "NotSongFilter.hxx"
 #include "TagSongFilter.hxx"
 #include "UriSongFilter.hxx"
+#include "BaseSongFilter.hxx"
+#include "ModifiedSinceSongFilter.hxx"
+#include "AudioFormatSongFilter.hxx"
+#include "tag/Fallback.hxx"
+
+/**
+ * Estimate the cost of evaluating a #StringFilter on one value.
+ */
+gcc_pure
+static unsigned
+EstimateCost(const StringFilter &f) noexcept
+{
+	if (f.IsRegex())
+		return 64;
+
+	unsigned cost = 2;
+	if (f.GetFoldCase())
+		cost += 2;
+	if (f.IsSubstring())
+		cost += 2;
+	return cost;
+}
+
+/**
+ * Estimate how expensive it is to evaluate the given filter on one
+ * song, in arbitrary units.  Filters which are unlikely to reject a
+ * song (i.e. negated ones) get a penalty, because in an "AND" list,
+ * they should be evaluated after the more selective ones.
+ */
+gcc_pure
+static unsigned
+EstimateCost(const ISongFilter &f) noexcept
+{
+	/* the penalty for filters which match most songs */
+	constexpr unsigned UNSELECTIVE = 32;
+
+	if (dynamic_cast<const ModifiedSinceSongFilter *>(&f) != nullptr ||
+	    dynamic_cast<const AudioFormatSongFilter *>(&f) != nullptr)
+		/* a simple integer comparison */
+		return 1;
+
+	if (auto *tf = dynamic_cast<const TagSongFilter *>(&f)) {
+		unsigned cost = EstimateCost(tf->GetFilter());
+		if (tf->GetTagType() == TAG_NUM_OF_ITEM_TYPES)
+			/* "any" checks all values */
+			cost *= 4;
+		if (tf->IsNegated())
+			cost += UNSELECTIVE;
+		return cost;
+	}
+
+	if (auto *uf = dynamic_cast<const UriSongFilter *>(&f)) {
+		/* LightSong::GetURI() allocates a string */
+		unsigned cost = 8 + EstimateCost(uf->GetFilter());
+		if (uf->IsNegated())
+			cost += UNSELECTIVE;
+		return cost;
+	}
+
+	if (dynamic_cast<const BaseSongFilter *>(&f) != nullptr)
+		return 8;
+
+	if (auto *nf = dynamic_cast<const NotSongFilter *>(&f))
+		return EstimateCost(nf->GetChild()) + UNSELECTIVE;
+
+	if (auto *af = dynamic_cast<const AndSongFilter *>(&f)) {
+		unsigned cost = 0;
+		for (const auto &i : af->GetItems())
+			cost += EstimateCost(*i);
+		return cost;
+	}
+
+	return UNSELECTIVE;
+}
+
+/**
+ * If the given filter can only match songs which have a certain tag
+ * (or one of its fallbacks), return a mask of these tag types, else
+ * TagMask::None().
+ */
+gcc_pure
+static TagMask
+GetRequiredTags(const ISongFilter &f) noexcept
+{
+	const auto *tf = dynamic_cast<const TagSongFilter *>(&f);
+	if (tf == nullptr || tf->IsNegated() ||
+	    tf->GetTagType() == TAG_NUM_OF_ITEM_TYPES ||
+	    /* an empty value matches songs which don't have
+	       the tag */
+	    tf->GetFilter().empty())
+		return TagMask::None();
+
+	auto mask = TagMask::None();
+	ApplyTagWithFallback(tf->GetTagType(), [&mask](TagType t){
+		mask.Set(t);
+		return false;
+	});
+
+	return mask;
+}
 
 void
 OptimizeSongFilter(AndSongFilter &af) noexcept
@@ -37,6 +137,20 @@ OptimizeSongFilter(AndSongFilter &af) noexcept
 			++i;
 		}
 	}
+
+	/* evaluate cheap and selective items first; this is a
+	   stable sort, so items with the same cost remain in the
+	   order specified by the client */
+	af.items.sort([](const auto &a, const auto &b){
+		return EstimateCost(*a) < EstimateCost(*b);
+	});
+
+	af.required_tags.clear();
+	for (const auto &i : af.items) {
+		const auto mask = GetRequiredTags(*i);
+		if (mask.TestAny())
+			af.required_tags.push_back(mask);
+	}
 }
 
 ISongFilterPtr
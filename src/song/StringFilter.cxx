@@ -18,7 +18,9 @@
  */
 
 #include "StringFilter.hxx"
-#include "util/StringAPI.hxx"
+#include "tag/Item.hxx"
+#include "tag/Pool.hxx"
+#include "util/StringSearch.hxx"
 
 #include <cassert>
 
@@ -38,11 +40,39 @@ StringFilter::MatchWithoutNegation(const char *s) const noexcept
 			: fold_case == s;
 	} else {
 		return substring
-			? StringFind(s, value.c_str()) != nullptr
+			? ContainsSubstring(s, value)
 			: value == s;
 	}
 }
 
+bool
+StringFilter::MatchWithoutNegation(const TagItem &item) const noexcept
+{
+#ifdef HAVE_PCRE
+	if (regex)
+		return regex->Match(tag_pool_get_value(item));
+#endif
+
+	if (fold_case) {
+#ifdef HAVE_ICU_CASE_FOLD
+		const auto folded = tag_pool_get_folded(item);
+		return substring
+			? fold_case.IsInFolded(folded)
+			: fold_case.EqualsFolded(folded);
+#else
+		return MatchWithoutNegation(item.value);
+#endif
+	}
+
+	/* the pool knows the length of the value, which allows
+	   rejecting most values by their length (equality) and
+	   searching with FindSubstring() without strlen() */
+	const auto v = tag_pool_get_value(item);
+	return substring
+		? ContainsSubstring(v, value)
+		: v == value;
+}
+
 bool
 StringFilter::Match(const char *s) const noexcept
 {
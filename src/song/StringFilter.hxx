@@ -31,6 +31,8 @@
 #include <string>
 #include <memory>
 
+struct TagItem;
+
 class StringFilter {
 	std::string value;
 
@@ -86,6 +88,10 @@ public:
 		return fold_case;
 	}
 
+	bool IsSubstring() const noexcept {
+		return substring;
+	}
+
 	bool IsNegated() const noexcept {
 		return negated;
 	}
@@ -110,6 +116,14 @@ public:
 	 */
 	gcc_pure
 	bool MatchWithoutNegation(const char *s) const noexcept;
+
+	/**
+	 * Like MatchWithoutNegation(const char *), but for an item
+	 * from the tag pool.  This uses the value length and the
+	 * case-folded value cached by the pool.
+	 */
+	gcc_pure
+	bool MatchWithoutNegation(const TagItem &item) const noexcept;
 };
 
 #endif
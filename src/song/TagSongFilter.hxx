@@ -46,6 +46,10 @@ public:
 		return filter.GetValue();
 	}
 
+	const StringFilter &GetFilter() const noexcept {
+		return filter;
+	}
+
 	bool GetFoldCase() const {
 		return filter.GetFoldCase();
 	}
@@ -55,6 +55,7 @@ TagBuilder::TagBuilder(Tag &&other) noexcept
 	other.num_items = 0;
 	delete[] other.items;
 	other.items = nullptr;
+	other.UpdateIndex();
 }
 
 TagBuilder &
@@ -100,6 +101,7 @@ TagBuilder::operator=(Tag &&other) noexcept
 	other.num_items = 0;
 	delete[] other.items;
 	other.items = nullptr;
+	other.UpdateIndex();
 
 	return *this;
 }
@@ -129,6 +131,7 @@ TagBuilder::Commit(Tag &tag) noexcept
 	tag.items = new TagItem *[n_items];
 	std::copy_n(items.begin(), n_items, tag.items);
 	items.clear();
+	tag.UpdateIndex();
 
 	/* now ensure that this object is fresh (will not delete any
 	   items because we've already moved them out) */
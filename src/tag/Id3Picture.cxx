@@ -26,13 +26,27 @@
 #include <cstdint>
 #include <string>
 
+#include <string.h>
+
+/**
+ * Read a big-endian 32 bit integer from a possibly unaligned
+ * address.
+ */
+static uint32_t
+ReadBE32(const uint8_t *p) noexcept
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return FromBE32(value);
+}
+
 static StringView
 ReadString(ConstBuffer<uint8_t> &src) noexcept
 {
 	if (src.size < 4)
 		return nullptr;
 
-	const size_t length = FromBE32(*(const uint32_t *)src.data);
+	const size_t length = ReadBE32(src.data);
 	src.skip_front(4);
 
 	if (src.size < length)
@@ -65,7 +79,7 @@ ScanId3Apic(ConstBuffer<void> _buffer, TagHandler &handler) noexcept
 
 	buffer.skip_front(16);
 
-	const size_t image_size = FromBE32(*(const uint32_t *)buffer.data);
+	const size_t image_size = ReadBE32(buffer.data);
 	buffer.skip_front(4);
 
 	if (buffer.size < image_size)
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_TAG_ITEM_MAP_HXX
+#define MPD_TAG_ITEM_MAP_HXX
+
+#include "Pool.hxx"
+#include "Item.hxx"
+
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * A hash map with interned #TagItem keys which are compared by their
+ * address instead of their value.  This is a cheap way to aggregate
+ * tag values; the caller converts the (few) keys to strings when it
+ * is done.
+ *
+ * The map holds a tag pool reference on each key, so keys remain
+ * valid (and no other value can get the same address) even after
+ * the #Tag they came from has been freed.  Two different keys may
+ * still have the same value (e.g. the same string with different
+ * tag types), so the caller must be prepared to merge them.
+ *
+ * A nullptr key is allowed; it can be used for "no value".
+ */
+template<typename T>
+class TagItemMap {
+	using Map = std::unordered_map<TagItem *, T>;
+	Map map;
+
+public:
+	TagItemMap() = default;
+
+	TagItemMap(TagItemMap &&src) noexcept
+		:map(std::move(src.map)) {
+		src.map.clear();
+	}
+
+	~TagItemMap() noexcept {
+		if (map.empty())
+			return;
+
+		const std::lock_guard<Mutex> protect(tag_pool_lock);
+		for (auto &i : map)
+			if (i.first != nullptr)
+				tag_pool_put_item(i.first);
+	}
+
+	TagItemMap &operator=(const TagItemMap &) = delete;
+
+	T &operator[](const TagItem *_item) noexcept {
+		auto *item = const_cast<TagItem *>(_item);
+
+		auto i = map.find(item);
+		if (i != map.end())
+			return i->second;
+
+		if (item != nullptr) {
+			/* obtain a reference; this may return a
+			   different item if the reference counter
+			   would overflow */
+			const std::lock_guard<Mutex> protect(tag_pool_lock);
+			item = tag_pool_dup_item(item);
+		}
+
+		auto r = map.try_emplace(item);
+		if (!r.second && item != nullptr) {
+			/* we already had a reference to this one */
+			const std::lock_guard<Mutex> protect(tag_pool_lock);
+			tag_pool_put_item(item);
+		}
+
+		return r.first->second;
+	}
+
+	bool empty() const noexcept {
+		return map.empty();
+	}
+
+	auto begin() const noexcept {
+		return map.begin();
+	}
+
+	auto end() const noexcept {
+		return map.end();
+	}
+};
+
+#endif
@@ -23,6 +23,12 @@
 #include "util/VarSize.hxx"
 #include "util/StringView.hxx"
 
+#ifdef HAVE_ICU_CASE_FOLD
+#include "util/AllocatedString.hxx"
+
+#include <atomic>
+#endif
+
 #include <cassert>
 #include <cstdint>
 #include <limits>
@@ -36,19 +42,56 @@ static constexpr size_t NUM_SLOTS = 16127;
 
 struct TagPoolSlot {
 	TagPoolSlot *next;
-	uint8_t ref = 1;
+
+#ifdef HAVE_ICU_CASE_FOLD
+	/**
+	 * The case-folded value, calculated on demand by
+	 * tag_pool_get_folded().  Points to #item's value if folding
+	 * did not change it; else it was allocated by
+	 * IcuCaseFold() (with new[]).
+	 */
+	std::atomic<char *> folded{nullptr};
+
+	/**
+	 * The length of #folded.  It is stored before #folded is
+	 * published, and all racing writers store the same value.
+	 */
+	std::atomic<uint32_t> folded_length{0};
+#endif
+
+	/**
+	 * The length of the value (not including the null
+	 * terminator).
+	 */
+	uint32_t length;
+
+	/**
+	 * The reference counter.  It is wide enough that all
+	 * references to one value share a slot in practice, which
+	 * makes an item's address unique for its type and value
+	 * (see TagItemMap).
+	 */
+	uint32_t ref = 1;
 	TagItem item;
 
 	static constexpr unsigned MAX_REF = std::numeric_limits<decltype(ref)>::max();
 
 	TagPoolSlot(TagPoolSlot *_next, TagType type,
 		    StringView value) noexcept
-		:next(_next) {
+		:next(_next), length(value.size) {
 		item.type = type;
 		memcpy(item.value, value.data, value.size);
 		item.value[value.size] = 0;
 	}
 
+#ifdef HAVE_ICU_CASE_FOLD
+	~TagPoolSlot() noexcept {
+		char *f = folded.load(std::memory_order_relaxed);
+		if (f != item.value)
+			delete[] f;
+	}
+#endif
+
 	static TagPoolSlot *Create(TagPoolSlot *_next, TagType type,
 				   StringView value) noexcept;
 };
@@ -169,3 +212,49 @@ tag_pool_put_item(TagItem *item) noexcept
 	*slot_p = slot->next;
 	DeleteVarSize(slot);
 }
+
+std::string_view
+tag_pool_get_value(const TagItem &item) noexcept
+{
+	const auto *slot = tag_item_to_slot(const_cast<TagItem *>(&item));
+	return {item.value, slot->length};
+}
+
+#ifdef HAVE_ICU_CASE_FOLD
+
+std::string_view
+tag_pool_get_folded(const TagItem &item) noexcept
+{
+	auto *slot = tag_item_to_slot(const_cast<TagItem *>(&item));
+
+	char *folded = slot->folded.load(std::memory_order_acquire);
+	if (folded != nullptr)
+		return {folded, slot->folded_length.load(std::memory_order_relaxed)};
+
+	auto f = IcuCaseFold(item.value);
+	char *value = const_cast<char *>(item.value);
+	char *expected = nullptr;
+
+	if (f.IsNull() || strcmp(f.c_str(), item.value) == 0) {
+		/* share the original value */
+		slot->folded_length.store(slot->length,
+					  std::memory_order_relaxed);
+		if (slot->folded.compare_exchange_strong(expected, value,
+							 std::memory_order_acq_rel))
+			return {value, slot->length};
+	} else {
+		const uint32_t length = strlen(f.c_str());
+		slot->folded_length.store(length, std::memory_order_relaxed);
+		folded = f.Steal();
+		if (slot->folded.compare_exchange_strong(expected, folded,
+							 std::memory_order_acq_rel))
+			return {folded, length};
+
+		/* another thread was faster */
+		delete[] folded;
+	}
+
+	return {expected, slot->folded_length.load(std::memory_order_relaxed)};
+}
+
+#endif
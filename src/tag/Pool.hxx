@@ -22,6 +22,10 @@
 
 #include "Type.h"
 #include "thread/Mutex.hxx"
+#include "lib/icu/CaseFold.hxx"
+#include "util/Compiler.h"
+
+#include <string_view>
 
 extern Mutex tag_pool_lock;
 
@@ -37,4 +41,30 @@ tag_pool_dup_item(TagItem *item) noexcept;
 void
 tag_pool_put_item(TagItem *item) noexcept;
 
+/**
+ * Returns the value of an item obtained from tag_pool_get_item(),
+ * including its length (which is stored in the pool, so this does
+ * not need strlen()).
+ */
+gcc_pure
+std::string_view
+tag_pool_get_value(const TagItem &item) noexcept;
+
+#ifdef HAVE_ICU_CASE_FOLD
+
+/**
+ * Returns the case-folded value (see IcuCaseFold()) of an item
+ * obtained from tag_pool_get_item().  It is calculated on the first
+ * call and then cached in the pool, so case-insensitive searches
+ * don't need to fold each value again.
+ *
+ * This function is thread-safe; the caller does not need to hold
+ * #tag_pool_lock, but it must own a reference to the item.
+ */
+gcc_pure
+std::string_view
+tag_pool_get_folded(const TagItem &item) noexcept;
+
+#endif
+
 #endif
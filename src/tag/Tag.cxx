@@ -38,11 +38,13 @@ Tag::Clear() noexcept
 	delete[] items;
 	items = nullptr;
 	num_items = 0;
+	UpdateIndex();
 }
 
 Tag::Tag(const Tag &other) noexcept
 	:duration(other.duration), has_playlist(other.has_playlist),
-	 num_items(other.num_items)
+	 num_items(other.num_items),
+	 mask(other.mask), type_index(other.type_index)
 {
 	if (num_items > 0) {
 		items = new TagItem *[num_items];
@@ -73,11 +75,61 @@ Tag::Merge(std::unique_ptr<Tag> base, std::unique_ptr<Tag> add) noexcept
 	return Merge(*base, *add);
 }
 
+/**
+ * Returns the #Tag::type_index slot for the given type, or -1 if
+ * this type is not indexed.  These are the types used by
+ * song_cmp() and the most common "sort" and "group" types.
+ */
+static constexpr int
+GetIndexSlot(TagType type) noexcept
+{
+	switch (type) {
+	case TAG_ARTIST:
+		return 0;
+
+	case TAG_ALBUM:
+		return 1;
+
+	case TAG_ALBUM_ARTIST:
+		return 2;
+
+	case TAG_TRACK:
+		return 3;
+
+	default:
+		return -1;
+	}
+}
+
+void
+Tag::UpdateIndex() noexcept
+{
+	mask = TagMask::None();
+	type_index.fill(NO_INDEX);
+
+	/* walk backwards, so the first item of each type wins */
+	for (unsigned i = num_items; i-- > 0;) {
+		const TagType type = items[i]->type;
+		mask.Set(type);
+
+		const int slot = GetIndexSlot(type);
+		if (slot >= 0 && i < NO_INDEX)
+			type_index[slot] = i;
+	}
+}
+
 const char *
 Tag::GetValue(TagType type) const noexcept
 {
 	assert(type < TAG_NUM_OF_ITEM_TYPES);
 
+	if (!mask.Test(type))
+		return nullptr;
+
+	const int slot = GetIndexSlot(type);
+	if (slot >= 0 && type_index[slot] != NO_INDEX)
+		return items[type_index[slot]]->value;
+
 	for (const auto &item : *this)
 		if (item.type == type)
 			return item.value;
@@ -85,12 +137,6 @@ Tag::GetValue(TagType type) const noexcept
 	return nullptr;
 }
 
-bool
-Tag::HasType(TagType type) const noexcept
-{
-	return GetValue(type) != nullptr;
-}
-
 static TagType
 DecaySort(TagType type) noexcept
 {
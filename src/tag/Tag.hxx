@@ -23,9 +23,12 @@
 #include "Type.h" // IWYU pragma: export
 #include "Item.hxx" // IWYU pragma: export
 #include "Chrono.hxx"
+#include "Mask.hxx"
 #include "util/Compiler.h"
 #include "util/DereferenceIterator.hxx"
 
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <utility>
 
@@ -49,6 +52,24 @@ struct Tag {
 	/** the total number of tag items in the #items array */
 	unsigned short num_items = 0;
 
+	/**
+	 * The types of all items in the #items array, for quick
+	 * absence checks.  Must be updated with UpdateIndex() after
+	 * modifying #items.
+	 */
+	TagMask mask = TagMask::None();
+
+	static constexpr uint8_t NO_INDEX = 0xff;
+
+	/**
+	 * For a few frequently used tag types (see
+	 * GetIndexSlot()): the position of the first item of that
+	 * type in the #items array, or #NO_INDEX if there is none
+	 * (or if the position is too large).  Must be updated with
+	 * UpdateIndex() after modifying #items.
+	 */
+	std::array<uint8_t, 4> type_index{NO_INDEX, NO_INDEX, NO_INDEX, NO_INDEX};
+
 	/** an array of tag items */
 	TagItem **items = nullptr;
 
@@ -61,9 +82,12 @@ struct Tag {
 
 	Tag(Tag &&other) noexcept
 		:duration(other.duration), has_playlist(other.has_playlist),
-		 num_items(other.num_items), items(other.items) {
+		 num_items(other.num_items),
+		 mask(other.mask), type_index(other.type_index),
+		 items(other.items) {
 		other.items = nullptr;
 		other.num_items = 0;
+		other.UpdateIndex();
 	}
 
 	/**
@@ -89,8 +113,15 @@ struct Tag {
 	void MoveItemsFrom(Tag &&other) noexcept {
 		std::swap(items, other.items);
 		std::swap(num_items, other.num_items);
+		std::swap(mask, other.mask);
+		std::swap(type_index, other.type_index);
 	}
 
+	/**
+	 * Recalculate #mask and #type_index from the #items array.
+	 */
+	void UpdateIndex() noexcept;
+
 	/**
 	 * Returns true if the tag contains no items.  This ignores
 	 * the "duration" attribute.
@@ -141,7 +172,9 @@ struct Tag {
 	 * the specified type.
 	 */
 	gcc_pure
-	bool HasType(TagType type) const noexcept;
+	bool HasType(TagType type) const noexcept {
+		return mask.Test(type);
+	}
 
 	/**
 	 * Returns a value for sorting on the specified type, with
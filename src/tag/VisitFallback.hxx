@@ -27,6 +27,9 @@ template<typename F>
 bool
 VisitTagType(const Tag &tag, TagType type, F &&f) noexcept
 {
+	if (!tag.HasType(type))
+		return false;
+
 	bool found = false;
 
 	for (const auto &item : tag) {
@@ -57,4 +60,46 @@ VisitTagWithFallbackOrEmpty(const Tag &tag, TagType type, F &&f) noexcept
 		f("");
 }
 
+/**
+ * Like VisitTagType(), but pass the #TagItem to the function instead
+ * of only its value.
+ */
+template<typename F>
+bool
+VisitTagItems(const Tag &tag, TagType type, F &&f) noexcept
+{
+	if (!tag.HasType(type))
+		return false;
+
+	bool found = false;
+
+	for (const auto &item : tag) {
+		if (item.type == type) {
+			found = true;
+			f(item);
+		}
+	}
+
+	return found;
+}
+
+/**
+ * Like VisitTagWithFallbackOrEmpty(), but pass the #TagItem to the
+ * function instead of only its value, or nullptr if there is no
+ * matching item.
+ */
+template<typename F>
+void
+VisitTagItemsWithFallbackOrEmpty(const Tag &tag, TagType type, F &&f) noexcept
+{
+	if (!ApplyTagWithFallback(type,
+				  [&](TagType type2) {
+					  return VisitTagItems(tag, type2,
+							       [&f](const TagItem &item){
+								       f(&item);
+							       });
+				  }))
+		f(nullptr);
+}
+
 #endif
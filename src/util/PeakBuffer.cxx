@@ -133,3 +133,30 @@ PeakBuffer::Append(const void *data, size_t length)
 	nbytes = AppendTo(*peak_buffer, data, length);
 	return nbytes == length;
 }
+
+WritableBuffer<void>
+PeakBuffer::Write() noexcept
+{
+	if (peak_buffer != nullptr && !peak_buffer->empty())
+		return peak_buffer->Write().ToVoid();
+
+	if (normal_buffer == nullptr)
+		normal_buffer = new DynamicFifoBuffer<uint8_t>(normal_size);
+
+	return normal_buffer->Write().ToVoid();
+}
+
+void
+PeakBuffer::Append(size_t length) noexcept
+{
+	if (length == 0)
+		return;
+
+	if (peak_buffer != nullptr && !peak_buffer->empty()) {
+		peak_buffer->Append(length);
+		return;
+	}
+
+	assert(normal_buffer != nullptr);
+	normal_buffer->Append(length);
+}
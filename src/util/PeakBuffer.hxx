@@ -65,6 +65,20 @@ public:
 	void Consume(size_t length) noexcept;
 
 	bool Append(const void *data, size_t length);
+
+	/**
+	 * Prepare writing directly into the buffer.  Returns a
+	 * writable area at the tail of the buffer, or an empty buffer
+	 * if the caller should use the copying Append() overload
+	 * instead.  Call Append(size_t) to commit the data.
+	 */
+	WritableBuffer<void> Write() noexcept;
+
+	/**
+	 * Commit data which was written into the area returned by
+	 * Write().
+	 */
+	void Append(size_t length) noexcept;
 };
 
 #endif
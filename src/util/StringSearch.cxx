@@ -0,0 +1,177 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "StringSearch.hxx"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <string.h>
+
+#ifndef __SSE2__
+
+/**
+ * Portable implementation: let memchr() find candidates for the
+ * first byte, and compare the rest with memcmp().
+ */
+static const char *
+FindSubstringGeneric(const char *haystack, size_t haystack_length,
+		     const char *needle, size_t needle_length) noexcept
+{
+	while (haystack_length >= needle_length) {
+		const char *p = (const char *)
+			memchr(haystack, needle[0],
+			       haystack_length - needle_length + 1);
+		if (p == nullptr)
+			return nullptr;
+
+		if (memcmp(p + 1, needle + 1, needle_length - 1) == 0)
+			return p;
+
+		haystack_length -= p + 1 - haystack;
+		haystack = p + 1;
+	}
+
+	return nullptr;
+}
+
+#endif
+
+/**
+ * Byte-wise implementation for haystacks which are too short for
+ * one SIMD block.  Comparing the first and the last byte before
+ * calling memcmp() rejects most positions cheaply.
+ */
+static inline const char *
+FindSubstringShort(const char *haystack, size_t n_positions,
+		   const char *needle, size_t needle_length) noexcept
+{
+	const char first = needle[0], last = needle[needle_length - 1];
+
+	for (size_t i = 0; i < n_positions; ++i)
+		if (haystack[i] == first &&
+		    haystack[i + needle_length - 1] == last &&
+		    memcmp(haystack + i + 1, needle + 1,
+			   needle_length - 2) == 0)
+			return haystack + i;
+
+	return nullptr;
+}
+
+#ifdef __SSE2__
+
+/**
+ * Check a bit mask of candidate positions (where the first and the
+ * last needle byte match) with memcmp().
+ */
+static inline const char *
+CheckCandidates(const char *p, unsigned mask,
+		const char *needle, size_t needle_length) noexcept
+{
+	while (mask != 0) {
+		const unsigned bit = __builtin_ctz(mask);
+		if (memcmp(p + bit + 1, needle + 1, needle_length - 2) == 0)
+			return p + bit;
+
+		mask &= mask - 1;
+	}
+
+	return nullptr;
+}
+
+/**
+ * Compare the first and the last needle byte at 16 haystack
+ * positions at once; only positions where both match are verified
+ * with memcmp().  The last block overlaps the previous one instead
+ * of falling back to a byte-wise loop for the tail.
+ *
+ * SSE2 is part of the x86-64 baseline, so this needs neither
+ * special compiler flags nor run-time CPU detection.
+ */
+static const char *
+FindSubstringSSE2(const char *haystack, size_t haystack_length,
+		  const char *needle, size_t needle_length) noexcept
+{
+	constexpr size_t BLOCK = sizeof(__m128i);
+
+	/* the number of positions where the needle may start */
+	const size_t n_positions = haystack_length - needle_length + 1;
+	if (n_positions < BLOCK)
+		return FindSubstringShort(haystack, n_positions,
+					  needle, needle_length);
+
+	const __m128i first = _mm_set1_epi8(needle[0]);
+	const __m128i last = _mm_set1_epi8(needle[needle_length - 1]);
+
+	const auto candidates = [&](size_t i){
+		const __m128i block_first = _mm_loadu_si128((const __m128i *)
+							    (haystack + i));
+		const __m128i block_last = _mm_loadu_si128((const __m128i *)
+							   (haystack + i + needle_length - 1));
+		return (unsigned)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+								  _mm_cmpeq_epi8(last, block_last)));
+	};
+
+	size_t i = 0;
+	for (; i + BLOCK <= n_positions; i += BLOCK) {
+		const char *p = CheckCandidates(haystack + i, candidates(i),
+						needle, needle_length);
+		if (p != nullptr)
+			return p;
+	}
+
+	if (i < n_positions) {
+		/* the last (overlapping) block; mask out the
+		   positions which have already been checked */
+		const size_t j = n_positions - BLOCK;
+		const unsigned mask = candidates(j) & (~0U << (i - j));
+		return CheckCandidates(haystack + j, mask,
+				       needle, needle_length);
+	}
+
+	return nullptr;
+}
+
+#endif
+
+const char *
+FindSubstring(std::string_view haystack, std::string_view needle) noexcept
+{
+	if (needle.size() > haystack.size())
+		return nullptr;
+
+	switch (needle.size()) {
+	case 0:
+		return haystack.data();
+
+	case 1:
+		return (const char *)memchr(haystack.data(), needle.front(),
+					    haystack.size());
+	}
+
+#ifdef __SSE2__
+	return FindSubstringSSE2(haystack.data(), haystack.size(),
+				 needle.data(), needle.size());
+#else
+	return FindSubstringGeneric(haystack.data(), haystack.size(),
+				    needle.data(), needle.size());
+#endif
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef MPD_STRING_SEARCH_HXX
+#define MPD_STRING_SEARCH_HXX
+
+#include "Compiler.h"
+
+#include <string_view>
+
+/**
+ * Find the first occurrence of #needle in #haystack.  Unlike
+ * strstr(), both strings have a known length, which allows
+ * comparing many haystack positions at a time with SIMD
+ * instructions (where available): candidates are only positions
+ * where both the first and the last byte of the needle match.
+ *
+ * @return a pointer to the match within #haystack or nullptr if
+ * there is none
+ */
+gcc_pure
+const char *
+FindSubstring(std::string_view haystack, std::string_view needle) noexcept;
+
+gcc_pure
+static inline bool
+ContainsSubstring(std::string_view haystack, std::string_view needle) noexcept
+{
+	return FindSubstring(haystack, needle) != nullptr;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_TEST_MEMORY_INPUT_STREAM_HXX
+#define MPD_TEST_MEMORY_INPUT_STREAM_HXX
+
+#include "input/InputStream.hxx"
+#include "thread/Mutex.hxx"
+#include "util/ConstBuffer.hxx"
+
+#include <algorithm>
+
+#include <string.h>
+
+/**
+ * A seekable #InputStream reading from a buffer in memory, for unit
+ * tests of the header parsers.  The buffer is not copied.
+ */
+class MemoryInputStream final : public InputStream {
+	ConstBuffer<uint8_t> data;
+
+public:
+	MemoryInputStream(Mutex &_mutex, ConstBuffer<void> _data) noexcept
+		:InputStream("memory://", _mutex),
+		 data(ConstBuffer<uint8_t>::FromVoid(_data)) {
+		size = data.size;
+		seekable = true;
+		SetReady();
+	}
+
+	/* virtual methods from InputStream */
+	bool IsEOF() const noexcept override {
+		return offset >= size;
+	}
+
+	void Seek(std::unique_lock<Mutex> &, offset_type new_offset) override {
+		offset = new_offset;
+	}
+
+	size_t Read(std::unique_lock<Mutex> &,
+		    void *ptr, size_t read_size) override {
+		if (IsEOF())
+			return 0;
+
+		const size_t nbytes = std::min<offset_type>(size - offset,
+							    read_size);
+		memcpy(ptr, data.data + offset, nbytes);
+		offset += nbytes;
+		return nbytes;
+	}
+};
+
+#endif
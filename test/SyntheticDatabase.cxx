@@ -0,0 +1,141 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "SyntheticDatabase.hxx"
+#include "db/DatabasePlugin.hxx"
+#include "db/Selection.hxx"
+#include "db/Stats.hxx"
+#include "db/UniqueTags.hxx"
+#include "song/LightSong.hxx"
+#include "tag/Builder.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/RecursiveMap.hxx"
+
+#include <iterator>
+#include <stdexcept>
+
+#include <stdio.h>
+
+static constexpr const char *words[] = {
+	"Blue", "Night", "River", "Stone", "Fire", "Glass", "Winter",
+	"Heart", "Ocean", "Light", "Shadow", "Gold", "Rain", "Iron",
+	"Silver", "Dream",
+};
+
+static constexpr unsigned n_words = std::size(words);
+
+SyntheticSong
+MakeSyntheticSong(unsigned i)
+{
+	char buffer[64];
+	TagBuilder b;
+
+	const unsigned artist = i / 128;
+
+	snprintf(buffer, sizeof(buffer), "Artist %04u", artist);
+	b.AddItem(TAG_ARTIST, buffer);
+
+	if (artist % 3 == 0) {
+		snprintf(buffer, sizeof(buffer), "Album Artist %04u",
+			 artist);
+		b.AddItem(TAG_ALBUM_ARTIST, buffer);
+	}
+
+	snprintf(buffer, sizeof(buffer), "%s %s",
+		 words[(i / 16) % n_words], words[(i / 7) % n_words]);
+	b.AddItem(TAG_ALBUM, buffer);
+
+	snprintf(buffer, sizeof(buffer), "%s of the %s %u",
+		 words[i % n_words], words[(i / 3) % n_words], i);
+	b.AddItem(TAG_TITLE, buffer);
+
+	b.AddItem(TAG_GENRE, words[(i / 1000) % n_words]);
+
+	snprintf(buffer, sizeof(buffer), "%u", 1960 + (i / 16) % 61);
+	b.AddItem(TAG_DATE, buffer);
+
+	snprintf(buffer, sizeof(buffer), "Artist%04u/Album%02u/%02u.ogg",
+		 artist, (i / 16) % 8, i % 16);
+
+	return {buffer, b.Commit()};
+}
+
+std::vector<SyntheticSong>
+MakeSyntheticSongs(unsigned n)
+{
+	std::vector<SyntheticSong> songs;
+	songs.reserve(n);
+	for (unsigned i = 0; i < n; ++i)
+		songs.emplace_back(MakeSyntheticSong(i));
+	return songs;
+}
+
+static constexpr DatabasePlugin synthetic_database_plugin = {
+	"synthetic",
+	0,
+	nullptr,
+};
+
+SyntheticDatabase::SyntheticDatabase(const std::vector<SyntheticSong> &_songs) noexcept
+	:Database(synthetic_database_plugin), songs(_songs) {}
+
+const LightSong *
+SyntheticDatabase::GetSong(std::string_view) const
+{
+	throw std::runtime_error("Not implemented");
+}
+
+void
+SyntheticDatabase::ReturnSong(const LightSong *) const noexcept
+{
+}
+
+void
+SyntheticDatabase::Visit(const DatabaseSelection &selection,
+			 VisitDirectory, VisitSong visit_song,
+			 VisitPlaylist) const
+{
+	if (!visit_song)
+		return;
+
+	for (const auto &song : songs) {
+		const LightSong light_song(song.uri.c_str(), song.tag);
+		if (selection.Match(light_song))
+			visit_song(light_song);
+	}
+}
+
+RecursiveMap<std::string>
+SyntheticDatabase::CollectUniqueTags(const DatabaseSelection &selection,
+				     ConstBuffer<TagType> tag_types) const
+{
+	return ::CollectUniqueTags(*this, selection, tag_types);
+}
+
+DatabaseStats
+SyntheticDatabase::GetStats(const DatabaseSelection &) const
+{
+	throw std::runtime_error("Not implemented");
+}
+
+std::chrono::system_clock::time_point
+SyntheticDatabase::GetUpdateStamp() const noexcept
+{
+	return {};
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef MPD_TEST_SYNTHETIC_DATABASE_HXX
+#define MPD_TEST_SYNTHETIC_DATABASE_HXX
+
+#include "db/Interface.hxx"
+#include "tag/Tag.hxx"
+
+#include <string>
+#include <vector>
+
+/**
+ * A song which exists only in memory, for benchmarks and unit
+ * tests.
+ */
+struct SyntheticSong {
+	std::string uri;
+	Tag tag;
+};
+
+/**
+ * Generate the song with the given index.  There are 128 songs per
+ * "Artist", one third of all artists also have an "AlbumArtist",
+ * and album names and titles are made of a small set of words.
+ */
+SyntheticSong
+MakeSyntheticSong(unsigned i);
+
+std::vector<SyntheticSong>
+MakeSyntheticSongs(unsigned n);
+
+/**
+ * A #Database which visits songs from a std::vector.  It implements
+ * only Visit() and CollectUniqueTags().
+ */
+class SyntheticDatabase final : public Database {
+	const std::vector<SyntheticSong> &songs;
+
+public:
+	explicit SyntheticDatabase(const std::vector<SyntheticSong> &_songs) noexcept;
+
+	const LightSong *GetSong(std::string_view uri) const override;
+	void ReturnSong(const LightSong *song) const noexcept override;
+
+	void Visit(const DatabaseSelection &selection,
+		   VisitDirectory visit_directory,
+		   VisitSong visit_song,
+		   VisitPlaylist visit_playlist) const override;
+
+	RecursiveMap<std::string> CollectUniqueTags(const DatabaseSelection &selection,
+						    ConstBuffer<TagType> tag_types) const override;
+
+	DatabaseStats GetStats(const DatabaseSelection &selection) const override;
+
+	std::chrono::system_clock::time_point GetUpdateStamp() const noexcept override;
+};
+
+#endif
@@ -0,0 +1,268 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MemoryInputStream.hxx"
+#include "lib/xiph/FlacHeaderScan.hxx"
+#include "pcm/AudioFormat.hxx"
+#include "tag/Handler.hxx"
+#include "tag/Type.h"
+#include "thread/Mutex.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/StringBuffer.hxx"
+#include "util/StringView.hxx"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * A #TagHandler which records all calls as strings.
+ */
+class RecordingTagHandler final : public NullTagHandler {
+public:
+	std::vector<std::string> log;
+
+	explicit RecordingTagHandler(unsigned _want_mask=WANT_DURATION|WANT_TAG|
+				     WANT_AUDIO_FORMAT|WANT_PICTURE) noexcept
+		:NullTagHandler(_want_mask) {}
+
+	void OnDuration(SongTime duration) noexcept override {
+		log.emplace_back("duration=" +
+				 std::to_string(duration.ToMS()));
+	}
+
+	void OnTag(TagType type, StringView value) noexcept override {
+		log.emplace_back(std::string(tag_item_names[type]) + "=" +
+				 std::string(value.data, value.size));
+	}
+
+	void OnAudioFormat(AudioFormat af) noexcept override {
+		log.emplace_back("format=" +
+				 std::string(ToString(af).c_str()));
+	}
+
+	void OnPicture(const char *mime_type,
+		       ConstBuffer<void> buffer) noexcept override {
+		log.emplace_back(std::string("picture=") + mime_type + " " +
+				 std::to_string(buffer.size));
+	}
+};
+
+static std::string
+BE32(uint32_t value)
+{
+	return {char(value >> 24), char(value >> 16), char(value >> 8),
+		char(value)};
+}
+
+static std::string
+LE32(uint32_t value)
+{
+	return {char(value), char(value >> 8), char(value >> 16),
+		char(value >> 24)};
+}
+
+enum BlockType : uint8_t {
+	STREAMINFO = 0,
+	PADDING = 1,
+	VORBIS_COMMENT = 4,
+	PICTURE = 6,
+};
+
+static std::string
+BlockHeader(uint8_t type, size_t size, bool last=false)
+{
+	return {char(type | (last ? 0x80 : 0)),
+		char(size >> 16), char(size >> 8), char(size)};
+}
+
+static std::string
+Block(uint8_t type, const std::string &body, bool last=false)
+{
+	return BlockHeader(type, body.size(), last) + body;
+}
+
+static std::string
+StreamInfo(unsigned sample_rate, unsigned channels, unsigned bits,
+	   uint64_t total_samples)
+{
+	const uint64_t packed = (uint64_t(sample_rate) << 44) |
+		(uint64_t(channels - 1) << 41) |
+		(uint64_t(bits - 1) << 36) |
+		total_samples;
+
+	return Block(STREAMINFO, std::string(10, 0) +
+		     BE32(packed >> 32) + BE32(packed) +
+		     std::string(16, 0));
+}
+
+static std::string
+VorbisComment(const std::vector<std::string> &comments)
+{
+	std::string body = LE32(6) + "vendor" + LE32(comments.size());
+	for (const auto &i : comments)
+		body += LE32(i.size()) + i;
+	return Block(VORBIS_COMMENT, body);
+}
+
+static std::string
+Picture(const std::string &mime_type, const std::string &data)
+{
+	return Block(PICTURE, BE32(3) +
+		     BE32(mime_type.size()) + mime_type +
+		     BE32(0) + std::string(16, 0) +
+		     BE32(data.size()) + data);
+}
+
+static std::string
+Last()
+{
+	return Block(PADDING, "", true);
+}
+
+static bool
+Scan(const std::string &file, RecordingTagHandler &handler)
+{
+	Mutex mutex;
+	MemoryInputStream is(mutex, {file.data(), file.size()});
+	try {
+		return ScanFlacHeader(is, handler);
+	} catch (const std::runtime_error &) {
+		return false;
+	}
+}
+
+TEST(FlacHeaderScan, Basic)
+{
+	const std::string file = "fLaC" +
+		StreamInfo(44100, 2, 16, 441000) +
+		Block(PADDING, std::string(1000, 0)) +
+		VorbisComment({"TITLE=Foo", "ARTIST=Bar", "", "X"}) +
+		Picture("image/png", "png") +
+		Picture("-->", "http://example.com/") +
+		Last() +
+		std::string(100, 'x');
+
+	RecordingTagHandler handler;
+	ASSERT_TRUE(Scan(file, handler));
+
+	const std::vector<std::string> expected{
+		"duration=10000",
+		"format=44100:16:2",
+		"Title=Foo",
+		"Artist=Bar",
+		"picture=image/png 3",
+	};
+	EXPECT_EQ(expected, handler.log);
+
+	/* pictures are skipped if they are not wanted */
+	RecordingTagHandler handler2(TagHandler::WANT_TAG);
+	ASSERT_TRUE(Scan(file, handler2));
+	EXPECT_EQ(4u, handler2.log.size());
+}
+
+TEST(FlacHeaderScan, Malformed)
+{
+	RecordingTagHandler handler;
+
+	EXPECT_FALSE(Scan("", handler));
+	EXPECT_FALSE(Scan("OggS", handler));
+
+	/* STREAMINFO is not the first block */
+	EXPECT_FALSE(Scan("fLaC" + VorbisComment({}) +
+			  StreamInfo(44100, 2, 16, 0) + Last(), handler));
+
+	/* two STREAMINFO blocks */
+	EXPECT_FALSE(Scan("fLaC" + StreamInfo(44100, 2, 16, 0) +
+			  StreamInfo(44100, 2, 16, 0) + Last(), handler));
+
+	/* STREAMINFO too small */
+	EXPECT_FALSE(Scan("fLaC" + Block(STREAMINFO, std::string(20, 0)) +
+			  Last(), handler));
+
+	/* two VORBIS_COMMENT blocks */
+	EXPECT_FALSE(Scan("fLaC" + StreamInfo(44100, 2, 16, 0) +
+			  VorbisComment({"TITLE=Foo"}) +
+			  VorbisComment({"TITLE=Bar"}) + Last(), handler));
+
+	/* invalid block type */
+	EXPECT_FALSE(Scan("fLaC" + StreamInfo(44100, 2, 16, 0) +
+			  Block(127, "") + Last(), handler));
+
+	/* a comment longer than the block */
+	EXPECT_FALSE(Scan("fLaC" + StreamInfo(44100, 2, 16, 0) +
+			  Block(VORBIS_COMMENT, LE32(0) + LE32(1) +
+				LE32(100) + "TITLE=Foo") +
+			  Last(), handler));
+
+	/* nothing must be submitted if parsing fails */
+	EXPECT_TRUE(handler.log.empty());
+
+	/* the audio format is invalid, but the tags are still
+	   submitted */
+	ASSERT_TRUE(Scan("fLaC" + StreamInfo(44100, 2, 12, 441000) +
+			 VorbisComment({"TITLE=Foo"}) + Last(), handler));
+	const std::vector<std::string> expected{
+		"duration=10000",
+		"Title=Foo",
+	};
+	EXPECT_EQ(expected, handler.log);
+}
+
+TEST(FlacHeaderScan, Oversized)
+{
+	RecordingTagHandler handler;
+
+	/* a VORBIS_COMMENT block larger than MAX_COMMENT_SIZE is
+	   left to libFLAC */
+	EXPECT_FALSE(Scan("fLaC" + StreamInfo(44100, 2, 16, 0) +
+			  BlockHeader(VORBIS_COMMENT, 0xffffff, true) +
+			  std::string(100, 0),
+			  handler));
+
+	/* blocks larger than the file */
+	EXPECT_FALSE(Scan("fLaC" + StreamInfo(44100, 2, 16, 0) +
+			  BlockHeader(PADDING, 0x100000) +
+			  std::string(100, 0),
+			  handler));
+	EXPECT_FALSE(Scan("fLaC" + StreamInfo(44100, 2, 16, 0) +
+			  BlockHeader(PICTURE, 0x100000, true) +
+			  std::string(100, 0),
+			  handler));
+
+	EXPECT_TRUE(handler.log.empty());
+}
+
+TEST(FlacHeaderScan, Truncated)
+{
+	const std::string file = "fLaC" +
+		StreamInfo(44100, 2, 16, 441000) +
+		VorbisComment({"TITLE=Foo"}) +
+		Picture("image/png", "png") +
+		Last();
+
+	RecordingTagHandler handler;
+	for (size_t length = 0; length < file.size(); ++length)
+		EXPECT_FALSE(Scan(file.substr(0, length), handler)) << length;
+
+	EXPECT_TRUE(handler.log.empty());
+}
@@ -0,0 +1,384 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MemoryInputStream.hxx"
+#include "decoder/plugins/Mp4Scan.hxx"
+#include "thread/Mutex.hxx"
+#include "util/ConstBuffer.hxx"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+using std::string_literals::operator""s;
+
+static std::string
+BE16(uint16_t value)
+{
+	return {char(value >> 8), char(value)};
+}
+
+static std::string
+BE32(uint32_t value)
+{
+	return BE16(value >> 16) + BE16(value);
+}
+
+static std::string
+BE64(uint64_t value)
+{
+	return BE32(value >> 32) + BE32(value);
+}
+
+static std::string
+Box(const char *type, const std::string &body)
+{
+	return BE32(8 + body.size()) + type + body;
+}
+
+static std::string
+Ftyp()
+{
+	return Box("ftyp", "M4A "s + BE32(0) + "M4A mp42isom");
+}
+
+static std::string
+Mvhd(uint32_t time_scale)
+{
+	return Box("mvhd", std::string(12, 0) + BE32(time_scale) + BE32(0) +
+		   std::string(80, 0));
+}
+
+static std::string
+Elst(uint32_t duration)
+{
+	return Box("edts", Box("elst", BE32(0) + BE32(1) +
+			       BE32(duration) + BE32(2112) +
+			       BE32(0x10000)));
+}
+
+static std::string
+Elst64(uint64_t duration)
+{
+	return Box("edts", Box("elst", BE32(0x01000000) + BE32(1) +
+			       BE64(duration) + BE64(2112) +
+			       BE32(0x10000)));
+}
+
+/**
+ * An AAC LC "esds" box with an AudioSpecificConfig for 44.1 kHz
+ * stereo.
+ */
+static std::string
+Esds()
+{
+	const std::string specific = "\x05\x02\x12\x10"s;
+	const std::string config = "\x04"s + char(13 + specific.size()) +
+		"\x40\x15"s + std::string(11, 0) + specific;
+	const std::string es = "\x03"s + char(3 + config.size()) +
+		BE16(1) + '\0' + config;
+	return Box("esds", BE32(0) + es);
+}
+
+static std::string
+Mdia(uint32_t time_scale, uint32_t duration, const char *handler = "soun")
+{
+	const std::string mp4a = Box("mp4a", std::string(6, 0) + BE16(1) +
+				     BE16(0) + BE16(0) + BE32(0) +
+				     BE16(2) + BE16(16) + BE32(0) +
+				     BE32(uint32_t(44100) << 16) + Esds());
+	const std::string stsd = Box("stsd", BE32(0) + BE32(1) + mp4a);
+
+	return Box("mdia",
+		   Box("mdhd", std::string(12, 0) +
+		       BE32(time_scale) + BE32(duration) + BE32(0)) +
+		   Box("hdlr", BE32(0) + BE32(0) + handler +
+		       std::string(12, 0) + '\0') +
+		   Box("minf", Box("stbl", stsd)));
+}
+
+static std::string
+Item(const char *type, uint32_t data_type, const std::string &value)
+{
+	return Box(type, Box("data", BE32(data_type) + BE32(0) + value));
+}
+
+static std::string
+Text(const char *type, const std::string &value)
+{
+	return Item(type, 1, value);
+}
+
+static std::string
+Udta(const std::string &items)
+{
+	return Box("udta",
+		   Box("meta", BE32(0) +
+		       Box("hdlr", BE32(0) + BE32(0) + "mdirappl" +
+			   std::string(9, 0)) +
+		       Box("ilst", items)));
+}
+
+static std::string
+Moov(const std::string &items)
+{
+	return Box("moov", Mvhd(1000) +
+		   Box("trak", Mdia(44100, 441000)) +
+		   Udta(items));
+}
+
+static bool
+Scan(const std::string &file, Mp4Info &info)
+{
+	Mutex mutex;
+	MemoryInputStream is(mutex, {file.data(), file.size()});
+	return ScanMp4Header(is, info);
+}
+
+/**
+ * Like Scan(), but treat I/O errors (i.e. truncated files) as
+ * failure.
+ */
+static bool
+TryScan(const std::string &file)
+{
+	Mp4Info info;
+	try {
+		return Scan(file, info);
+	} catch (const std::runtime_error &) {
+		return false;
+	}
+}
+
+static const std::string *
+FindTag(const Mp4Info &info, const char *key)
+{
+	for (const auto &i : info.tags)
+		if (i.first == key)
+			return &i.second;
+
+	return nullptr;
+}
+
+TEST(Mp4Scan, Basic)
+{
+	const std::string file = Ftyp() +
+		Box("free", std::string(100, 0)) +
+		Box("mdat", std::string(1000, 0)) +
+		Moov(Text("\xa9nam", "Title") +
+		     Text("\xa9""ART", "Artist") +
+		     Text("aART", "Album Artist"));
+
+	Mp4Info info;
+	ASSERT_TRUE(Scan(file, info));
+	EXPECT_EQ(44100u, info.time_scale);
+	EXPECT_EQ(441000u, info.duration);
+	EXPECT_EQ(std::string("mp4a"), std::string(info.codec, 4));
+	EXPECT_EQ(2u, info.channels);
+	EXPECT_EQ(44100u, info.sample_rate);
+	EXPECT_EQ(0x40, info.object_type);
+	EXPECT_EQ(2u, info.audio_object_type);
+	EXPECT_TRUE(info.complete);
+
+	ASSERT_EQ(3u, info.tags.size());
+	EXPECT_EQ("title", info.tags[0].first);
+	EXPECT_EQ("Title", info.tags[0].second);
+	EXPECT_EQ("artist", info.tags[1].first);
+	EXPECT_EQ("Artist", info.tags[1].second);
+	EXPECT_EQ("album_artist", info.tags[2].first);
+	EXPECT_EQ("Album Artist", info.tags[2].second);
+}
+
+TEST(Mp4Scan, NotMp4)
+{
+	EXPECT_FALSE(TryScan(""));
+	EXPECT_FALSE(TryScan("fLaC"));
+	EXPECT_FALSE(TryScan(Box("moov", "") + Ftyp()));
+
+	/* no audio track */
+	Mp4Info info;
+	EXPECT_FALSE(Scan(Ftyp() + Box("moov", Mvhd(1000) +
+				      Box("trak", Mdia(25, 100, "vide"))),
+			  info));
+}
+
+TEST(Mp4Scan, EditList)
+{
+	/* 9 seconds in the movie time scale */
+	const std::string file = Ftyp() +
+		Box("moov", Mvhd(1000) +
+		    Box("trak", Elst(9000) + Mdia(44100, 441000)));
+
+	Mp4Info info;
+	ASSERT_TRUE(Scan(file, info));
+	EXPECT_EQ(9u * 44100u, info.duration);
+}
+
+TEST(Mp4Scan, EditListOverflow)
+{
+	/* edit_duration * time_scale does not fit in 64 bits, but
+	   the result does */
+	constexpr uint64_t edit_duration = uint64_t(1) << 40;
+	constexpr uint32_t movie_time_scale = 1000000;
+	constexpr uint32_t time_scale = 2000000000;
+
+	const std::string file = Ftyp() +
+		Box("moov", Mvhd(movie_time_scale) +
+		    Box("trak", Elst64(edit_duration) +
+			Mdia(time_scale, 0)));
+
+	Mp4Info info;
+	ASSERT_TRUE(Scan(file, info));
+	EXPECT_EQ(edit_duration * (time_scale / movie_time_scale),
+		  info.duration);
+}
+
+TEST(Mp4Scan, NumberPairs)
+{
+	Mp4Info info;
+	ASSERT_TRUE(Scan(Ftyp() +
+			 Moov(Item("trkn", 0, BE16(0) + BE16(3) + BE16(12) + BE16(0)) +
+			      Item("disk", 0, BE16(0) + BE16(1))),
+			 info));
+	EXPECT_TRUE(info.complete);
+
+	ASSERT_EQ(2u, info.tags.size());
+	EXPECT_EQ("track", info.tags[0].first);
+	EXPECT_EQ("3/12", info.tags[0].second);
+	EXPECT_EQ("disc", info.tags[1].first);
+	EXPECT_EQ("1", info.tags[1].second);
+}
+
+TEST(Mp4Scan, DataTypes)
+{
+	Mp4Info info;
+	ASSERT_TRUE(Scan(Ftyp() +
+			 Moov(Item("cpil", 21, "\x01"s) +
+			      Item("\xa9""day", 21, "\xff\xfe"s) +
+			      Item("\xa9""alb", 0, "Album") +
+			      Item("----", 1, "") +
+			      Box("----",
+				  Box("mean", BE32(0) + "com.apple.iTunes") +
+				  Box("name", BE32(0) + "MusicBrainz Track Id") +
+				  Box("data", BE32(1) + BE32(0) + "abc")) +
+			      Item("covr", 13, "\xff\xd8"s)),
+			 info));
+
+	/* the "----" item without "name" is not understood */
+	EXPECT_FALSE(info.complete);
+
+	ASSERT_EQ(4u, info.tags.size());
+	EXPECT_EQ("compilation", info.tags[0].first);
+	EXPECT_EQ("1", info.tags[0].second);
+	EXPECT_EQ("date", info.tags[1].first);
+	EXPECT_EQ("-2", info.tags[1].second);
+	EXPECT_EQ("album", info.tags[2].first);
+	EXPECT_EQ("Album", info.tags[2].second);
+	EXPECT_EQ("MusicBrainz Track Id", info.tags[3].first);
+	EXPECT_EQ("abc", info.tags[3].second);
+}
+
+TEST(Mp4Scan, Incomplete)
+{
+	/* libavformat maps "gnre" to a genre name */
+	Mp4Info info;
+	ASSERT_TRUE(Scan(Ftyp() + Moov(Item("gnre", 0, BE16(18))), info));
+	EXPECT_FALSE(info.complete);
+	EXPECT_EQ(nullptr, FindTag(info, "genre"));
+
+	/* unknown item */
+	info = {};
+	ASSERT_TRUE(Scan(Ftyp() + Moov(Text("xyzw", "foo")), info));
+	EXPECT_FALSE(info.complete);
+	EXPECT_TRUE(info.tags.empty());
+
+	/* Mac Roman text */
+	info = {};
+	ASSERT_TRUE(Scan(Ftyp() + Moov(Item("\xa9nam", 0, "\x8a")), info));
+	EXPECT_FALSE(info.complete);
+
+	/* "data" box too small */
+	info = {};
+	ASSERT_TRUE(Scan(Ftyp() + Moov(Box("\xa9nam", Box("data", BE32(1)))),
+			 info));
+	EXPECT_FALSE(info.complete);
+
+	/* short "trkn" */
+	info = {};
+	ASSERT_TRUE(Scan(Ftyp() + Moov(Item("trkn", 0, BE16(0))), info));
+	EXPECT_FALSE(info.complete);
+}
+
+TEST(Mp4Scan, Truncated)
+{
+	const std::string file = Ftyp() +
+		Moov(Text("\xa9nam", "Title") +
+		     Item("trkn", 0, BE16(0) + BE16(3) + BE16(12) + BE16(0)));
+	ASSERT_TRUE(TryScan(file));
+
+	for (size_t length = 0; length < file.size(); ++length)
+		EXPECT_FALSE(TryScan(file.substr(0, length))) << length;
+}
+
+TEST(Mp4Scan, Oversized)
+{
+	/* a "moov" larger than MAX_MOOV_SIZE is rejected before
+	   reading it */
+	EXPECT_FALSE(TryScan(Ftyp() + BE32(64 * 1024 * 1024) + "moov"));
+	EXPECT_FALSE(TryScan(Ftyp() + BE32(1) + "moov" +
+			     BE64(uint64_t(1) << 62)));
+
+	/* a box larger than the file */
+	EXPECT_FALSE(TryScan(Ftyp() + BE32(1000) + "mdat" +
+			     Moov(Text("\xa9nam", "Title"))));
+}
+
+TEST(Mp4Scan, Malformed)
+{
+	/* box sizes smaller than the header */
+	EXPECT_FALSE(TryScan(Ftyp() + BE32(4) + "mdat" + Moov("")));
+	EXPECT_FALSE(TryScan(Ftyp() + BE32(1) + "mdat" + BE64(8) + Moov("")));
+
+	/* a child box larger than its parent */
+	std::string moov = Moov("");
+	moov.replace(8, 4, BE32(1000));
+	EXPECT_FALSE(TryScan(Ftyp() + moov));
+
+	/* a truncated "mdhd" inside a valid "moov" */
+	EXPECT_FALSE(TryScan(Ftyp() +
+			     Box("moov", Mvhd(1000) +
+				 Box("trak", Box("mdia",
+						 Box("mdhd", BE32(0)))))));
+
+	/* a truncated "mvhd" */
+	EXPECT_FALSE(TryScan(Ftyp() + Box("moov", Box("mvhd", BE32(0)))));
+
+	/* an ES descriptor with a bogus length */
+	std::string file = Ftyp() + Moov("");
+	const auto esds = file.find("esds");
+	ASSERT_NE(std::string::npos, esds);
+	file[esds + 9] = '\x7f';
+	EXPECT_FALSE(TryScan(file));
+
+	/* a "moov" box extending to the end of the file */
+	const std::string valid = Moov("");
+	EXPECT_TRUE(TryScan(Ftyp() + BE32(0) + valid.substr(4)));
+}
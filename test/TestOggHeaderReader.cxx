@@ -0,0 +1,230 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MemoryInputStream.hxx"
+#include "lib/xiph/OggHeaderReader.hxx"
+#include "thread/Mutex.hxx"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static constexpr uint8_t CONTINUED = 0x01;
+static constexpr uint8_t BOS = 0x02;
+static constexpr uint8_t EOS = 0x04;
+
+static constexpr uint32_t SERIAL = 0x12345678;
+
+static std::string
+LE32(uint32_t value)
+{
+	return {char(value), char(value >> 8), char(value >> 16),
+		char(value >> 24)};
+}
+
+static std::string
+LE64(uint64_t value)
+{
+	return LE32(value) + LE32(value >> 32);
+}
+
+/**
+ * Build an Ogg page (without a valid checksum).
+ *
+ * @param lacing the segment sizes; the body is filled with the
+ * given character
+ */
+static std::string
+Page(uint8_t header_type, const std::vector<uint8_t> &lacing, char fill,
+     uint32_t serial=SERIAL, uint64_t granule=0)
+{
+	std::string page = "OggS";
+	page += '\0';
+	page += char(header_type);
+	page += LE64(granule) + LE32(serial) + LE32(0) + LE32(0);
+	page += char(lacing.size());
+
+	size_t size = 0;
+	for (const auto i : lacing) {
+		page += char(i);
+		size += i;
+	}
+
+	return page + std::string(size, fill);
+}
+
+static std::vector<uint8_t>
+Packet(size_t size, char fill)
+{
+	return std::vector<uint8_t>(size, fill);
+}
+
+TEST(OggHeaderReader, Basic)
+{
+	/* packet 'a' in the first page, packet 'b' spans two pages
+	   with another logical stream's page in between, packet 'c'
+	   follows in the second page */
+	const std::string file =
+		Page(BOS, {10}, 'a') +
+		Page(BOS, {5}, 'x', 42) +
+		Page(0, {255, 255}, 'b') +
+		Page(0, {3}, 'x', 42) +
+		Page(CONTINUED, {90, 20}, 'b');
+
+	Mutex mutex;
+	MemoryInputStream is(mutex, {file.data(), file.size()});
+	OggHeaderReader reader(is);
+
+	std::vector<uint8_t> packet;
+	ASSERT_TRUE(reader.ReadPacket(packet, 1024));
+	EXPECT_EQ(SERIAL, reader.GetSerial());
+	EXPECT_EQ(Packet(10, 'a'), packet);
+
+	ASSERT_TRUE(reader.ReadPacket(packet, 1024));
+	EXPECT_EQ(Packet(600, 'b'), packet);
+
+	/* the remainder of the last page belongs to the next
+	   packet */
+	ASSERT_TRUE(reader.ReadPacket(packet, 1024));
+	EXPECT_EQ(Packet(20, 'b'), packet);
+
+	/* end of file */
+	EXPECT_THROW(reader.ReadPacket(packet, 1024), std::runtime_error);
+}
+
+TEST(OggHeaderReader, Malformed)
+{
+	std::vector<uint8_t> packet;
+	Mutex mutex;
+
+	/* no "beginning of stream" flag */
+	{
+		const std::string file = Page(0, {10}, 'a');
+		MemoryInputStream is(mutex, {file.data(), file.size()});
+		EXPECT_FALSE(OggHeaderReader(is).ReadPacket(packet, 1024));
+	}
+
+	/* wrong capture pattern */
+	{
+		std::string file = Page(BOS, {10}, 'a');
+		file[0] = 'X';
+		MemoryInputStream is(mutex, {file.data(), file.size()});
+		EXPECT_FALSE(OggHeaderReader(is).ReadPacket(packet, 1024));
+	}
+
+	/* unsupported version */
+	{
+		std::string file = Page(BOS, {10}, 'a');
+		file[4] = 1;
+		MemoryInputStream is(mutex, {file.data(), file.size()});
+		EXPECT_FALSE(OggHeaderReader(is).ReadPacket(packet, 1024));
+	}
+
+	/* the packet continues, but the next page does not have the
+	   "continued" flag */
+	{
+		const std::string file = Page(BOS, {255}, 'a') +
+			Page(0, {10}, 'a');
+		MemoryInputStream is(mutex, {file.data(), file.size()});
+		EXPECT_FALSE(OggHeaderReader(is).ReadPacket(packet, 1024));
+	}
+
+	/* a new packet on a page with the "continued" flag */
+	{
+		const std::string file = Page(BOS, {10}, 'a') +
+			Page(CONTINUED, {10}, 'b');
+		MemoryInputStream is(mutex, {file.data(), file.size()});
+		OggHeaderReader reader(is);
+		ASSERT_TRUE(reader.ReadPacket(packet, 1024));
+		EXPECT_FALSE(reader.ReadPacket(packet, 1024));
+	}
+}
+
+TEST(OggHeaderReader, Oversized)
+{
+	const std::string file = Page(BOS, {255, 255, 255, 10}, 'a');
+
+	Mutex mutex;
+	MemoryInputStream is(mutex, {file.data(), file.size()});
+	std::vector<uint8_t> packet;
+	EXPECT_FALSE(OggHeaderReader(is).ReadPacket(packet, 512));
+}
+
+TEST(OggHeaderReader, Truncated)
+{
+	const std::string file = Page(BOS, {10}, 'a') +
+		Page(0, {255}, 'b') + Page(CONTINUED, {1}, 'b');
+
+	for (size_t length = 0; length < file.size(); ++length) {
+		const std::string truncated = file.substr(0, length);
+		Mutex mutex;
+		MemoryInputStream is(mutex,
+				     {truncated.data(), truncated.size()});
+		OggHeaderReader reader(is);
+
+		std::vector<uint8_t> packet;
+		try {
+			EXPECT_FALSE(reader.ReadPacket(packet, 1024) &&
+				     reader.ReadPacket(packet, 1024))
+				<< length;
+		} catch (const std::runtime_error &) {
+		}
+	}
+}
+
+static bool
+FindEOSGranule(const std::string &file, size_t header_size,
+	       uint64_t &granule_r)
+{
+	Mutex mutex;
+	MemoryInputStream is(mutex, {file.data(), file.size()});
+	is.LockSkip(header_size);
+	return OggFindEOSGranule(is, SERIAL, granule_r);
+}
+
+TEST(OggHeaderReader, FindEOSGranule)
+{
+	const std::string header = Page(BOS, {10}, 'a');
+	uint64_t granule;
+
+	/* a far away EOS page is found after skipping other
+	   streams' pages and garbage */
+	ASSERT_TRUE(FindEOSGranule(header +
+				   std::string(100000, 'x') +
+				   "OggS" +
+				   Page(0, {200}, 'b', SERIAL, 1000) +
+				   Page(EOS, {200}, 'b', 42, 2000) +
+				   Page(EOS, {200}, 'b', SERIAL, 3000),
+				   header.size(), granule));
+	EXPECT_EQ(3000u, granule);
+
+	/* no EOS page */
+	EXPECT_FALSE(FindEOSGranule(header +
+				    Page(0, {200}, 'b', SERIAL, 1000),
+				    header.size(), granule));
+
+	/* the EOS page is truncated */
+	const std::string file = header +
+		Page(EOS, {200}, 'b', SERIAL, 1000);
+	EXPECT_FALSE(FindEOSGranule(file.substr(0, file.size() - 1),
+				    header.size(), granule));
+}
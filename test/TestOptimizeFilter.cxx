@@ -0,0 +1,145 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MakeTag.hxx"
+#include "song/Filter.hxx"
+#include "song/LightSong.hxx"
+#include "tag/Type.h"
+#include "util/ConstBuffer.hxx"
+
+#include <gtest/gtest.h>
+
+static SongFilter
+ParseFilter(const char *expression)
+{
+	SongFilter filter;
+	filter.Parse(ConstBuffer<const char *>(&expression, 1));
+	filter.Optimize();
+	return filter;
+}
+
+static bool
+InvokeFilter(const SongFilter &f, const char *uri, const Tag &tag) noexcept
+{
+	return f.Match(LightSong(uri, tag));
+}
+
+static bool
+InvokeFilter(const SongFilter &f, const Tag &tag) noexcept
+{
+	return InvokeFilter(f, "dummy", tag);
+}
+
+/**
+ * Cheap and selective terms are moved to the front; terms with the
+ * same cost keep their order.
+ */
+TEST(OptimizeFilter, Order)
+{
+	EXPECT_EQ(ParseFilter("((artist != \"x\") AND (title contains \"y\") AND (album == \"z\"))").ToExpression(),
+		  "((Album == \"z\") AND (Title contains \"y\") AND (Artist != \"x\"))");
+
+	EXPECT_EQ(ParseFilter("((title == \"a\") AND (album == \"b\") AND (artist == \"c\"))").ToExpression(),
+		  "((Title == \"a\") AND (Album == \"b\") AND (Artist == \"c\"))");
+
+	/* the result of the reordered filter must not change */
+	const auto f = ParseFilter("((artist != \"x\") AND (title contains \"y\") AND (album == \"z\"))");
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_ARTIST, "w", TAG_TITLE, "xyz", TAG_ALBUM, "z")));
+	EXPECT_FALSE(InvokeFilter(f, MakeTag(TAG_ARTIST, "x", TAG_TITLE, "xyz", TAG_ALBUM, "z")));
+	EXPECT_FALSE(InvokeFilter(f, MakeTag(TAG_ARTIST, "w", TAG_TITLE, "abc", TAG_ALBUM, "z")));
+	EXPECT_FALSE(InvokeFilter(f, MakeTag(TAG_ARTIST, "w", TAG_TITLE, "xyz")));
+}
+
+/**
+ * The "required tags" shortcut must consider tag fallbacks.
+ */
+TEST(OptimizeFilter, RequiredTagFallback)
+{
+	const auto f = ParseFilter("((AlbumArtist == \"x\") AND (title == \"t\"))");
+
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_ALBUM_ARTIST, "x", TAG_TITLE, "t")));
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_ARTIST, "x", TAG_TITLE, "t")));
+
+	EXPECT_FALSE(InvokeFilter(f, MakeTag(TAG_TITLE, "t")));
+	EXPECT_FALSE(InvokeFilter(f, MakeTag(TAG_ALBUM_ARTIST, "y",
+					     TAG_ARTIST, "x",
+					     TAG_TITLE, "t")));
+}
+
+/**
+ * An empty value matches songs which don't have the tag, so it must
+ * not be a "required tag".
+ */
+TEST(OptimizeFilter, RequiredTagEmpty)
+{
+	const auto f = ParseFilter("((artist == \"\") AND (title == \"t\"))");
+
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_TITLE, "t")));
+	EXPECT_FALSE(InvokeFilter(f, MakeTag(TAG_ARTIST, "a", TAG_TITLE, "t")));
+}
+
+/**
+ * Negated terms match songs which don't have the tag, so they must
+ * not be "required tags".
+ */
+TEST(OptimizeFilter, RequiredTagNegated)
+{
+	const auto a = ParseFilter("((artist != \"x\") AND (title == \"t\"))");
+	EXPECT_TRUE(InvokeFilter(a, MakeTag(TAG_TITLE, "t")));
+	EXPECT_FALSE(InvokeFilter(a, MakeTag(TAG_ARTIST, "x", TAG_TITLE, "t")));
+
+	const auto b = ParseFilter("((!(artist == \"x\")) AND (title == \"t\"))");
+	EXPECT_TRUE(InvokeFilter(b, MakeTag(TAG_TITLE, "t")));
+	EXPECT_FALSE(InvokeFilter(b, MakeTag(TAG_ARTIST, "x", TAG_TITLE, "t")));
+
+	const auto c = ParseFilter("((artist !contains \"x\") AND (title == \"t\"))");
+	EXPECT_TRUE(InvokeFilter(c, MakeTag(TAG_TITLE, "t")));
+	EXPECT_FALSE(InvokeFilter(c, MakeTag(TAG_ARTIST, "xyz", TAG_TITLE, "t")));
+}
+
+TEST(OptimizeFilter, WithoutImpliedBase)
+{
+	const auto f = ParseFilter("((base \"a\") AND (title == \"t\"))");
+	const auto tag = MakeTag(TAG_TITLE, "t");
+
+	/* the selection is the "base" directory or inside it: the
+	   "base" item is redundant */
+	EXPECT_EQ(f.WithoutImpliedBase("a").ToExpression(),
+		  "(Title == \"t\")");
+	EXPECT_EQ(f.WithoutImpliedBase("a/b").ToExpression(),
+		  "(Title == \"t\")");
+
+	/* a sibling with the same prefix must keep it */
+	const auto sibling = f.WithoutImpliedBase("ab");
+	EXPECT_NE(sibling.GetBase(), nullptr);
+	EXPECT_TRUE(InvokeFilter(sibling, "a/x.ogg", tag));
+	EXPECT_FALSE(InvokeFilter(sibling, "ab/x.ogg", tag));
+
+	/* a parent of "base" must keep it */
+	const auto parent = f.WithoutImpliedBase("");
+	EXPECT_NE(parent.GetBase(), nullptr);
+	EXPECT_FALSE(InvokeFilter(parent, "b/x.ogg", tag));
+
+	/* a prefix of "base" must keep it */
+	const auto g = ParseFilter("((base \"ab\") AND (title == \"t\"))");
+	const auto prefix = g.WithoutImpliedBase("a");
+	EXPECT_NE(prefix.GetBase(), nullptr);
+	EXPECT_TRUE(InvokeFilter(prefix, "ab/x.ogg", tag));
+	EXPECT_FALSE(InvokeFilter(prefix, "a/x.ogg", tag));
+}
@@ -0,0 +1,57 @@
+/*
+ * Unit tests for src/util/
+ */
+
+#include "util/StringSearch.hxx"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+TEST(StringSearch, Basic)
+{
+	constexpr std::string_view haystack = "foo bar baz";
+	EXPECT_EQ(haystack.data(), FindSubstring(haystack, "foo"));
+	EXPECT_EQ(haystack.data() + 4, FindSubstring(haystack, "bar"));
+	EXPECT_EQ(haystack.data() + 8, FindSubstring(haystack, "baz"));
+	EXPECT_EQ(haystack.data() + 5, FindSubstring(haystack, "a"));
+	EXPECT_EQ(haystack.data(), FindSubstring(haystack, ""));
+	EXPECT_EQ(nullptr, FindSubstring(haystack, "bax"));
+	EXPECT_EQ(nullptr, FindSubstring(haystack, "x"));
+	EXPECT_EQ(nullptr, FindSubstring(haystack, "foo bar baz!"));
+	EXPECT_EQ(nullptr, FindSubstring("", "foo"));
+}
+
+/**
+ * Compare with std::string_view::find() at all needle positions and
+ * lengths, covering the block-wise loop and the tail.
+ */
+TEST(StringSearch, Long)
+{
+	std::string haystack;
+	for (unsigned i = 0; i < 100; ++i)
+		haystack.push_back('a' + i % 7);
+
+	const std::string_view h = haystack;
+
+	for (size_t length = 1; length <= 20; ++length) {
+		for (size_t position = 0; position + length <= h.size(); ++position) {
+			const auto needle = h.substr(position, length);
+			EXPECT_EQ(h.data() + h.find(needle),
+				  FindSubstring(h, needle));
+		}
+
+		const std::string missing(length, 'x');
+		EXPECT_EQ(nullptr, FindSubstring(h, missing));
+	}
+}
+
+/**
+ * A near-match (first and last byte equal) must not be reported.
+ */
+TEST(StringSearch, FirstLast)
+{
+	constexpr std::string_view haystack = "axxxxb axxxxb axxyxb and more padding here";
+	EXPECT_EQ(haystack.data() + 14, FindSubstring(haystack, "axxyxb"));
+	EXPECT_EQ(nullptr, FindSubstring(haystack, "axyxxb"));
+}
@@ -20,6 +20,7 @@
 #include "MakeTag.hxx"
 #include "song/TagSongFilter.hxx"
 #include "song/LightSong.hxx"
+#include "tag/Pool.hxx"
 #include "tag/Type.h"
 
 #include <gtest/gtest.h>
@@ -76,6 +77,49 @@ TEST(TagSongFilter, Substring)
 	EXPECT_FALSE(InvokeFilter(f, MakeTag(TAG_TITLE, "eedle")));
 }
 
+TEST(TagSongFilter, FoldCase)
+{
+	const TagSongFilter f(TAG_TITLE,
+			      StringFilter("needle", true, false, false));
+
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_TITLE, "needle")));
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_TITLE, "NEEDLE")));
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_TITLE, "foo", TAG_TITLE, "Needle")));
+
+	EXPECT_FALSE(InvokeFilter(f, MakeTag()));
+	EXPECT_FALSE(InvokeFilter(f, MakeTag(TAG_TITLE, "FOOneedleBAR")));
+
+	/* again, now with the case-folded values cached; the Tag
+	   objects must stay alive, or else their pool slots (and the
+	   cached values) are freed after each call */
+	const auto upper = MakeTag(TAG_TITLE, "NEEDLE");
+	const auto other = MakeTag(TAG_TITLE, "FOOneedleBAR");
+	EXPECT_TRUE(InvokeFilter(f, upper));
+	EXPECT_FALSE(InvokeFilter(f, other));
+
+	const auto folded = tag_pool_get_folded(*upper.items[0]);
+	EXPECT_EQ(folded, "needle");
+
+	EXPECT_TRUE(InvokeFilter(f, upper));
+	EXPECT_FALSE(InvokeFilter(f, other));
+
+	/* the second call must have used the cached value */
+	EXPECT_EQ(tag_pool_get_folded(*upper.items[0]).data(),
+		  folded.data());
+}
+
+TEST(TagSongFilter, FoldCaseSubstring)
+{
+	const TagSongFilter f(TAG_TITLE,
+			      StringFilter("NeEdLe", true, true, false));
+
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_TITLE, "needle")));
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_TITLE, "FOOneedleBAR")));
+	EXPECT_TRUE(InvokeFilter(f, MakeTag(TAG_TITLE, "fooNEEDLEbar")));
+
+	EXPECT_FALSE(InvokeFilter(f, MakeTag(TAG_TITLE, "EEDLE")));
+}
+
 TEST(TagSongFilter, Negated)
 {
 	const TagSongFilter f(TAG_TITLE,
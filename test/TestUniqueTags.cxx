@@ -0,0 +1,145 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "MakeTag.hxx"
+#include "SyntheticDatabase.hxx"
+#include "db/Selection.hxx"
+#include "tag/ItemMap.hxx"
+#include "tag/Tag.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/RecursiveMap.hxx"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+TEST(TagItemMap, Basic)
+{
+	TagItemMap<unsigned> map;
+	EXPECT_TRUE(map.empty());
+
+	const TagItem *foo, *artist_foo;
+
+	{
+		const Tag a = MakeTag(TAG_TITLE, "foo", TAG_ARTIST, "foo");
+		const Tag b = MakeTag(TAG_TITLE, "foo");
+
+		foo = a.items[0];
+		artist_foo = a.items[1];
+
+		/* interned: equal type and value means the same
+		   key */
+		ASSERT_EQ(foo, b.items[0]);
+		ASSERT_NE(foo, artist_foo);
+
+		++map[a.items[0]];
+		++map[b.items[0]];
+		++map[a.items[1]];
+		++map[nullptr];
+	}
+
+	/* the map holds references, so the items are still valid
+	   after the tags have been freed */
+	EXPECT_EQ(std::string("foo"), foo->value);
+	EXPECT_EQ(std::string("foo"), artist_foo->value);
+
+	/* a new tag with the same value gets the same item */
+	const Tag c = MakeTag(TAG_TITLE, "foo");
+	EXPECT_EQ(foo, c.items[0]);
+	EXPECT_EQ(2u, map[c.items[0]]);
+
+	unsigned n = 0;
+	for (const auto &i : map) {
+		++n;
+		if (i.first == foo)
+			EXPECT_EQ(2u, i.second);
+		else
+			EXPECT_EQ(1u, i.second);
+	}
+
+	EXPECT_EQ(3u, n);
+
+	/* moving transfers the references */
+	TagItemMap<unsigned> moved(std::move(map));
+	EXPECT_TRUE(map.empty());
+	EXPECT_FALSE(moved.empty());
+	EXPECT_EQ(2u, moved[foo]);
+}
+
+static RecursiveMap<std::string>
+Collect(const std::vector<SyntheticSong> &songs,
+	std::vector<TagType> tag_types)
+{
+	const SyntheticDatabase db(songs);
+	const DatabaseSelection selection("", true);
+	return db.CollectUniqueTags(selection,
+				    {tag_types.data(), tag_types.size()});
+}
+
+static std::vector<SyntheticSong>
+MakeSongs()
+{
+	std::vector<SyntheticSong> songs;
+	songs.push_back({"a.ogg", MakeTag(TAG_ARTIST, "X",
+					  TAG_ALBUM_ARTIST, "Y",
+					  TAG_DATE, "2000")});
+	songs.push_back({"b.ogg", MakeTag(TAG_ARTIST, "Y",
+					  TAG_DATE, "2001")});
+	songs.push_back({"c.ogg", MakeTag(TAG_ARTIST, "Y",
+					  TAG_DATE, "2000")});
+	songs.push_back({"d.ogg", MakeTag(TAG_TITLE, "untagged")});
+	return songs;
+}
+
+TEST(UniqueTags, Basic)
+{
+	const auto result = Collect(MakeSongs(), {TAG_ARTIST});
+
+	ASSERT_EQ(3u, result.size());
+	EXPECT_EQ(1u, result.count(""));
+	EXPECT_EQ(1u, result.count("X"));
+	EXPECT_EQ(1u, result.count("Y"));
+}
+
+/**
+ * "AlbumArtist" falls back to "Artist"; the value "Y" comes from
+ * two different tag types (i.e. different items) and must be
+ * merged, including the groups below it.
+ */
+TEST(UniqueTags, MergeFallback)
+{
+	const auto result = Collect(MakeSongs(),
+				    {TAG_ALBUM_ARTIST, TAG_DATE});
+
+	ASSERT_EQ(2u, result.size());
+
+	const auto y = result.find("Y");
+	ASSERT_NE(result.end(), y);
+	ASSERT_EQ(2u, y->second.size());
+	EXPECT_EQ(1u, y->second.count("2000"));
+	EXPECT_EQ(1u, y->second.count("2001"));
+	EXPECT_TRUE(y->second.find("2000")->second.empty());
+
+	/* the untagged song */
+	const auto empty = result.find("");
+	ASSERT_NE(result.end(), empty);
+	ASSERT_EQ(1u, empty->second.size());
+	EXPECT_EQ(1u, empty->second.count(""));
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "lib/xiph/VorbisCommentBlock.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/StringView.hxx"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+static std::string
+LE32(uint32_t value)
+{
+	return {char(value), char(value >> 8), char(value >> 16),
+		char(value >> 24)};
+}
+
+static std::string
+String(const std::string &s)
+{
+	return LE32(s.size()) + s;
+}
+
+static bool
+Split(const std::string &block, std::vector<std::string> &comments)
+{
+	std::vector<StringView> dest;
+	if (!SplitVorbisCommentBlock({block.data(), block.size()}, dest))
+		return false;
+
+	for (const auto &i : dest)
+		comments.emplace_back(i.data, i.size);
+	return true;
+}
+
+TEST(VorbisCommentBlock, Basic)
+{
+	const std::string block = String("vendor") + LE32(3) +
+		String("TITLE=Foo") + String("") + String("ARTIST=Bar");
+
+	std::vector<std::string> comments;
+	ASSERT_TRUE(Split(block, comments));
+	ASSERT_EQ(3u, comments.size());
+	EXPECT_EQ("TITLE=Foo", comments[0]);
+	EXPECT_EQ("", comments[1]);
+	EXPECT_EQ("ARTIST=Bar", comments[2]);
+
+	/* trailing bytes (e.g. Vorbis' framing bit) are ignored */
+	comments.clear();
+	ASSERT_TRUE(Split(block + '\1', comments));
+	EXPECT_EQ(3u, comments.size());
+
+	/* no comments */
+	comments.clear();
+	ASSERT_TRUE(Split(String("") + LE32(0), comments));
+	EXPECT_TRUE(comments.empty());
+}
+
+TEST(VorbisCommentBlock, Truncated)
+{
+	const std::string block = String("vendor") + LE32(2) +
+		String("TITLE=Foo") + String("ARTIST=Bar");
+
+	for (size_t length = 0; length < block.size(); ++length) {
+		std::vector<std::string> comments;
+		EXPECT_FALSE(Split(block.substr(0, length), comments))
+			<< length;
+	}
+}
+
+TEST(VorbisCommentBlock, Oversized)
+{
+	std::vector<std::string> comments;
+
+	/* vendor string longer than the block */
+	EXPECT_FALSE(Split(LE32(0xffffffff) + "vendor" + LE32(0), comments));
+
+	/* a huge comment count must not be trusted for the
+	   allocation */
+	EXPECT_FALSE(Split(String("vendor") + LE32(0x40000000) +
+			   String("TITLE=Foo"), comments));
+
+	/* comment longer than the block */
+	EXPECT_FALSE(Split(String("vendor") + LE32(1) +
+			   LE32(0x80000000) + "TITLE=Foo", comments));
+}
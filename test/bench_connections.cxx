@@ -0,0 +1,367 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/*
+ * Open many connections to a running MPD instance and let each of
+ * them send a simple command repeatedly.  This measures the
+ * per-command overhead of the connection handling, e.g. to compare
+ * the "client_io_uring" setting with the default (epoll).
+ *
+ * With "-p PID", the CPU time and the context switches of the MPD
+ * process are reported, as well as the event loop wakeups (obtained
+ * with the "loopstats" command).  For exact system call counts, run
+ * MPD with "perf stat -e raw_syscalls:sys_enter" at the same time.
+ */
+
+#include "net/Connect.hxx"
+#include "net/SocketError.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+#include "util/StringView.hxx"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+/**
+ * Blocking receive of a complete response, which is appended to
+ * the given string.
+ */
+static void
+ReceiveResponse(SocketDescriptor s, std::string &response)
+{
+	char buffer[4096];
+	std::string line;
+
+	while (true) {
+		const auto nbytes = recv(s.Get(), buffer, sizeof(buffer), 0);
+		if (nbytes < 0)
+			throw MakeSocketError("Failed to receive");
+		if (nbytes == 0)
+			throw std::runtime_error("Premature end of response");
+
+		response.append(buffer, nbytes);
+
+		StringView r(response.data(), response.size());
+		if (r.StartsWith("OK MPD ") || r.EndsWith("\nOK\n") ||
+		    r.Equals("OK\n"))
+			return;
+
+		if (r.StartsWith("ACK ") || response.find("\nACK ") != std::string::npos)
+			throw std::runtime_error(response);
+	}
+}
+
+static std::string
+Query(SocketDescriptor s, const char *request)
+{
+	if (s.Write(request, strlen(request)) < 0)
+		throw MakeSocketError("Failed to send");
+
+	std::string response;
+	ReceiveResponse(s, response);
+	return response;
+}
+
+struct ProcessStats {
+	double cpu_seconds = 0;
+	unsigned long long context_switches = 0;
+	unsigned long long wakeups = 0;
+};
+
+static double
+ReadProcessCpu(unsigned pid)
+{
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%u/stat", pid);
+
+	FILE *file = fopen(path, "r");
+	if (file == nullptr)
+		throw std::runtime_error(std::string("Failed to open ") + path);
+
+	char buffer[1024];
+	const size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+	fclose(file);
+	buffer[length] = 0;
+
+	/* skip the command name, which may contain spaces */
+	const char *p = strrchr(buffer, ')');
+	if (p == nullptr)
+		throw std::runtime_error("Malformed /proc/PID/stat");
+
+	/* "utime" and "stime" are fields 14 and 15; the field after
+	   the command name is number 3 */
+	unsigned long utime, stime;
+	if (sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+		   &utime, &stime) != 2)
+		throw std::runtime_error("Malformed /proc/PID/stat");
+
+	return double(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+static unsigned long long
+ReadContextSwitches(const char *path)
+{
+	FILE *file = fopen(path, "r");
+	if (file == nullptr)
+		return 0;
+
+	unsigned long long total = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), file) != nullptr) {
+		unsigned long long value;
+		if (sscanf(line, "voluntary_ctxt_switches: %llu", &value) == 1 ||
+		    sscanf(line, "nonvoluntary_ctxt_switches: %llu", &value) == 1)
+			total += value;
+	}
+
+	fclose(file);
+	return total;
+}
+
+/**
+ * Sum up the context switches of all threads of the process.
+ */
+static unsigned long long
+ReadProcessContextSwitches(unsigned pid)
+{
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%u/task", pid);
+
+	DIR *dir = opendir(path);
+	if (dir == nullptr)
+		throw std::runtime_error(std::string("Failed to open ") + path);
+
+	unsigned long long total = 0;
+	while (const auto *e = readdir(dir)) {
+		if (e->d_name[0] == '.')
+			continue;
+
+		char status_path[128];
+		snprintf(status_path, sizeof(status_path),
+			 "/proc/%u/task/%s/status", pid, e->d_name);
+		total += ReadContextSwitches(status_path);
+	}
+
+	closedir(dir);
+	return total;
+}
+
+static ProcessStats
+ReadProcessStats(unsigned pid, SocketDescriptor control)
+{
+	ProcessStats stats;
+	stats.cpu_seconds = ReadProcessCpu(pid);
+	stats.context_switches = ReadProcessContextSwitches(pid);
+
+	const auto response = Query(control, "loopstats\n");
+	const char *p = strstr(response.c_str(), "wakeups: ");
+	if (p != nullptr)
+		stats.wakeups = strtoull(p + 9, nullptr, 10);
+
+	return stats;
+}
+
+struct Connection {
+	UniqueSocketDescriptor socket;
+
+	std::string response;
+
+	/**
+	 * The number of commands which have yet to be sent.
+	 */
+	unsigned remaining;
+};
+
+static void
+SendCommand(Connection &c, const std::string &request)
+{
+	if (c.socket.Write(request.data(), request.size()) != ssize_t(request.size()))
+		throw MakeSocketError("Failed to send");
+
+	--c.remaining;
+}
+
+/**
+ * Receive data on a connection.
+ *
+ * @return true if the response is complete
+ */
+static bool
+ReceiveNonBlocking(Connection &c)
+{
+	char buffer[4096];
+	const auto nbytes = c.socket.Read(buffer, sizeof(buffer));
+	if (nbytes < 0) {
+		if (IsSocketErrorAgain(GetSocketError()))
+			return false;
+
+		throw MakeSocketError("Failed to receive");
+	}
+
+	if (nbytes == 0)
+		throw std::runtime_error("Connection closed by MPD");
+
+	c.response.append(buffer, nbytes);
+
+	StringView r(c.response.data(), c.response.size());
+	if (r.StartsWith("ACK ") || c.response.find("\nACK ") != std::string::npos)
+		throw std::runtime_error(c.response);
+
+	if (r.Equals("OK\n") || r.EndsWith("\nOK\n")) {
+		c.response.clear();
+		return true;
+	}
+
+	return false;
+}
+
+int
+main(int argc, char **argv)
+try {
+	unsigned n_connections = 100, n_commands = 100, pid = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "c:n:p:")) != -1) {
+		switch (opt) {
+		case 'c':
+			n_connections = strtoul(optarg, nullptr, 10);
+			break;
+
+		case 'n':
+			n_commands = strtoul(optarg, nullptr, 10);
+			break;
+
+		case 'p':
+			pid = strtoul(optarg, nullptr, 10);
+			break;
+
+		default:
+			fprintf(stderr, "Usage: bench_connections [-c CONNECTIONS] [-n COMMANDS] [-p PID] HOST[:PORT] [COMMAND]\n");
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind >= argc || argc - optind > 2 ||
+	    n_connections == 0 || n_commands == 0) {
+		fprintf(stderr, "Usage: bench_connections [-c CONNECTIONS] [-n COMMANDS] [-p PID] HOST[:PORT] [COMMAND]\n");
+		return EXIT_FAILURE;
+	}
+
+	const char *const address = argv[optind];
+	const std::string request = std::string(optind + 1 < argc
+						? argv[optind + 1]
+						: "ping") + "\n";
+
+	/* the control connection for "loopstats" */
+	UniqueSocketDescriptor control;
+	if (pid > 0) {
+		control = Connect(address);
+		std::string greeting;
+		ReceiveResponse(control, greeting);
+	}
+
+	std::vector<Connection> connections(n_connections);
+	for (auto &c : connections) {
+		c.socket = Connect(address);
+		ReceiveResponse(c.socket, c.response);
+		c.response.clear();
+		c.socket.SetNonBlocking();
+		c.remaining = n_commands;
+	}
+
+	std::vector<struct pollfd> pfds(n_connections);
+	for (unsigned i = 0; i < n_connections; ++i) {
+		pfds[i].fd = connections[i].socket.Get();
+		pfds[i].events = POLLIN;
+	}
+
+	ProcessStats before;
+	if (pid > 0)
+		before = ReadProcessStats(pid, control);
+
+	using Clock = std::chrono::steady_clock;
+	const auto start = Clock::now();
+
+	for (auto &c : connections)
+		SendCommand(c, request);
+
+	unsigned active = n_connections;
+	while (active > 0) {
+		if (poll(pfds.data(), pfds.size(), -1) < 0)
+			throw MakeSocketError("poll() failed");
+
+		for (unsigned i = 0; i < n_connections; ++i) {
+			if (pfds[i].revents == 0)
+				continue;
+
+			auto &c = connections[i];
+			if (!ReceiveNonBlocking(c))
+				continue;
+
+			if (c.remaining > 0)
+				SendCommand(c, request);
+			else {
+				/* done; ignore this connection from now on */
+				pfds[i].fd = -1;
+				--active;
+			}
+		}
+	}
+
+	const std::chrono::duration<double> duration = Clock::now() - start;
+	const double seconds = duration.count();
+	const unsigned long long total = (unsigned long long)n_connections * n_commands;
+
+	printf("%u connections, %llu commands in %.3f s\n",
+	       n_connections, total, seconds);
+	if (seconds > 0)
+		printf("%.0f commands/s\n", total / seconds);
+
+	if (pid > 0) {
+		const auto after = ReadProcessStats(pid, control);
+
+		/* subtract the "loopstats" query itself */
+		const unsigned long long wakeups = after.wakeups - before.wakeups - 1;
+
+		printf("server CPU: %.3f s, %.2f us/command\n",
+		       after.cpu_seconds - before.cpu_seconds,
+		       (after.cpu_seconds - before.cpu_seconds) * 1e6 / total);
+		printf("server context switches: %llu, %.3f/command\n",
+		       after.context_switches - before.context_switches,
+		       double(after.context_switches - before.context_switches) / total);
+		printf("server event loop wakeups: %llu, %.3f/command\n",
+		       wakeups, double(wakeups) / total);
+	}
+
+	return EXIT_SUCCESS;
+} catch (...) {
+	PrintException(std::current_exception());
+	return EXIT_FAILURE;
+}
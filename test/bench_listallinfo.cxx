@@ -0,0 +1,293 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/*
+ * Connect to a running MPD instance, send "listallinfo" and measure
+ * how fast the response arrives.  Run this against a database with
+ * e.g. 100k songs to benchmark the response formatting code.
+ *
+ * With "-z", the connection is switched to zlib compression first
+ * ("protocol compress zlib"), and the compression ratio and the
+ * decompression overhead are reported.
+ */
+
+#include "net/Connect.hxx"
+#include "net/SocketError.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+#include "util/StringView.hxx"
+#include "util/PrintException.hxx"
+#include "config.h"
+
+#ifdef ENABLE_ZLIB
+#include "lib/zlib/Error.hxx"
+
+#include <zlib.h>
+#else
+class Inflater;
+#endif
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+struct ResponseStats {
+	/** bytes received from the socket */
+	unsigned long long bytes = 0;
+
+	/** bytes after decompression */
+	unsigned long long decoded_bytes = 0;
+
+	unsigned long songs = 0, lines = 0;
+};
+
+enum class ParseResult {
+	MORE, OK, ACK,
+};
+
+static ParseResult
+ParseResponse(const char *p, const char *const end, std::string &line,
+	      ResponseStats &stats)
+{
+	stats.decoded_bytes += end - p;
+
+	while (p < end) {
+		const char *newline = (const char *)
+			memchr(p, '\n', end - p);
+		if (newline == nullptr) {
+			line.append(p, end);
+			break;
+		}
+
+		StringView current(p, newline);
+		if (!line.empty()) {
+			line.append(p, newline);
+			current = {line.data(), line.size()};
+		}
+
+		++stats.lines;
+
+		if (current.StartsWith("file: "))
+			++stats.songs;
+		else if (current.Equals("OK") ||
+			 /* the greeting */
+			 current.StartsWith("OK MPD "))
+			return ParseResult::OK;
+		else if (current.StartsWith("ACK ")) {
+			fprintf(stderr, "%.*s\n",
+				int(current.size), current.data);
+			return ParseResult::ACK;
+		}
+
+		line.clear();
+		p = newline + 1;
+	}
+
+	return ParseResult::MORE;
+}
+
+#ifdef ENABLE_ZLIB
+
+class Inflater {
+	z_stream z;
+
+public:
+	Inflater() {
+		z.next_in = nullptr;
+		z.avail_in = 0;
+		z.zalloc = Z_NULL;
+		z.zfree = Z_NULL;
+		z.opaque = Z_NULL;
+
+		int result = inflateInit(&z);
+		if (result != Z_OK)
+			throw ZlibError(result);
+	}
+
+	~Inflater() noexcept {
+		inflateEnd(&z);
+	}
+
+	Inflater(const Inflater &) = delete;
+	Inflater &operator=(const Inflater &) = delete;
+
+	/**
+	 * Decompress the given buffer and pass the result to
+	 * ParseResponse().
+	 */
+	ParseResult Feed(const void *data, size_t size, std::string &line,
+			 ResponseStats &stats) {
+		static char buffer[262144];
+
+		z.next_in = (Bytef *)const_cast<void *>(data);
+		z.avail_in = size;
+
+		do {
+			z.next_out = (Bytef *)buffer;
+			z.avail_out = sizeof(buffer);
+
+			int result = inflate(&z, Z_SYNC_FLUSH);
+			if (result != Z_OK && result != Z_BUF_ERROR)
+				throw ZlibError(result);
+
+			const char *end = buffer + sizeof(buffer) - z.avail_out;
+			auto pr = ParseResponse(buffer, end, line, stats);
+			if (pr != ParseResult::MORE)
+				return pr;
+		} while (z.avail_in > 0 || z.avail_out == 0);
+
+		return ParseResult::MORE;
+	}
+};
+
+#endif
+
+/**
+ * Receive and parse the response until "OK" or "ACK".
+ *
+ * @param inflater if not nullptr, then the response is compressed
+ * @return true on "OK"
+ */
+static bool
+ReceiveResponse(SocketDescriptor s, ResponseStats &stats,
+		[[maybe_unused]] Inflater *inflater=nullptr)
+{
+	static char buffer[65536];
+	std::string line;
+
+	while (true) {
+		/* blocking receive (SocketDescriptor::Read() uses
+		   MSG_DONTWAIT) */
+		const auto nbytes = recv(s.Get(), buffer, sizeof(buffer), 0);
+		if (nbytes < 0)
+			throw MakeSocketError("Failed to receive");
+		if (nbytes == 0)
+			throw std::runtime_error("Premature end of response");
+
+		stats.bytes += nbytes;
+
+#ifdef ENABLE_ZLIB
+		const auto result = inflater != nullptr
+			? inflater->Feed(buffer, nbytes, line, stats)
+			: ParseResponse(buffer, buffer + nbytes, line, stats);
+#else
+		const auto result = ParseResponse(buffer, buffer + nbytes,
+						  line, stats);
+#endif
+
+		if (result != ParseResult::MORE)
+			return result == ParseResult::OK;
+	}
+}
+
+static void
+SendRequest(SocketDescriptor s, const char *request)
+{
+	if (s.Write(request, strlen(request)) < 0)
+		throw MakeSocketError("Failed to send");
+}
+
+int
+main(int argc, char **argv)
+try {
+	bool compress = false;
+	if (argc > 1 && strcmp(argv[1], "-z") == 0) {
+		compress = true;
+		--argc;
+		++argv;
+	}
+
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr, "Usage: bench_listallinfo [-z] HOST[:PORT] [COUNT]\n");
+		return EXIT_FAILURE;
+	}
+
+	const unsigned count = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1;
+
+	auto s = Connect(argv[1]);
+
+	/* consume the greeting */
+	ResponseStats greeting;
+	if (!ReceiveResponse(s, greeting))
+		return EXIT_FAILURE;
+
+#ifdef ENABLE_ZLIB
+	std::unique_ptr<Inflater> inflater_holder;
+	if (compress) {
+		SendRequest(s, "protocol compress zlib\n");
+
+		/* this response is still uncompressed */
+		ResponseStats dummy;
+		if (!ReceiveResponse(s, dummy))
+			return EXIT_FAILURE;
+
+		inflater_holder = std::make_unique<Inflater>();
+	}
+
+	Inflater *const inflater = inflater_holder.get();
+#else
+	if (compress) {
+		fprintf(stderr, "Compression not supported\n");
+		return EXIT_FAILURE;
+	}
+
+	Inflater *const inflater = nullptr;
+#endif
+
+	using Clock = std::chrono::steady_clock;
+	std::chrono::duration<double> total{};
+	ResponseStats stats;
+
+	for (unsigned i = 0; i < count; ++i) {
+		const auto start = Clock::now();
+
+		SendRequest(s, "listallinfo\n");
+
+		if (!ReceiveResponse(s, stats, inflater))
+			return EXIT_FAILURE;
+
+		total += Clock::now() - start;
+	}
+
+	const double seconds = total.count();
+	printf("%u requests, %lu songs, %lu lines, %llu bytes in %.3f s\n",
+	       count, stats.songs, stats.lines, stats.bytes, seconds);
+
+	if (compress && stats.bytes > 0)
+		printf("%llu bytes uncompressed, ratio %.2f\n",
+		       stats.decoded_bytes,
+		       double(stats.decoded_bytes) / stats.bytes);
+
+	if (seconds > 0)
+		printf("%.1f MB/s, %.0f songs/s, %.0f lines/s\n",
+		       stats.bytes / seconds / (1024 * 1024),
+		       stats.songs / seconds,
+		       stats.lines / seconds);
+
+	return EXIT_SUCCESS;
+} catch (...) {
+	PrintException(std::current_exception());
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,816 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/*
+ * A load test for the MPD protocol: many clients send a configurable
+ * mix of commands to one MPD instance, and the throughput and the
+ * latency percentiles of each command are reported.  This helps to
+ * measure regressions in the "command" and "client" libraries.
+ *
+ * The test needs a database with known contents.  "-g FILE" writes
+ * a synthetic database for the "simple" database plugin.  "-x MPD"
+ * does the whole setup: it writes the database and a configuration
+ * file to a temporary directory, launches the given MPD binary,
+ * runs the test against it, and stops it.
+ *
+ * The mix ("-m") is a comma-separated list of NAME:WEIGHT pairs;
+ * the names are:
+ *
+ * - status: "status"
+ * - search: "search any WORD" (a word which occurs in 1/8 of all
+ *   titles)
+ * - find: "find artist NAME" (an exact match)
+ * - listallinfo: "listallinfo" (the whole database)
+ * - queue: "add" and "delete" in one command list
+ *
+ * In addition, "-i" clients wait in "idle" all the time; the
+ * "queue" commands wake them up.
+ *
+ * With "-x", "-T THREADS" runs the test twice: once with the
+ * default configuration and once with "client_io_threads" set to
+ * THREADS, to compare the latencies.
+ */
+
+#include "net/Connect.hxx"
+#include "net/SocketAddress.hxx"
+#include "net/SocketError.hxx"
+#include "net/StaticSocketAddress.hxx"
+#include "net/IPv4Address.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+#include "tag/Type.h"
+#include "util/PrintException.hxx"
+#include "util/StringView.hxx"
+#include "Version.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr unsigned SONGS_PER_ALBUM = 10;
+static constexpr unsigned ALBUMS_PER_ARTIST = 10;
+static constexpr unsigned SONGS_PER_ARTIST =
+	SONGS_PER_ALBUM * ALBUMS_PER_ARTIST;
+
+static constexpr std::array<const char *, 16> words{
+	"Love", "Night", "River", "Stone", "Fire", "Dream", "Blue", "Rain",
+	"Heart", "Road", "Light", "Shadow", "Summer", "Ocean", "Moon", "Wild",
+};
+
+static std::string
+SyntheticArtist(unsigned artist)
+{
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "Artist %04u", artist);
+	return buffer;
+}
+
+static std::string
+SyntheticUri(unsigned song)
+{
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "Artist%04u/Album%02u/%02u.ogg",
+		 song / SONGS_PER_ARTIST,
+		 song % SONGS_PER_ARTIST / SONGS_PER_ALBUM,
+		 song % SONGS_PER_ALBUM);
+	return buffer;
+}
+
+/**
+ * Write a database file for the "simple" database plugin containing
+ * the given number of songs.
+ */
+static void
+GenerateDatabase(const char *path, unsigned n_songs)
+{
+	FILE *file = fopen(path, "w");
+	if (file == nullptr)
+		throw std::runtime_error(std::string("Failed to create ") + path);
+
+	fprintf(file, "info_begin\n"
+		"format: 2\n"
+		"mpd_version: " VERSION "\n"
+		"fs_charset: UTF-8\n");
+	for (unsigned i = 0; i < TAG_NUM_OF_ITEM_TYPES; ++i)
+		fprintf(file, "tag: %s\n", tag_item_names[i]);
+	fprintf(file, "info_end\n");
+
+	for (unsigned song = 0; song < n_songs; ++song) {
+		const unsigned artist = song / SONGS_PER_ARTIST;
+		const unsigned album = song % SONGS_PER_ARTIST / SONGS_PER_ALBUM;
+		const unsigned track = song % SONGS_PER_ALBUM;
+
+		if (song % SONGS_PER_ARTIST == 0)
+			fprintf(file, "directory: Artist%04u\n"
+				"mtime: 0\n"
+				"begin: Artist%04u\n",
+				artist, artist);
+
+		if (track == 0)
+			fprintf(file, "directory: Album%02u\n"
+				"mtime: 0\n"
+				"begin: Artist%04u/Album%02u\n",
+				album, artist, album);
+
+		fprintf(file, "song_begin: %02u.ogg\n"
+			"Time: %u.000\n"
+			"Artist: %s\n"
+			"AlbumArtist: %s\n"
+			"Album: Album %u of %s\n"
+			"Title: %s %s %u\n"
+			"Track: %u\n"
+			"Genre: Genre %u\n"
+			"Date: %u\n"
+			"mtime: 0\n"
+			"song_end\n",
+			track,
+			120 + song % 240,
+			SyntheticArtist(artist).c_str(),
+			SyntheticArtist(artist).c_str(),
+			album, SyntheticArtist(artist).c_str(),
+			words[song % words.size()],
+			words[song / words.size() % words.size()],
+			song,
+			track + 1,
+			artist % 32,
+			1960 + artist % 60);
+
+		if (track == SONGS_PER_ALBUM - 1 || song == n_songs - 1)
+			fprintf(file, "end: Artist%04u/Album%02u\n",
+				artist, album);
+
+		if (song % SONGS_PER_ARTIST == SONGS_PER_ARTIST - 1 ||
+		    song == n_songs - 1)
+			fprintf(file, "end: Artist%04u\n", artist);
+	}
+
+	if (fclose(file) != 0)
+		throw std::runtime_error(std::string("Failed to write ") + path);
+}
+
+/**
+ * Parses response lines and detects the end of a response.
+ */
+class ResponseParser {
+	std::string line;
+
+public:
+	enum class Result {
+		MORE, OK, ACK,
+	};
+
+	Result Feed(const char *p, const char *const end) noexcept {
+		while (p < end) {
+			const char *newline = (const char *)
+				memchr(p, '\n', end - p);
+			if (newline == nullptr) {
+				line.append(p, end);
+				break;
+			}
+
+			StringView current(p, newline);
+			if (!line.empty()) {
+				line.append(p, newline);
+				current = {line.data(), line.size()};
+			}
+
+			p = newline + 1;
+
+			if (current.Equals("OK") ||
+			    /* the greeting */
+			    current.StartsWith("OK MPD ")) {
+				line.clear();
+				return Result::OK;
+			}
+
+			if (current.StartsWith("ACK ")) {
+				line.clear();
+				return Result::ACK;
+			}
+
+			line.clear();
+		}
+
+		return Result::MORE;
+	}
+};
+
+/**
+ * Send a request and wait for the response (blocking).
+ */
+static void
+Query(SocketDescriptor s, const char *request)
+{
+	if (request != nullptr &&
+	    s.Write(request, strlen(request)) < 0)
+		throw MakeSocketError("Failed to send");
+
+	ResponseParser parser;
+	char buffer[16384];
+
+	while (true) {
+		const auto nbytes = recv(s.Get(), buffer, sizeof(buffer), 0);
+		if (nbytes < 0)
+			throw MakeSocketError("Failed to receive");
+		if (nbytes == 0)
+			throw std::runtime_error("Premature end of response");
+
+		switch (parser.Feed(buffer, buffer + nbytes)) {
+		case ResponseParser::Result::MORE:
+			break;
+
+		case ResponseParser::Result::OK:
+			return;
+
+		case ResponseParser::Result::ACK:
+			throw std::runtime_error("Command failed");
+		}
+	}
+}
+
+enum class Command {
+	STATUS, SEARCH, FIND, LISTALLINFO, QUEUE,
+	IDLE,
+};
+
+static constexpr unsigned N_COMMANDS = unsigned(Command::IDLE) + 1;
+
+static constexpr std::array<const char *, N_COMMANDS> command_names{
+	"status", "search", "find", "listallinfo", "queue", "idle",
+};
+
+static Command
+ParseCommandName(StringView name)
+{
+	for (unsigned i = 0; i < N_COMMANDS; ++i)
+		if (i != unsigned(Command::IDLE) && name.Equals(command_names[i]))
+			return Command(i);
+
+	throw std::runtime_error("Unknown command in mix: " +
+				 std::string(name.data, name.size));
+}
+
+/**
+ * Parse a mix specification like "status:80,search:5".
+ */
+static std::array<unsigned, N_COMMANDS>
+ParseMix(const char *s)
+{
+	std::array<unsigned, N_COMMANDS> weights{};
+
+	StringView rest(s);
+	while (!rest.empty()) {
+		auto item = rest.Split(',');
+		rest = item.second;
+
+		auto name_weight = item.first.Split(':');
+		const auto command = ParseCommandName(name_weight.first);
+		weights[unsigned(command)] = name_weight.second.IsNull()
+			? 1
+			: strtoul(std::string(name_weight.second.data,
+					      name_weight.second.size).c_str(),
+				  nullptr, 10);
+	}
+
+	unsigned total = 0;
+	for (unsigned w : weights)
+		total += w;
+	if (total == 0)
+		throw std::runtime_error("Empty mix");
+
+	return weights;
+}
+
+class LoadTest {
+	const unsigned n_songs;
+
+	std::mt19937 random;
+
+	std::discrete_distribution<unsigned> mix;
+
+	/**
+	 * Latencies of completed commands [seconds] per #Command.
+	 */
+	std::array<std::vector<double>, N_COMMANDS> latencies;
+
+	unsigned long long idle_wakeups = 0, errors = 0;
+
+	struct Connection {
+		UniqueSocketDescriptor socket;
+		ResponseParser parser;
+		Command command;
+		Clock::time_point start;
+
+		/**
+		 * Is a request in progress?
+		 */
+		bool busy = false;
+	};
+
+	std::vector<Connection> connections;
+
+public:
+	LoadTest(unsigned _n_songs,
+		 const std::array<unsigned, N_COMMANDS> &weights)
+		:n_songs(_n_songs),
+		 mix(weights.begin(), weights.end()) {}
+
+	void Run(const char *address, unsigned n_clients,
+		 unsigned n_idle, std::chrono::steady_clock::duration duration);
+
+	void PrintReport(std::chrono::duration<double> elapsed) const;
+
+private:
+	std::string MakeRequest(Command command);
+	void SendRequest(Connection &c, Command command);
+
+	/**
+	 * @return false if the response is not yet complete
+	 */
+	bool Receive(Connection &c);
+};
+
+std::string
+LoadTest::MakeRequest(Command command)
+{
+	switch (command) {
+	case Command::STATUS:
+		return "status\n";
+
+	case Command::SEARCH:
+		return std::string("search any \"") +
+			words[random() % words.size()] + "\"\n";
+
+	case Command::FIND:
+		return "find artist \"" +
+			SyntheticArtist(random() % ((n_songs + SONGS_PER_ARTIST - 1) / SONGS_PER_ARTIST)) +
+			"\"\n";
+
+	case Command::LISTALLINFO:
+		return "listallinfo\n";
+
+	case Command::QUEUE:
+		/* keep the queue length constant */
+		return "command_list_begin\n"
+			"add \"" + SyntheticUri(random() % n_songs) + "\"\n"
+			"delete 0\n"
+			"command_list_end\n";
+
+	case Command::IDLE:
+		return "idle\n";
+	}
+
+	return {};
+}
+
+void
+LoadTest::SendRequest(Connection &c, Command command)
+{
+	const auto request = MakeRequest(command);
+
+	c.command = command;
+	c.start = Clock::now();
+	c.busy = true;
+
+	if (c.socket.Write(request.data(), request.size()) != ssize_t(request.size()))
+		throw MakeSocketError("Failed to send");
+}
+
+bool
+LoadTest::Receive(Connection &c)
+{
+	static char buffer[65536];
+
+	const auto nbytes = c.socket.Read(buffer, sizeof(buffer));
+	if (nbytes < 0) {
+		if (IsSocketErrorAgain(GetSocketError()))
+			return false;
+
+		throw MakeSocketError("Failed to receive");
+	}
+
+	if (nbytes == 0)
+		throw std::runtime_error("Connection closed by MPD");
+
+	switch (c.parser.Feed(buffer, buffer + nbytes)) {
+	case ResponseParser::Result::MORE:
+		return false;
+
+	case ResponseParser::Result::OK:
+		break;
+
+	case ResponseParser::Result::ACK:
+		++errors;
+		break;
+	}
+
+	c.busy = false;
+
+	if (c.command == Command::IDLE)
+		++idle_wakeups;
+	else
+		latencies[unsigned(c.command)].push_back(std::chrono::duration<double>(Clock::now() - c.start).count());
+
+	return true;
+}
+
+void
+LoadTest::Run(const char *address, unsigned n_clients, unsigned n_idle,
+	      std::chrono::steady_clock::duration duration)
+{
+	{
+		/* fill the queue for the "delete" commands */
+		auto control = Connect(address);
+		Query(control, nullptr);
+		Query(control, "clear\n");
+		for (unsigned i = 0; i < std::min(n_songs, 100U); ++i)
+			Query(control, ("add \"" + SyntheticUri(i) + "\"\n").c_str());
+	}
+
+	connections.resize(n_clients + n_idle);
+	for (auto &c : connections) {
+		c.socket = Connect(address);
+		Query(c.socket, nullptr);
+		c.socket.SetNonBlocking();
+	}
+
+	std::vector<struct pollfd> pfds(connections.size());
+	for (size_t i = 0; i < connections.size(); ++i) {
+		pfds[i].fd = connections[i].socket.Get();
+		pfds[i].events = POLLIN;
+	}
+
+	for (unsigned i = 0; i < n_idle; ++i)
+		SendRequest(connections[n_clients + i], Command::IDLE);
+
+	const auto end = Clock::now() + duration;
+
+	for (unsigned i = 0; i < n_clients; ++i)
+		SendRequest(connections[i], Command(mix(random)));
+
+	unsigned active = n_clients;
+	while (active > 0) {
+		if (poll(pfds.data(), pfds.size(), 1000) < 0)
+			throw MakeSocketError("poll() failed");
+
+		const bool finished = Clock::now() >= end;
+
+		for (size_t i = 0; i < connections.size(); ++i) {
+			if (pfds[i].revents == 0)
+				continue;
+
+			auto &c = connections[i];
+			if (!Receive(c))
+				continue;
+
+			if (c.command == Command::IDLE)
+				SendRequest(c, Command::IDLE);
+			else if (!finished)
+				SendRequest(c, Command(mix(random)));
+			else
+				--active;
+		}
+	}
+}
+
+static double
+Percentile(const std::vector<double> &sorted, double p) noexcept
+{
+	if (sorted.empty())
+		return 0;
+
+	size_t i = size_t(p * sorted.size());
+	return sorted[std::min(i, sorted.size() - 1)];
+}
+
+void
+LoadTest::PrintReport(std::chrono::duration<double> elapsed) const
+{
+	const double seconds = elapsed.count();
+
+	printf("%-12s %9s %9s %9s %9s %9s %9s\n",
+	       "command", "count", "per_s",
+	       "p50_ms", "p99_ms", "p999_ms", "max_ms");
+
+	std::vector<double> all;
+
+	for (unsigned i = 0; i < N_COMMANDS; ++i) {
+		auto sorted = latencies[i];
+		if (sorted.empty())
+			continue;
+
+		std::sort(sorted.begin(), sorted.end());
+		all.insert(all.end(), sorted.begin(), sorted.end());
+
+		printf("%-12s %9zu %9.1f %9.3f %9.3f %9.3f %9.3f\n",
+		       command_names[i], sorted.size(),
+		       sorted.size() / seconds,
+		       Percentile(sorted, 0.5) * 1000,
+		       Percentile(sorted, 0.99) * 1000,
+		       Percentile(sorted, 0.999) * 1000,
+		       sorted.back() * 1000);
+	}
+
+	std::sort(all.begin(), all.end());
+	if (!all.empty())
+		printf("%-12s %9zu %9.1f %9.3f %9.3f %9.3f %9.3f\n",
+		       "total", all.size(),
+		       all.size() / seconds,
+		       Percentile(all, 0.5) * 1000,
+		       Percentile(all, 0.99) * 1000,
+		       Percentile(all, 0.999) * 1000,
+		       all.back() * 1000);
+
+	printf("idle wakeups: %llu, errors: %llu\n", idle_wakeups, errors);
+}
+
+/**
+ * Find a free TCP port on the loopback interface.
+ */
+static unsigned
+FindFreePort()
+{
+	UniqueSocketDescriptor s;
+	if (!s.Create(AF_INET, SOCK_STREAM, 0))
+		throw MakeSocketError("Failed to create socket");
+
+	if (!s.Bind(IPv4Address(IPv4Address::Loopback(), 0)))
+		throw MakeSocketError("Failed to bind");
+
+	const auto address = s.GetLocalAddress();
+	if (address.GetFamily() != AF_INET)
+		throw std::runtime_error("Unexpected address family");
+
+	return IPv4Address::Cast(address).GetPort();
+}
+
+/**
+ * An MPD process with a synthetic database in a temporary
+ * directory.
+ */
+class MpdInstance {
+	std::string directory;
+	pid_t pid = -1;
+
+public:
+	MpdInstance(const char *mpd_path, unsigned n_songs,
+		    unsigned port, unsigned max_connections,
+		    unsigned io_threads);
+	~MpdInstance() noexcept;
+
+	MpdInstance(const MpdInstance &) = delete;
+	MpdInstance &operator=(const MpdInstance &) = delete;
+};
+
+MpdInstance::MpdInstance(const char *mpd_path, unsigned n_songs,
+			 unsigned port, unsigned max_connections,
+			 unsigned io_threads)
+{
+	char tmp[] = "/tmp/bench_load.XXXXXX";
+	if (mkdtemp(tmp) == nullptr)
+		throw std::runtime_error("mkdtemp() failed");
+
+	directory = tmp;
+
+	const auto music_path = directory + "/music";
+	const auto db_path = directory + "/database";
+	const auto config_path = directory + "/mpd.conf";
+
+	mkdir(music_path.c_str(), 0700);
+
+	GenerateDatabase(db_path.c_str(), n_songs);
+
+	FILE *file = fopen(config_path.c_str(), "w");
+	if (file == nullptr)
+		throw std::runtime_error("Failed to create " + config_path);
+
+	fprintf(file, "music_directory \"%s\"\n"
+		"database {\n"
+		"  plugin \"simple\"\n"
+		"  path \"%s\"\n"
+		"  compress \"no\"\n"
+		"}\n"
+		"bind_to_address \"127.0.0.1\"\n"
+		"port \"%u\"\n"
+		"max_connections \"%u\"\n"
+		"client_io_threads \"%u\"\n"
+		"audio_output {\n"
+		"  type \"null\"\n"
+		"  name \"null\"\n"
+		"}\n",
+		music_path.c_str(), db_path.c_str(),
+		port, max_connections, io_threads);
+	fclose(file);
+
+	pid = fork();
+	if (pid < 0)
+		throw std::runtime_error("fork() failed");
+
+	if (pid == 0) {
+		execl(mpd_path, mpd_path, "--no-daemon",
+		      config_path.c_str(), nullptr);
+		perror("Failed to execute MPD");
+		_exit(EXIT_FAILURE);
+	}
+}
+
+MpdInstance::~MpdInstance() noexcept
+{
+	if (pid > 0) {
+		kill(pid, SIGTERM);
+		waitpid(pid, nullptr, 0);
+	}
+
+	unlink((directory + "/mpd.conf").c_str());
+	unlink((directory + "/database").c_str());
+	rmdir((directory + "/music").c_str());
+	rmdir(directory.c_str());
+}
+
+/**
+ * Wait until MPD accepts connections.
+ */
+static void
+WaitForMpd(const char *address)
+{
+	for (unsigned i = 0; i < 100; ++i) {
+		try {
+			auto s = Connect(address);
+			Query(s, nullptr);
+			return;
+		} catch (...) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		}
+	}
+
+	throw std::runtime_error("MPD did not start");
+}
+
+static void
+Usage()
+{
+	fprintf(stderr, "Usage: bench_load [OPTIONS] HOST[:PORT]\n"
+		"       bench_load [OPTIONS] -x MPD\n"
+		"       bench_load [-s SONGS] -g DATABASE\n"
+		"\n"
+		"Options:\n"
+		"  -c CLIENTS  number of clients sending commands (default 50)\n"
+		"  -i CLIENTS  number of clients waiting in \"idle\" (default 10)\n"
+		"  -t SECONDS  test duration (default 10)\n"
+		"  -m MIX      command mix (default status:80,queue:10,search:5,find:4,listallinfo:1)\n"
+		"  -s SONGS    number of songs in the synthetic database (default 10000)\n"
+		"  -x MPD      launch this MPD binary with a synthetic database\n"
+		"  -T THREADS  with -x: run again with \"client_io_threads\" and compare\n"
+		"  -g FILE     write the synthetic database to FILE and exit\n");
+}
+
+int
+main(int argc, char **argv)
+try {
+	unsigned n_clients = 50, n_idle = 10, n_songs = 10000;
+	double duration_s = 10;
+	const char *mix_spec = "status:80,queue:10,search:5,find:4,listallinfo:1";
+	unsigned io_threads = 0;
+	const char *mpd_path = nullptr, *generate_path = nullptr;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "c:i:t:m:s:x:g:T:")) != -1) {
+		switch (opt) {
+		case 'c':
+			n_clients = strtoul(optarg, nullptr, 10);
+			break;
+
+		case 'i':
+			n_idle = strtoul(optarg, nullptr, 10);
+			break;
+
+		case 't':
+			duration_s = strtod(optarg, nullptr);
+			break;
+
+		case 'm':
+			mix_spec = optarg;
+			break;
+
+		case 's':
+			n_songs = strtoul(optarg, nullptr, 10);
+			break;
+
+		case 'x':
+			mpd_path = optarg;
+			break;
+
+		case 'g':
+			generate_path = optarg;
+			break;
+
+		case 'T':
+			io_threads = strtoul(optarg, nullptr, 10);
+			break;
+
+		default:
+			Usage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (n_songs == 0 || n_clients == 0) {
+		Usage();
+		return EXIT_FAILURE;
+	}
+
+	if (generate_path != nullptr) {
+		GenerateDatabase(generate_path, n_songs);
+		return EXIT_SUCCESS;
+	}
+
+	const auto weights = ParseMix(mix_spec);
+
+	const auto duration =
+		std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(duration_s));
+
+	const auto run = [&](const char *address){
+		LoadTest test(n_songs, weights);
+
+		const auto start = Clock::now();
+		test.Run(address, n_clients, n_idle, duration);
+		const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+		printf("%u clients (+%u idle), %u songs, %.1f s\n",
+		       n_clients, n_idle, n_songs, elapsed.count());
+		test.PrintReport(elapsed);
+	};
+
+	if (mpd_path == nullptr) {
+		if (optind + 1 != argc || io_threads > 0) {
+			Usage();
+			return EXIT_FAILURE;
+		}
+
+		run(argv[optind]);
+		return EXIT_SUCCESS;
+	}
+
+	if (optind != argc) {
+		Usage();
+		return EXIT_FAILURE;
+	}
+
+	/* with -T, first run without I/O threads as the baseline */
+	for (unsigned threads : {0U, io_threads}) {
+		const unsigned port = FindFreePort();
+		const auto address = "127.0.0.1:" + std::to_string(port);
+		const MpdInstance instance(mpd_path, n_songs, port,
+					   n_clients + n_idle + 10,
+					   threads);
+		WaitForMpd(address.c_str());
+
+		if (io_threads > 0)
+			printf("client_io_threads: %u\n", threads);
+
+		run(address.c_str());
+
+		if (io_threads == 0)
+			break;
+
+		printf("\n");
+	}
+
+	return EXIT_SUCCESS;
+} catch (...) {
+	PrintException(std::current_exception());
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Build a number of synthetic songs in memory and measure how long
+ * "search any" (case-insensitive substring match on all tag values)
+ * takes.  The first pass includes case-folding all values; all
+ * following passes use the values cached by the tag pool.
+ *
+ * With "-f", "find any" (case-sensitive equality) is measured
+ * instead.
+ *
+ * With "-e", the given filter expression is parsed and evaluated
+ * both as specified and after SongFilter::Optimize(), e.g.:
+ *
+ *  bench_tag_search -e '((title =~ "^S.*n") AND (artist == "Artist 0007"))'
+ *
+ * Usage: bench_tag_search [-f] [-e EXPRESSION] [SONGS] [PASSES] [NEEDLE]
+ */
+
+#include "SyntheticDatabase.hxx"
+#include "song/Filter.hxx"
+#include "song/LightSong.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static std::chrono::steady_clock::duration
+RunPass(const SongFilter &filter, const std::vector<SyntheticSong> &songs,
+	unsigned &n_matches) noexcept
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	n_matches = 0;
+	for (const auto &song : songs)
+		if (filter.Match(LightSong(song.uri.c_str(), song.tag)))
+			++n_matches;
+
+	return std::chrono::steady_clock::now() - start;
+}
+
+static void
+PrintPass(const char *name, unsigned pass, unsigned n_songs,
+	  unsigned n_matches,
+	  std::chrono::steady_clock::duration duration) noexcept
+{
+	const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+	printf("%spass %u: %u matches in %lld us (%.1f ns/song)\n",
+	       name, pass, n_matches, (long long)us,
+	       n_songs > 0 ? us * 1000.0 / n_songs : 0.0);
+}
+
+int
+main(int argc, char **argv) noexcept
+try {
+	bool find = false;
+	const char *expression = nullptr;
+
+	while (argc > 1 && argv[1][0] == '-') {
+		if (strcmp(argv[1], "-f") == 0) {
+			find = true;
+			--argc;
+			++argv;
+		} else if (strcmp(argv[1], "-e") == 0 && argc > 2) {
+			expression = argv[2];
+			argc -= 2;
+			argv += 2;
+		} else
+			break;
+	}
+
+	if (argc > 4) {
+		fprintf(stderr,
+			"Usage: bench_tag_search [-f] [-e EXPRESSION] [SONGS] [PASSES] [NEEDLE]\n");
+		return EXIT_FAILURE;
+	}
+
+	const unsigned n_songs = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100000;
+	const unsigned n_passes = argc > 2 ? strtoul(argv[2], nullptr, 10) : 10;
+	const char *const needle = argc > 3
+		? argv[3]
+		: (find ? "River Stone" : "rIVeR");
+
+	const auto songs = MakeSyntheticSongs(n_songs);
+
+	if (expression != nullptr) {
+		SongFilter filter;
+		filter.Parse({&expression, 1}, !find);
+
+		SongFilter optimized;
+		optimized.Parse({&expression, 1}, !find);
+		optimized.Optimize();
+
+		printf("as specified: %s\noptimized:    %s\n",
+		       filter.ToExpression().c_str(),
+		       optimized.ToExpression().c_str());
+
+		for (unsigned pass = 0; pass < n_passes; ++pass) {
+			unsigned n_matches;
+			auto duration = RunPass(filter, songs, n_matches);
+			PrintPass("as specified ", pass, n_songs,
+				  n_matches, duration);
+
+			duration = RunPass(optimized, songs, n_matches);
+			PrintPass("optimized    ", pass, n_songs,
+				  n_matches, duration);
+		}
+
+		return EXIT_SUCCESS;
+	}
+
+	const SongFilter filter(TAG_NUM_OF_ITEM_TYPES, needle, !find);
+
+	for (unsigned pass = 0; pass < n_passes; ++pass) {
+		unsigned n_matches;
+		const auto duration = RunPass(filter, songs, n_matches);
+		PrintPass("", pass, n_songs, n_matches, duration);
+	}
+
+	return EXIT_SUCCESS;
+} catch (...) {
+	PrintException(std::current_exception());
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+/*
+ * Build a synthetic in-memory database and measure how long
+ * CollectUniqueTags() takes, which implements "list TAG group
+ * TAG...".  The default is "list albumartist group date"; about one
+ * third of all songs have an "AlbumArtist" tag, the others fall back
+ * to "Artist".
+ *
+ * Usage: bench_unique_tags [SONGS] [PASSES] [TAG...]
+ */
+
+#include "SyntheticDatabase.hxx"
+#include "db/Selection.hxx"
+#include "tag/ParseName.hxx"
+#include "util/ConstBuffer.hxx"
+#include "util/PrintException.hxx"
+#include "util/RecursiveMap.hxx"
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static std::size_t
+CountLeaves(const RecursiveMap<std::string> &map) noexcept
+{
+	if (map.empty())
+		return 1;
+
+	std::size_t n = 0;
+	for (const auto &i : map)
+		n += CountLeaves(i.second);
+	return n;
+}
+
+int
+main(int argc, char **argv) noexcept
+try {
+	const unsigned n_songs = argc > 1 ? strtoul(argv[1], nullptr, 10) : 500000;
+	const unsigned n_passes = argc > 2 ? strtoul(argv[2], nullptr, 10) : 5;
+
+	std::vector<TagType> tag_types;
+	for (int i = 3; i < argc; ++i) {
+		const auto type = tag_name_parse_i(argv[i]);
+		if (type == TAG_NUM_OF_ITEM_TYPES)
+			throw std::runtime_error("Unknown tag type");
+		tag_types.push_back(type);
+	}
+
+	if (tag_types.empty())
+		tag_types = {TAG_ALBUM_ARTIST, TAG_DATE};
+
+	const auto songs = MakeSyntheticSongs(n_songs);
+	const SyntheticDatabase db(songs);
+	const DatabaseSelection selection("", true);
+
+	for (unsigned pass = 0; pass < n_passes; ++pass) {
+		const auto start = std::chrono::steady_clock::now();
+		const auto result = db.CollectUniqueTags(selection,
+							 {tag_types.data(), tag_types.size()});
+		const auto duration = std::chrono::steady_clock::now() - start;
+		const auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+		printf("pass %u: %zu values, %zu combinations in %lld us (%.1f ns/song)\n",
+		       pass, result.size(), CountLeaves(result),
+		       (long long)us,
+		       n_songs > 0 ? us * 1000.0 / n_songs : 0.0);
+	}
+
+	return EXIT_SUCCESS;
+} catch (...) {
+	PrintException(std::current_exception());
+	return EXIT_FAILURE;
+}
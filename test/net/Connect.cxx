@@ -0,0 +1,42 @@
+/*
+ * Copyright 2003-2020 The Music Player Daemon Project
+ * http://www.musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Connect.hxx"
+#include "net/Resolver.hxx"
+#include "net/AddressInfo.hxx"
+#include "net/SocketError.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+
+#include <sys/socket.h>
+
+UniqueSocketDescriptor
+Connect(const char *host_port)
+{
+	const auto ail = Resolve(host_port, 6600, 0, SOCK_STREAM);
+	const auto &ai = ail.front();
+
+	UniqueSocketDescriptor s;
+	if (!s.Create(ai.GetFamily(), ai.GetType(), ai.GetProtocol()))
+		throw MakeSocketError("Failed to create socket");
+
+	if (!s.Connect(ai))
+		throw MakeSocketError("Failed to connect");
+
+	return s;
+}
@@ -18,6 +18,7 @@
  */
 
 #include "config.h"
+#include "Chrono.hxx"
 #include "config/Data.hxx"
 #include "event/Thread.hxx"
 #include "decoder/DecoderList.hxx"
@@ -29,12 +30,15 @@
 #include "fs/Path.hxx"
 #include "fs/NarrowPath.hxx"
 #include "pcm/AudioFormat.hxx"
+#include "util/OptionDef.hxx"
+#include "util/OptionParser.hxx"
 #include "util/ScopeExit.hxx"
 #include "util/StringBuffer.hxx"
 #include "util/StringView.hxx"
 #include "util/PrintException.hxx"
 
 #include <cassert>
+#include <chrono>
 #include <stdexcept>
 
 #include <unistd.h>
@@ -82,9 +86,105 @@ public:
 	}
 };
 
+struct CommandLine {
+	const char *decoder = nullptr;
+	const char *path = nullptr;
+
+	/**
+	 * If non-zero, then scan the file this many times and print
+	 * the time per scan.
+	 */
+	unsigned benchmark = 0;
+};
+
+enum Option {
+	OPTION_BENCHMARK,
+};
+
+static constexpr OptionDef option_defs[] = {
+	{"benchmark", 0, true, "Scan COUNT times and print the time per scan"},
+};
+
+static CommandLine
+ParseCommandLine(int argc, char **argv)
+{
+	CommandLine c;
+
+	OptionParser option_parser(option_defs, argc, argv);
+	while (auto o = option_parser.Next()) {
+		switch (Option(o.index)) {
+		case OPTION_BENCHMARK:
+			c.benchmark = strtoul(o.value, nullptr, 10);
+			if (c.benchmark == 0)
+				throw std::runtime_error("Invalid benchmark count");
+			break;
+		}
+	}
+
+	auto args = option_parser.GetRemaining();
+	if (args.size != 2)
+		throw std::runtime_error("Usage: read_tags [--benchmark=COUNT] DECODER FILE");
+
+	c.decoder = args[0];
+	c.path = args[1];
+	return c;
+}
+
+/**
+ * Scan the file with ScanFile(), falling back to ScanStream(), just
+ * like the database update does.
+ *
+ * @param is if ScanStream() was used, the #InputStream is returned
+ * here
+ */
+static bool
+ScanTags(const DecoderPlugin &plugin, const char *path,
+	 TagHandler &handler, Mutex &mutex, InputStreamPtr &is)
+{
+	try {
+		if (plugin.ScanFile(FromNarrowPath(path), handler))
+			return true;
+	} catch (...) {
+		PrintException(std::current_exception());
+	}
+
+	if (plugin.scan_stream == nullptr)
+		return false;
+
+	is = InputStream::OpenReady(path, mutex);
+	return plugin.ScanStream(*is, handler);
+}
+
+/**
+ * Scan the file repeatedly without printing the tags, and print the
+ * time per scan to stderr.  This is useful for comparing the speed
+ * of tag scanners.
+ */
+static void
+Benchmark(const DecoderPlugin &plugin, const char *path, unsigned n)
+{
+	NullTagHandler handler(TagHandler::WANT_DURATION|
+			       TagHandler::WANT_TAG|
+			       TagHandler::WANT_AUDIO_FORMAT);
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (unsigned i = 0; i < n; ++i) {
+		Mutex mutex;
+		InputStreamPtr is;
+		if (!ScanTags(plugin, path, handler, mutex, is))
+			throw std::runtime_error("Failed to read tags");
+	}
+
+	const FloatDuration duration =
+		std::chrono::steady_clock::now() - start;
+
+	fprintf(stderr, "%u scans in %.3f s, %.1f us per scan\n",
+		n, duration.count(), duration.count() * 1e6 / n);
+}
+
 int main(int argc, char **argv)
 try {
-	const char *decoder_name;
 	const struct DecoderPlugin *plugin;
 
 #ifdef HAVE_LOCALE_H
@@ -92,13 +192,9 @@ try {
 	setlocale(LC_CTYPE,"");
 #endif
 
-	if (argc != 3) {
-		fprintf(stderr, "Usage: read_tags DECODER FILE\n");
-		return EXIT_FAILURE;
-	}
-
-	decoder_name = argv[1];
-	const char *path = argv[2];
+	const auto c = ParseCommandLine(argc, argv);
+	const char *const decoder_name = c.decoder;
+	const char *const path = c.path;
 
 	EventThread io_thread;
 	io_thread.Start();
@@ -114,24 +210,16 @@ try {
 		return EXIT_FAILURE;
 	}
 
-	DumpTagHandler h;
-	bool success;
-	try {
-		success = plugin->ScanFile(FromNarrowPath(path), h);
-	} catch (...) {
-		PrintException(std::current_exception());
-		success = false;
+	if (c.benchmark > 0) {
+		Benchmark(*plugin, path, c.benchmark);
+		return EXIT_SUCCESS;
 	}
 
+	DumpTagHandler h;
 	Mutex mutex;
 	InputStreamPtr is;
 
-	if (!success && plugin->scan_stream != nullptr) {
-		is = InputStream::OpenReady(path, mutex);
-		success = plugin->ScanStream(*is, h);
-	}
-
-	if (!success) {
+	if (!ScanTags(*plugin, path, h, mutex, is)) {
 		fprintf(stderr, "Failed to read tags\n");
 		return EXIT_FAILURE;
 	}
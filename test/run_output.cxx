@@ -32,6 +32,7 @@
 #include "util/PrintException.hxx"
 
 #include <cassert>
+#include <chrono>
 #include <memory>
 
 #include <string.h>
@@ -80,6 +81,9 @@ run_output(AudioOutput &ao, AudioFormat audio_format)
 
 	/* play */
 
+	const auto start_time = std::chrono::steady_clock::now();
+	unsigned long long total_bytes = 0;
+
 	size_t length = 0;
 	char buffer[4096];
 	while (true) {
@@ -99,10 +103,25 @@ run_output(AudioOutput &ao, AudioFormat audio_format)
 			assert(consumed <= length);
 			assert(consumed % frame_size == 0);
 
+			total_bytes += consumed;
 			length -= consumed;
 			memmove(buffer, buffer + consumed, length);
 		}
 	}
+
+	/* report the throughput, which is useful for benchmarking
+	   outputs which are not throttled by a (hardware) clock */
+
+	const std::chrono::duration<double> duration =
+		std::chrono::steady_clock::now() - start_time;
+	fprintf(stderr, "played %llu bytes in %.3f s (%.1f MB/s, %.1fx realtime)\n",
+		total_bytes, duration.count(),
+		duration.count() > 0
+		? total_bytes / duration.count() / (1024 * 1024)
+		: 0.,
+		duration.count() > 0
+		? audio_format.SizeToTime<std::chrono::duration<double>>(total_bytes).count() / duration.count()
+		: 0.);
 }
 
 int main(int argc, char **argv)